@@ -58,6 +58,20 @@ cleanup:
     return foundSaves;
 }
 
+// checksum of the compressed save partition
+// catches saves changed by the Action Replay's own save manager
+int actionReplayGetGeneration(int backupDevice, unsigned int* generation)
+{
+    if(backupDevice != ActionReplayBackup)
+    {
+        return -1;
+    }
+
+    *generation = calculateCRC32((unsigned char*)(CARTRIDGE_MEMORY + ACTION_REPLACE_SAVES_OFFSET), ACTION_REPLACE_SAVES_SIZE, 0);
+
+    return 0;
+}
+
 // copies the specified actionReplay save game to the saveFileData buffer
 int actionReplayReadSaveFile(int backupDevice, char* filename, unsigned char* outBuffer, unsigned int outSize)
 {
@@ -628,7 +642,7 @@ int compressRLE01(unsigned char rleKey, unsigned char *src, unsigned int srcSize
         do
         {
             count++;
-            if (*(src + i + count) != val)
+            if (i + count >= srcSize || *(src + i + count) != val)
             {
                 break;
             }
@@ -647,7 +661,10 @@ int compressRLE01(unsigned char rleKey, unsigned char *src, unsigned int srcSize
 
             if(val == rleKey)
             {
-                dest[j] = 0;
+                if(dest)
+                {
+                    dest[j] = 0;
+                }
                 j++;
             }
         }
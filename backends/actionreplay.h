@@ -6,7 +6,10 @@
 // Action Replay Cartridge
 //
 
+// the host build in tools/sgcsim points this at a simulated cartridge
+#ifndef CARTRIDGE_MEMORY
 #define CARTRIDGE_MEMORY                0x02000000
+#endif
 #define ACTION_REPLAY_MAGIC_OFFSET      0x50
 #define ACTION_REPLACE_SAVES_OFFSET     0x20000
 #define ACTION_REPLACE_SAVES_SIZE       0x60000 // BUGBUG: just guessing here
@@ -31,6 +34,7 @@ int actionReplayListSaveFiles(int backupDevice, PSAVES fileSaves, unsigned int n
 int actionReplayReadSaveFile(int backupDevice, char* filename, unsigned char* ouBuffer, unsigned int outBufSize);
 int actionReplayWriteSaveFile(int backupDevice, char* filename, unsigned char* saveData, unsigned int saveDataLen);
 int actionReplayDeleteSaveFile(int backupDevice, char* filename);
+int actionReplayGetGeneration(int backupDevice, unsigned int* generation);
 
 // utility functions
 int decompressPartition(unsigned char *src, unsigned int srcSize, unsigned char **dest, unsigned int* destSize);
@@ -3,321 +3,607 @@
 #include "actionreplay.h"
 #include "mode.h"
 #include "satiator.h"
+#include "satiator/satiator.h"
 #include "serial.h"
 #include "cd.h"
 #include "vcd_card.h"
 #include "modem.h"
+#include "ramdisk.h"
+#include "dircache.h"
+#include "stats.h"
+#include "../bup_pack.h"
+
+static unsigned int getReadSize(const BACKUP_MEDIUM* medium, const unsigned char* buffer, unsigned int bufferSize);
+static int unpackSaveFile(int backupDevice, char* filename, unsigned char* outBuffer, unsigned int outSize);
+static int readPackedStream(PBACKUP_STREAM stream, unsigned char* buffer, unsigned int size);
+static int readDevice(PBACKUP_STREAM stream, unsigned char* buffer, unsigned int size);
+static int openStream(PBACKUP_STREAM stream, int backupDevice, char* filename, unsigned char mode, unsigned int size, unsigned char* saveBuffer, unsigned int saveBufferSize, bool buffered);
+static int openBufferedStream(PBACKUP_STREAM stream, unsigned char* saveBuffer, unsigned int saveBufferSize);
+
+// registry of backup devices, indexed by device id
+// entries must stay in device id order
+static const BACKUP_MEDIUM g_BackupMediums[] =
+{
+    {
+        JoInternalMemoryBackup, "Internal Memory",
+        BACKUP_CAP_READ | BACKUP_CAP_WRITE | BACKUP_CAP_LIST | BACKUP_CAP_DELETE | BACKUP_CAP_FORMAT | BACKUP_CAP_SAVE_NAME | BACKUP_CAP_BUP_HEADER,
+        0,
+        saturnIsBackupDeviceAvailable, saturnListSaveFiles, saturnReadSaveFile, saturnWriteSaveFile, saturnDeleteSaveFile, saturnFormatDevice,
+        NULL, NULL, NULL, NULL,
+        saturnGetGeneration, NULL,
+    },
+    {
+        JoCartridgeMemoryBackup, "Cartridge Memory",
+        BACKUP_CAP_READ | BACKUP_CAP_WRITE | BACKUP_CAP_LIST | BACKUP_CAP_DELETE | BACKUP_CAP_FORMAT | BACKUP_CAP_SAVE_NAME | BACKUP_CAP_BUP_HEADER,
+        0,
+        saturnIsBackupDeviceAvailable, saturnListSaveFiles, saturnReadSaveFile, saturnWriteSaveFile, saturnDeleteSaveFile, saturnFormatDevice,
+        NULL, NULL, NULL, NULL,
+        saturnGetGeneration, NULL,
+    },
+    {
+        JoExternalDeviceBackup, "External Device",
+        BACKUP_CAP_READ | BACKUP_CAP_WRITE | BACKUP_CAP_LIST | BACKUP_CAP_DELETE | BACKUP_CAP_FORMAT | BACKUP_CAP_SAVE_NAME | BACKUP_CAP_BUP_HEADER,
+        0,
+        saturnIsBackupDeviceAvailable, saturnListSaveFiles, saturnReadSaveFile, saturnWriteSaveFile, saturnDeleteSaveFile, saturnFormatDevice,
+        NULL, NULL, NULL, NULL,
+        saturnGetGeneration, NULL,
+    },
+    {
+        SatiatorBackup, "Satiator",
+        BACKUP_CAP_READ | BACKUP_CAP_WRITE | BACKUP_CAP_LIST | BACKUP_CAP_DELETE | BACKUP_CAP_BUP_HEADER | BACKUP_CAP_CD_BLOCK | BACKUP_CAP_DIRECTORIES,
+        S_MAXBUF,
+        satiatorIsBackupDeviceAvailable, satiatorListSaveFiles, satiatorReadSaveFile, satiatorWriteSaveFile, satiatorDeleteSaveFile, NULL,
+        satiatorOpenStream, satiatorReadChunk, satiatorWriteChunk, satiatorCloseStream,
+        NULL, satiatorChangeDirectory,
+    },
+    {
+        CdMemoryBackup, "CD File System",
+        BACKUP_CAP_READ | BACKUP_CAP_LIST | BACKUP_CAP_BUP_HEADER | BACKUP_CAP_CD_BLOCK | BACKUP_CAP_DIRECTORIES,
+        CD_SECTOR_SIZE,
+        cdIsBackupDeviceAvailable, cdListSaveFiles, cdReadSaveFile, NULL, NULL, NULL,
+        cdOpenStream, cdReadChunk, NULL, cdCloseStream,
+        cdGetGeneration, cdChangeDirectory,
+    },
+    {
+        // RAM disk
+        MemoryBackup, "RAM",
+        BACKUP_CAP_READ | BACKUP_CAP_WRITE | BACKUP_CAP_LIST | BACKUP_CAP_DELETE | BACKUP_CAP_FORMAT | BACKUP_CAP_BUP_HEADER,
+        0,
+        ramdiskIsBackupDeviceAvailable, ramdiskListSaveFiles, ramdiskReadSaveFile, ramdiskWriteSaveFile, ramdiskDeleteSaveFile, ramdiskFormatDevice,
+        ramdiskOpenStream, ramdiskReadChunk, ramdiskWriteChunk, ramdiskCloseStream,
+        NULL, NULL,
+    },
+    {
+        MODEBackup, "MODE",
+        BACKUP_CAP_READ | BACKUP_CAP_WRITE | BACKUP_CAP_LIST | BACKUP_CAP_DELETE | BACKUP_CAP_BUP_HEADER | BACKUP_CAP_CD_BLOCK,
+        MODE_SECTOR_SIZE,
+        modeIsBackupDeviceAvailable, modeListSaveFiles, modeReadSaveFile, modeWriteSaveFile, modeDeleteSaveFile, NULL,
+        modeOpenStream, modeReadChunk, modeWriteChunk, modeCloseStream,
+        NULL, NULL,
+    },
+    {
+        // flashing AR is nontrivial, a ton of work to support writing
+        // deleting needs the same flash write, see actionReplayDeleteSaveFile()
+        ActionReplayBackup, "Action Replay (Read-Only)",
+        BACKUP_CAP_READ | BACKUP_CAP_LIST | BACKUP_CAP_SAVE_NAME | BACKUP_CAP_BUP_HEADER,
+        0,
+        actionReplayIsBackupDeviceAvailable, actionReplayListSaveFiles, actionReplayReadSaveFile, NULL, actionReplayDeleteSaveFile, NULL,
+        NULL, NULL, NULL, NULL,
+        actionReplayGetGeneration, NULL,
+    },
+    {
+        // the "save" is the raw firmware, there is no .BUP header
+        VCDCardBackup, "VCD Card",
+        BACKUP_CAP_READ | BACKUP_CAP_LIST,
+        0,
+        vcdIsBackupDeviceAvailable, vcdListSaveFiles, vcdReadSaveFile, NULL, NULL, NULL,
+        NULL, NULL, NULL, NULL,
+        NULL, NULL,
+    },
+    {
+        // listing requires something responding on the other side
+        // saves are only sent, nothing can be read back
+        SerialBackup, "Serial Link",
+        BACKUP_CAP_WRITE | BACKUP_CAP_BUP_HEADER,
+        0,
+        serialIsBackupDeviceAvailable, serialListSaveFiles, serialReadSaveFile, serialWriteSaveFile, serialDeleteSaveFile, NULL,
+        serialOpenStream, NULL, serialWriteChunk, serialCloseStream,
+        NULL, NULL,
+    },
+    {
+        ModemBackup, "Modem",
+        BACKUP_CAP_WRITE | BACKUP_CAP_BUP_HEADER,
+        0,
+        modemIsBackupDeviceAvailable, modemListSaveFiles, modemReadSaveFile, modemWriteSaveFile, modemDeleteSaveFile, NULL,
+        modemOpenStream, NULL, modemWriteChunk, modemCloseStream,
+        NULL, NULL,
+    },
+};
+
+// current subdirectory of each device, empty for the device's save directory
+static char g_SaveDirectories[COUNTOF(g_BackupMediums)][MAX_FILENAME] = {0};
+
+// chunk of the packed save being read. Only one packed stream can be open at a time
+static PBACKUP_STREAM g_PackedStream = NULL;
+static unsigned char g_PackedChunk[BUP_PACK_CHUNK_SIZE + 2]; // RLE01 may look ahead 2 bytes
+static unsigned char g_UnpackedChunk[BUP_PACK_CHUNK_SIZE];
+
+// get the registry entry for the device id
+// returns NULL for an invalid device
+const BACKUP_MEDIUM* getBackupMedium(int backupDevice)
+{
+    if(backupDevice < 0 || (unsigned int)backupDevice >= COUNTOF(g_BackupMediums))
+    {
+        sgc_core_error("Invalid backup device specified!! %d\n", backupDevice);
+        return NULL;
+    }
+
+    return &g_BackupMediums[backupDevice];
+}
+
+// returns true if the device has all of the requested BACKUP_CAP_XXX capabilities
+bool hasBackupDeviceCapability(int backupDevice, unsigned int capabilities)
+{
+    const BACKUP_MEDIUM* medium = getBackupMedium(backupDevice);
+
+    if(medium == NULL)
+    {
+        return false;
+    }
+
+    return (medium->capabilities & capabilities) == capabilities;
+}
 
 // returns true if the backup device is found
 bool isBackupDeviceAvailable(int backupDevice)
 {
-    switch(backupDevice)
+    const BACKUP_MEDIUM* medium = getBackupMedium(backupDevice);
+
+    if(medium == NULL || medium->isBackupDeviceAvailable == NULL)
     {
-        case JoInternalMemoryBackup:
-        case JoCartridgeMemoryBackup:
-        case JoExternalDeviceBackup:
-            return saturnIsBackupDeviceAvailable(backupDevice);
+        return false;
+    }
 
-        case ActionReplayBackup:
-            return actionReplayIsBackupDeviceAvailable(backupDevice);
+    return medium->isBackupDeviceAvailable(backupDevice);
+}
 
-        case SatiatorBackup:
-            return satiatorIsBackupDeviceAvailable(backupDevice);
+// returns true if the backup device is writeable
+bool isBackupDeviceWriteable(int backupDevice)
+{
+    return hasBackupDeviceCapability(backupDevice, BACKUP_CAP_WRITE);
+}
 
-        case MODEBackup:
-            return modeIsBackupDeviceAvailable(backupDevice);
+// queries the saves on the backup device and fills out the saves array
+// listings are served from the directory cache when the device hasn't changed
+int listSaveFiles(int backupDevice, PSAVES saves, unsigned int numSaves)
+{
+    const BACKUP_MEDIUM* medium = getBackupMedium(backupDevice);
+    STATS_MARK mark = {0};
+    int count = 0;
 
-        case CdMemoryBackup:
-            return true; // always assume CD backups are available
+    if(medium == NULL || medium->listSaveFiles == NULL)
+    {
+        return -1;
+    }
 
-        case VCDCardBackup:
-            return vcdIsBackupDeviceAvailable(backupDevice);
+    statsBegin(&mark);
 
-        case SerialBackup:
-            return serialIsBackupDeviceAvailable(backupDevice);
+    count = dirCacheGet(backupDevice, saves, numSaves);
+    if(count < 0)
+    {
+        count = medium->listSaveFiles(backupDevice, saves, numSaves);
+        if(count >= 0)
+        {
+            dirCacheStore(backupDevice, saves, count);
+        }
+    }
 
-        case ModemBackup:
-            return modemIsBackupDeviceAvailable(backupDevice);
+    // bytes is the number of saves listed
+    statsEnd(&mark, STATS_OP_LIST, backupDevice, MIN(count, 0), MAX(count, 0));
 
-        default:
-            sgc_core_error("Invalid backup device specified!! %d\n", backupDevice);
-            return false;
+    return count;
+}
+
+// reads the specified save game from the backup device
+int readSaveFile(int backupDevice, char* filename, unsigned char* outBuffer, unsigned int outSize)
+{
+    const BACKUP_MEDIUM* medium = getBackupMedium(backupDevice);
+    STATS_MARK mark = {0};
+    int result = 0;
+
+    if(medium == NULL || medium->readSaveFile == NULL)
+    {
+        return -1;
     }
 
-    return false;
+    statsBegin(&mark);
+    result = medium->readSaveFile(backupDevice, filename, outBuffer, outSize);
+    statsEnd(&mark, STATS_OP_READ, backupDevice, result, result == 0 ? getReadSize(medium, outBuffer, outSize) : 0);
+
+    // packed saves are unpacked transparently so callers always see a plain .BUP
+    if(result == 0 && outSize >= BUP_HEADER_SIZE && bup_is_packed(outBuffer))
+    {
+        result = unpackSaveFile(backupDevice, filename, outBuffer, outSize);
+    }
+
+    return result;
 }
 
-// returns true if the backup device is writeable
-// TODO: each device should implement this function
-bool isBackupDeviceWriteable(int backupDevice)
+// write the save game to the backup device
+int writeSaveFile(int backupDevice, char* filename, unsigned char* inBuffer, unsigned int inSize)
 {
-    switch(backupDevice)
+    const BACKUP_MEDIUM* medium = getBackupMedium(backupDevice);
+    STATS_MARK mark = {0};
+    int result = 0;
+
+    if(medium == NULL || medium->writeSaveFile == NULL)
     {
-        // writeable
-        case JoInternalMemoryBackup:
-        case JoCartridgeMemoryBackup:
-        case JoExternalDeviceBackup:
-        case SatiatorBackup:
-        case MODEBackup:
-        case SerialBackup:
-        case ModemBackup:
-            return true;
+        return -1;
+    }
 
-        // non-writeable
-        case CdMemoryBackup: // cd is never writeable
-            return false;
+    statsBegin(&mark);
 
-        case ActionReplayBackup: // flashing AR is nontrivial, a ton of work to support
-            return false;
+    result = medium->writeSaveFile(backupDevice, filename, inBuffer, inSize);
+    statsEnd(&mark, STATS_OP_WRITE, backupDevice, result, inSize);
+    if(result == 0 && (medium->capabilities & BACKUP_CAP_BUP_HEADER))
+    {
+        dirCacheUpdateSave(backupDevice, filename, inBuffer, inSize);
+    }
 
-        case VCDCardBackup:
-            return false;
+    return result;
+}
 
-        case MemoryBackup:
-            return false;
+// delete the save from the backup device
+int deleteSaveFile(int backupDevice, char* filename)
+{
+    const BACKUP_MEDIUM* medium = getBackupMedium(backupDevice);
+    STATS_MARK mark = {0};
+    int result = 0;
 
-        default:
-            sgc_core_error("Invalid backup device specified!! %d\n", backupDevice);
-            return false;
+    if(medium == NULL || medium->deleteSaveFile == NULL || !(medium->capabilities & BACKUP_CAP_DELETE))
+    {
+        return -1;
     }
 
-    return false;
+    statsBegin(&mark);
+    result = medium->deleteSaveFile(backupDevice, filename);
+    statsEnd(&mark, STATS_OP_DELETE, backupDevice, result, 0);
+    if(result == 0)
+    {
+        dirCacheRemoveSave(backupDevice, filename);
+    }
+    else
+    {
+        // the delete may have partially happened
+        dirCacheInvalidate(backupDevice);
+    }
+
+    return result;
 }
 
-// queries the saves on the backup device and fills out the saves array
-int listSaveFiles(int backupDevice, PSAVES saves, unsigned int numSaves)
+// format a backup device
+int formatDevice(int backupDevice)
 {
-    switch(backupDevice)
+    const BACKUP_MEDIUM* medium = getBackupMedium(backupDevice);
+    STATS_MARK mark = {0};
+    int result = 0;
+
+    if(medium == NULL || medium->formatDevice == NULL || !(medium->capabilities & BACKUP_CAP_FORMAT))
     {
-        case JoInternalMemoryBackup:
-        case JoCartridgeMemoryBackup:
-        case JoExternalDeviceBackup:
-            return saturnListSaveFiles(backupDevice, saves, numSaves);
+        sgc_core_error("Invalid device to format!!");
+        return -1;
+    }
 
-        case ActionReplayBackup:
-            return actionReplayListSaveFiles(backupDevice, saves, numSaves);
+    dirCacheInvalidate(backupDevice);
 
-        case SatiatorBackup:
-            return satiatorListSaveFiles(backupDevice, saves, numSaves);
+    statsBegin(&mark);
+    result = medium->formatDevice(backupDevice);
+    statsEnd(&mark, STATS_OP_FORMAT, backupDevice, result, 0);
 
-        case MODEBackup:
-            return modeListSaveFiles(backupDevice, saves, numSaves);
+    return result;
+}
 
-        case CdMemoryBackup:
-            return cdListSaveFiles(backupDevice, saves, numSaves);
+// enters a subdirectory of the current save directory, JO_PARENT_DIR goes back up
+// only one level of subdirectories is supported
+int changeSaveDirectory(int backupDevice, char* directory)
+{
+    const BACKUP_MEDIUM* medium = getBackupMedium(backupDevice);
+    int result = 0;
 
-        case VCDCardBackup:
-            return vcdListSaveFiles(backupDevice, saves, numSaves);
+    if(medium == NULL || medium->changeDirectory == NULL || directory == NULL)
+    {
+        sgc_core_error("Invalid device to change directory!!");
+        return -1;
+    }
 
-        case SerialBackup:
-            return serialListSaveFiles(backupDevice, saves, numSaves);
+    result = medium->changeDirectory(backupDevice, directory);
+    if(result != 0)
+    {
+        return result;
+    }
 
-        case ModemBackup:
-            return modemListSaveFiles(backupDevice, saves, numSaves);
+    // the cached listing is for the previous directory
+    dirCacheInvalidate(backupDevice);
 
-        default:
-            sgc_core_error("Invalid backup device specified!! %d\n", backupDevice);
-            return -1;
+    if(strcmp(directory, JO_PARENT_DIR) == 0)
+    {
+        g_SaveDirectories[backupDevice][0] = '\0';
+    }
+    else
+    {
+        strncpy(g_SaveDirectories[backupDevice], directory, MAX_FILENAME);
+        g_SaveDirectories[backupDevice][MAX_FILENAME - 1] = '\0';
     }
 
-    return -1;
+    return 0;
 }
 
-// reads the specified save game from the backup device
-int readSaveFile(int backupDevice, char* filename, unsigned char* outBuffer, unsigned int outSize)
+// returns the current subdirectory of the device, empty for the save directory
+const char* getSaveDirectory(int backupDevice)
 {
-    switch(backupDevice)
+    if(backupDevice < 0 || (unsigned int)backupDevice >= COUNTOF(g_BackupMediums))
     {
-        case JoInternalMemoryBackup:
-        case JoCartridgeMemoryBackup:
-        case JoExternalDeviceBackup:
-            return saturnReadSaveFile(backupDevice, filename, outBuffer, outSize);
+        return "";
+    }
 
-        case ActionReplayBackup:
-            return actionReplayReadSaveFile(backupDevice, filename, outBuffer, outSize);
+    return g_SaveDirectories[backupDevice];
+}
 
-        case SatiatorBackup:
-            return satiatorReadSaveFile(backupDevice, filename, outBuffer, outSize);
+// called by a backend that lost its subdirectory, e.g. the SD card was
+// swapped, to go back to the save directory
+void resetSaveDirectory(int backupDevice)
+{
+    if(backupDevice < 0 || (unsigned int)backupDevice >= COUNTOF(g_BackupMediums))
+    {
+        return;
+    }
 
-        case MODEBackup:
-            return modeReadSaveFile(backupDevice, filename, outBuffer, outSize);
+    g_SaveDirectories[backupDevice][0] = '\0';
+    dirCacheInvalidate(backupDevice);
+}
 
-        case CdMemoryBackup:
-            return cdReadSaveFile(backupDevice, filename, outBuffer, outSize);
+// opens a save for streaming with readSaveStream() or writeSaveStream()
+// size is the size of the save including the .BUP header. It must be known up front
+// because devices without native streaming transfer the save in one go
+// saveBuffer holds the whole save when the device can't stream it. It can be
+// NULL if the caller doesn't have one, opening such a save fails then
+// returns 0 on success
+int openSaveStream(PBACKUP_STREAM stream, int backupDevice, char* filename, unsigned char mode, unsigned int size, unsigned char* saveBuffer, unsigned int saveBufferSize)
+{
+    return openStream(stream, backupDevice, filename, mode, size, saveBuffer, saveBufferSize, false);
+}
 
-        case VCDCardBackup:
-            return vcdReadSaveFile(backupDevice, filename, outBuffer, outSize);
+// reads the next chunk of the save into buffer
+// returns the number of bytes read, 0 at the end of the save, negative on error
+int readSaveStream(PBACKUP_STREAM stream, unsigned char* buffer, unsigned int size)
+{
+    const BACKUP_MEDIUM* medium = NULL;
+    int result = 0;
 
-        case SerialBackup:
-            return serialReadSaveFile(backupDevice, filename, outBuffer, outSize);
+    if(stream == NULL || buffer == NULL || stream->mode != STREAM_MODE_READ)
+    {
+        return -1;
+    }
 
-        case ModemBackup:
-            return modemReadSaveFile(backupDevice, filename, outBuffer, outSize);
+    size = MIN(size, stream->size - stream->position);
+    if(size == 0)
+    {
+        return 0;
+    }
 
-        default:
-            sgc_core_error("Invalid backup device specified!! %d\n", backupDevice);
-            return -1;
+    // header peeked at open
+    if(stream->position < stream->headerSize)
+    {
+        size = MIN(size, stream->headerSize - stream->position);
+        memcpy(buffer, stream->header + stream->position, size);
+        stream->position += size;
+        return size;
     }
 
-    return -1;
+    if(stream->buffer != NULL)
+    {
+        memcpy(buffer, stream->buffer + stream->position, size);
+        stream->position += size;
+        return size;
+    }
+
+    if(stream->packed)
+    {
+        return readPackedStream(stream, buffer, size);
+    }
+
+    medium = getBackupMedium(stream->backupDevice);
+    if(medium->maxChunkSize != 0)
+    {
+        size = MIN(size, medium->maxChunkSize);
+    }
+
+    result = medium->readChunk(stream, buffer, size);
+    if(result <= 0)
+    {
+        // the save is shorter than the caller said
+        sgc_core_error("Short read %d at %d!!", result, stream->position);
+        return -2;
+    }
+
+    stream->devicePosition += result;
+    stream->position += result;
+
+    return result;
 }
 
-// write the save game to the backup device
-int writeSaveFile(int backupDevice, char* filename, unsigned char* inBuffer, unsigned int inSize)
+// writes the next chunk of the save from buffer
+// returns the number of bytes written, negative on error
+int writeSaveStream(PBACKUP_STREAM stream, unsigned char* buffer, unsigned int size)
 {
-    switch(backupDevice)
+    const BACKUP_MEDIUM* medium = NULL;
+    int result = 0;
+
+    if(stream == NULL || buffer == NULL || stream->mode != STREAM_MODE_WRITE)
     {
-        case JoInternalMemoryBackup:
-        case JoCartridgeMemoryBackup:
-        case JoExternalDeviceBackup:
-            return saturnWriteSaveFile(backupDevice, filename, inBuffer, inSize);
+        return -1;
+    }
 
-        case SatiatorBackup:
-            return satiatorWriteSaveFile(backupDevice, filename, inBuffer, inSize);
+    if(size > stream->size - stream->position)
+    {
+        sgc_core_error("Write past the end of the save!!");
+        return -2;
+    }
 
-        case MODEBackup:
-            return modeWriteSaveFile(backupDevice, filename, inBuffer, inSize);
+    if(size == 0)
+    {
+        return 0;
+    }
 
-        case CdMemoryBackup:
-            return -1;
+    if(stream->buffer != NULL)
+    {
+        memcpy(stream->buffer + stream->position, buffer, size);
+        stream->position += size;
+        return size;
+    }
 
-        case VCDCardBackup:
-            return -1;
+    medium = getBackupMedium(stream->backupDevice);
+    if(medium->maxChunkSize != 0)
+    {
+        size = MIN(size, medium->maxChunkSize);
+    }
 
-        case SerialBackup:
-            return serialWriteSaveFile(backupDevice, filename, inBuffer, inSize);
+    result = medium->writeChunk(stream, buffer, size);
+    if(result <= 0)
+    {
+        sgc_core_error("Bad write %d at %d!!", result, stream->position);
+        return -3;
+    }
 
-        case ModemBackup:
-            return modemWriteSaveFile(backupDevice, filename, inBuffer, inSize);
+    // keep the .BUP header for the directory cache
+    if(stream->position < BUP_HEADER_SIZE)
+    {
+        unsigned int headerBytes = MIN(BUP_HEADER_SIZE - stream->position, (unsigned int)result);
 
-        default:
-            sgc_core_error("Invalid backup device specified!! %d\n", backupDevice);
-            return -1;
+        memcpy(stream->header + stream->position, buffer, headerBytes);
+        stream->headerSize = stream->position + headerBytes;
     }
+
+    stream->devicePosition += result;
+    stream->position += result;
+
+    return result;
 }
 
-// delete the save from the backup device
-int deleteSaveFile(int backupDevice, char* filename)
+// closes the stream. Buffered writes are written to the device here
+// returns 0 on success
+int closeSaveStream(PBACKUP_STREAM stream)
 {
-    switch(backupDevice)
-    {
-        case JoInternalMemoryBackup:
-        case JoCartridgeMemoryBackup:
-        case JoExternalDeviceBackup:
-            return saturnDeleteSaveFile(backupDevice, filename);
+    const BACKUP_MEDIUM* medium = NULL;
+    int result = 0;
 
-        case SatiatorBackup:
-            return satiatorDeleteSaveFile(backupDevice, filename);
+    if(stream == NULL)
+    {
+        return -1;
+    }
 
-        case MODEBackup:
-            return modeDeleteSaveFile(backupDevice, filename);
+    if(stream == g_PackedStream)
+    {
+        g_PackedStream = NULL;
+    }
 
-        case ActionReplayBackup:
-            return actionReplayDeleteSaveFile(backupDevice, filename);
+    if(stream->buffer != NULL)
+    {
+        if(stream->mode == STREAM_MODE_WRITE)
+        {
+            if(stream->position == stream->size)
+            {
+                result = writeSaveFile(stream->backupDevice, stream->filename, stream->buffer, stream->size);
+            }
+            else
+            {
+                // never write a partial save
+                result = -2;
+            }
+        }
 
-        case CdMemoryBackup:
-            return -1;
+        // the buffer belongs to the caller
+        stream->buffer = NULL;
+        return result;
+    }
 
-        case VCDCardBackup:
-            return -1;
+    medium = getBackupMedium(stream->backupDevice);
+    if(medium != NULL && medium->closeStream != NULL)
+    {
+        result = medium->closeStream(stream);
+    }
 
-        case SerialBackup:
-            return serialDeleteSaveFile(backupDevice, filename);
+    statsEnd(&stream->stats, stream->mode == STREAM_MODE_WRITE ? STATS_OP_STREAM_WRITE : STATS_OP_STREAM_READ,
+        stream->backupDevice, result, stream->devicePosition);
 
-        case ModemBackup:
-            return modemDeleteSaveFile(backupDevice, filename);
+    if(result == 0 && stream->mode == STREAM_MODE_WRITE && stream->position != stream->size)
+    {
+        result = -3;
+    }
 
-        default:
-            sgc_core_error("Invalid backup device specified!! %d\n", backupDevice);
-            return -1;
+    if(stream->mode == STREAM_MODE_WRITE)
+    {
+        if(result == 0 && medium != NULL && stream->headerSize == BUP_HEADER_SIZE && (medium->capabilities & BACKUP_CAP_BUP_HEADER))
+        {
+            dirCacheUpdateSave(stream->backupDevice, stream->filename, stream->header, stream->size);
+        }
+        else
+        {
+            // a partial save may have been left behind
+            dirCacheInvalidate(stream->backupDevice);
+        }
     }
 
-    return -1;
+    return result;
 }
 
-// format a backup device
-// TODO: each device should implement this function
-int formatDevice(int backupDevice)
+// returns true if the device streams natively instead of through a whole save buffer
+bool isStreamNative(int backupDevice, unsigned char mode)
 {
-    bool result = false;
+    const BACKUP_MEDIUM* medium = getBackupMedium(backupDevice);
 
-    switch(backupDevice)
+    if(medium == NULL || medium->openStream == NULL)
     {
-        case JoInternalMemoryBackup:
-        case JoCartridgeMemoryBackup:
-        case JoExternalDeviceBackup:
-            break;
-        default:
-        {
-            sgc_core_error("Invalid device to format!!");
-            return -1;
-        }
+        return false;
     }
 
-    result = jo_backup_mount(backupDevice);
-    if(result == false)
+    if(mode == STREAM_MODE_READ)
     {
-        char* deviceName = NULL;
-        getBackupDeviceName(backupDevice, &deviceName);
-
-        sgc_core_error("Failed to mount %s!!", deviceName);
-        return -2;
+        return medium->readChunk != NULL;
     }
 
-    result = jo_backup_format_device(backupDevice);
-    if(result == false)
+    return medium->writeChunk != NULL;
+}
+
+// opens the source of a copy for reading
+// devices sharing the CD block can't have files open at the same time so
+// copies between them read the source into saveBuffer in one go instead
+// returns 0 on success
+int openSaveStreamForCopy(PBACKUP_STREAM source, int sourceDevice, char* sourceFilename, int targetDevice, unsigned int size, unsigned char* saveBuffer, unsigned int saveBufferSize)
+{
+    bool buffered = false;
+
+    if(sourceDevice != targetDevice &&
+        hasBackupDeviceCapability(sourceDevice, BACKUP_CAP_CD_BLOCK) &&
+        hasBackupDeviceCapability(targetDevice, BACKUP_CAP_CD_BLOCK))
     {
-        sgc_core_error("Failed to format device!!");
-        return -3;
+        buffered = true;
     }
 
-    return 0;
+    return openStream(source, sourceDevice, sourceFilename, STREAM_MODE_READ, size, saveBuffer, saveBufferSize, buffered);
 }
 
 // get device name from device id
 int getBackupDeviceName(unsigned int backupDevice, char** deviceName)
 {
-    switch(backupDevice)
-    {
-        case JoInternalMemoryBackup:
-            *deviceName = "Internal Memory";
-            break;
-        case JoCartridgeMemoryBackup:
-            *deviceName = "Cartridge Memory";
-            break;
-        case JoExternalDeviceBackup:
-            *deviceName = "External Device";
-            break;
-        case ActionReplayBackup:
-            *deviceName = "Action Replay (Read-Only)";
-            break;
-        case SatiatorBackup:
-            *deviceName = "Satiator";
-            break;
-        case MODEBackup:
-            *deviceName = "MODE";
-            break;
-        case CdMemoryBackup:
-            *deviceName = "CD File System";
-            break;
-        case MemoryBackup:
-            *deviceName = "RAM";
-            break;
-        case VCDCardBackup:
-            *deviceName = "VCD Card";
-            break;
-        case SerialBackup:
-            *deviceName = "Serial Link";
-            break;
-        case ModemBackup:
-            *deviceName = "Modem";
-            break;
+    const BACKUP_MEDIUM* medium = getBackupMedium(backupDevice);
 
-        default:
-            sgc_core_error("Invalid backup device specified!! %d\n", backupDevice);
-            return -1;
+    if(medium == NULL)
+    {
+        return -1;
     }
 
+    *deviceName = medium->deviceName;
     return 0;
 }
 
@@ -351,41 +637,412 @@ bool isFileBUPExt(char* filename)
 }
 
 // validates the BUP header and extracts the various fields contained within
-int parseBupHeaderValues(PBUP_HEADER bupHeader, unsigned int totalBupSize, char* saveName, char* saveComment, unsigned char* saveLanguage, unsigned int* saveDate, unsigned int* saveSize, unsigned short* saveBlocks)
+// the header is read in place, it can live in any buffer e.g. a sector buffer
+// save->status is set to the result of validateBupHeader()
+int parseBupHeader(const void* bupHeader, unsigned int totalBupSize, PSAVES save)
 {
+    BUP_VIEW view = {0};
+    const char* field = NULL;
+    unsigned int length = 0;
     int result = 0;
 
-    if(!bupHeader || !totalBupSize || !saveName || !saveComment || !saveLanguage || !saveDate || !saveSize || !saveBlocks)
+    if(!bupHeader || !totalBupSize || !save)
     {
         return -1;
     }
 
+    save->status = SAVE_STATUS_CORRUPT;
+
     if(totalBupSize < BUP_HEADER_SIZE)
     {
         return -2;
     }
 
-    result = memcmp(bupHeader->magic, VMEM_MAGIC_STRING, sizeof(bupHeader->magic));
+    result = bup_view_init(&view, bupHeader, BUP_HEADER_SIZE);
+    if(result != 0)
+    {
+        return -3;
+    }
+
+    // size mismatches are reported through the status instead of failing
+    // so that the save is still listed
+    save->status = validateBupHeader(bupHeader, totalBupSize);
+
+    field = bup_view_name(&view, &length);
+    memcpy(save->name, field, length);
+    save->name[length] = '\0';
+
+    field = bup_view_comment(&view, &length);
+    memcpy(save->comment, field, length);
+    save->comment[length] = '\0';
+
+    save->language = bup_view_language(&view);
+    save->date = bup_view_date(&view);
+    save->datasize = bup_view_datasize(&view);
+    save->blocksize = bup_view_blocksize(&view);
+
+    return 0;
+}
+
+// checks the magic, sizes, name, language and date of the .BUP header in one pass
+// totalBupSize is the size of the header plus the save data
+// returns SAVE_STATUS_VALID, SAVE_STATUS_SUSPECT, or SAVE_STATUS_CORRUPT
+int validateBupHeader(const void* bupHeader, unsigned int totalBupSize)
+{
+    BUP_VIEW view = {0};
+    jo_backup_date date = {0};
+    const char* name = NULL;
+    unsigned int nameLength = 0;
+    unsigned int datasize = 0;
+    unsigned int storedSize = 0;
+    int status = SAVE_STATUS_VALID;
+
+    if(totalBupSize < BUP_HEADER_SIZE || bup_view_init(&view, bupHeader, BUP_HEADER_SIZE) != 0)
+    {
+        return SAVE_STATUS_CORRUPT;
+    }
+
+    datasize = bup_view_datasize(&view);
+    if(datasize > MAX_SAVE_SIZE)
+    {
+        return SAVE_STATUS_CORRUPT;
+    }
+
+    // the save data must be present in full
+    // packed saves store their packed size in the header
+    if(bup_is_packed(bupHeader))
+    {
+        storedSize = bup_packed_size(bupHeader);
+    }
+    else
+    {
+        storedSize = datasize + BUP_HEADER_SIZE;
+    }
+
+    if(totalBupSize < storedSize)
+    {
+        return SAVE_STATUS_CORRUPT;
+    }
+
+    // trailing data after the save
+    if(totalBupSize != storedSize)
+    {
+        status = SAVE_STATUS_SUSPECT;
+    }
+
+    // the BIOS can't address a save without a name
+    name = bup_view_name(&view, &nameLength);
+    if(nameLength == 0)
+    {
+        return SAVE_STATUS_CORRUPT;
+    }
+
+    // save names are printable ASCII
+    for(unsigned int i = 0; i < nameLength; i++)
+    {
+        if(name[i] < 0x20 || name[i] > 0x7E)
+        {
+            status = SAVE_STATUS_SUSPECT;
+            break;
+        }
+    }
+
+    if(bup_view_language(&view) > backup_italiano)
+    {
+        status = SAVE_STATUS_SUSPECT;
+    }
+
+    // games may leave the date as zero, but anything past 2099 is garbage
+    bup_getdate(bup_view_date(&view), &date);
+    if(date.year > (2099 - 1980))
+    {
+        status = SAVE_STATUS_SUSPECT;
+    }
+
+    return status;
+}
+
+// get a short description of the save status
+const char* getSaveStatusString(unsigned char status)
+{
+    switch(status)
+    {
+        case SAVE_STATUS_VALID:
+            return "Valid";
+        case SAVE_STATUS_SUSPECT:
+            return "Suspect";
+        case SAVE_STATUS_CORRUPT:
+            return "Corrupt";
+        default:
+            return "Unknown";
+    }
+}
+
+// bytes a successful read moved from the device
+// the save may be smaller than the buffer, packed saves more so
+static unsigned int getReadSize(const BACKUP_MEDIUM* medium, const unsigned char* buffer, unsigned int bufferSize)
+{
+    BUP_VIEW view = {0};
+    unsigned int size = 0;
+
+    if(!(medium->capabilities & BACKUP_CAP_BUP_HEADER) || bup_view_init(&view, buffer, bufferSize) != 0)
+    {
+        return bufferSize;
+    }
+
+    if(bup_is_packed(buffer))
+    {
+        size = bup_packed_size(buffer);
+    }
+    else
+    {
+        size = BUP_HEADER_SIZE + bup_view_datasize(&view);
+    }
+
+    return MIN(size, bufferSize);
+}
+
+// unpacks the packed save whose header readSaveFile() found in outBuffer
+// the packed save is read again a chunk at a time. Unpacking it in place would
+// need room for both the packed and the unpacked save in outBuffer
+static int unpackSaveFile(int backupDevice, char* filename, unsigned char* outBuffer, unsigned int outSize)
+{
+    BACKUP_STREAM stream = {0};
+    BUP_VIEW view = {0};
+    unsigned int size = 0;
+    int result = 0;
+
+    if(isStreamNative(backupDevice, STREAM_MODE_READ) == false)
+    {
+        sgc_core_error("Packed saves can't be read from this device!!");
+        return -1;
+    }
+
+    bup_view_init(&view, outBuffer, BUP_HEADER_SIZE);
+    size = BUP_HEADER_SIZE + bup_view_datasize(&view);
+    if(size > outSize)
+    {
+        sgc_core_error("Packed save unpacks to %d bytes!!", size);
+        return -2;
+    }
+
+    result = openStream(&stream, backupDevice, filename, STREAM_MODE_READ, size, NULL, 0, false);
+    if(result != 0)
+    {
+        return -3;
+    }
+
+    while(stream.position < size)
+    {
+        result = readSaveStream(&stream, outBuffer + stream.position, size - stream.position);
+        if(result <= 0)
+        {
+            closeSaveStream(&stream);
+            return -4;
+        }
+    }
+
+    result = closeSaveStream(&stream);
+    if(result != 0)
+    {
+        return -5;
+    }
+
+    return 0;
+}
+
+// reads the next bytes of a packed save, unpacking the next chunk when the current one is used up
+// returns the number of bytes read, negative on error
+static int readPackedStream(PBACKUP_STREAM stream, unsigned char* buffer, unsigned int size)
+{
+    unsigned char chunkHeader[BUP_PACK_CHUNK_HEADER_SIZE] = {0};
+    unsigned int chunkSize = 0;
+    int result = 0;
+
+    if(stream->chunkPosition == stream->chunkSize)
+    {
+        if(stream->packedRemaining < BUP_PACK_CHUNK_HEADER_SIZE)
+        {
+            sgc_core_error("Packed save is truncated!!");
+            return -1;
+        }
+
+        result = readDevice(stream, chunkHeader, BUP_PACK_CHUNK_HEADER_SIZE);
+        if(result < 0)
+        {
+            return -2;
+        }
+        stream->packedRemaining -= BUP_PACK_CHUNK_HEADER_SIZE;
+
+        chunkSize = bup_chunk_packed_size(chunkHeader);
+        if(chunkSize > BUP_PACK_CHUNK_SIZE || chunkSize > stream->packedRemaining)
+        {
+            sgc_core_error("Bad packed save chunk %d!!", stream->goodChunks);
+            return -3;
+        }
+
+        result = readDevice(stream, g_PackedChunk, chunkSize);
+        if(result < 0)
+        {
+            return -4;
+        }
+        stream->packedRemaining -= chunkSize;
+
+        g_PackedChunk[chunkSize] = 0;
+        g_PackedChunk[chunkSize + 1] = 0;
+
+        result = bup_unpack_chunk(chunkHeader, g_PackedChunk, g_UnpackedChunk, MIN(BUP_PACK_CHUNK_SIZE, stream->size - stream->position));
+        if(result < 0)
+        {
+            sgc_core_error("Bad packed save chunk %d (%d)!!", stream->goodChunks, result);
+            return -5;
+        }
+
+        stream->chunkSize = result;
+        stream->chunkPosition = 0;
+        stream->goodChunks++;
+    }
+
+    size = MIN(size, stream->chunkSize - stream->chunkPosition);
+    memcpy(buffer, g_UnpackedChunk + stream->chunkPosition, size);
+    stream->chunkPosition += size;
+    stream->position += size;
+
+    return size;
+}
+
+// reads exactly size bytes from the device
+// returns size on success, negative on error
+static int readDevice(PBACKUP_STREAM stream, unsigned char* buffer, unsigned int size)
+{
+    const BACKUP_MEDIUM* medium = getBackupMedium(stream->backupDevice);
+    unsigned int count = 0;
+    int result = 0;
+
+    while(count < size)
+    {
+        unsigned int chunk = size - count;
+
+        if(medium->maxChunkSize != 0)
+        {
+            chunk = MIN(chunk, medium->maxChunkSize);
+        }
+
+        result = medium->readChunk(stream, buffer + count, chunk);
+        if(result <= 0)
+        {
+                // the save is shorter than its header said
+            sgc_core_error("Short read %d at %d!!", result, stream->devicePosition);
+            return -1;
+        }
+
+        count += result;
+        stream->devicePosition += result;
+    }
+
+    return count;
+}
+
+// opens the stream, natively if the device supports it
+// buffered forces reading or writing the whole save in one go
+static int openStream(PBACKUP_STREAM stream, int backupDevice, char* filename, unsigned char mode, unsigned int size, unsigned char* saveBuffer, unsigned int saveBufferSize, bool buffered)
+{
+    const BACKUP_MEDIUM* medium = NULL;
+    int result = 0;
+
+    if(stream == NULL || filename == NULL || size == 0 || size > MAX_SAVE_SIZE + BUP_HEADER_SIZE)
+    {
+        return -1;
+    }
+
+    medium = getBackupMedium(backupDevice);
+    if(medium == NULL)
+    {
+        return -2;
+    }
+
+    memset(stream, 0, sizeof(BACKUP_STREAM));
+    stream->backupDevice = backupDevice;
+    stream->mode = mode;
+    stream->size = size;
+    strncpy(stream->filename, filename, MAX_FILENAME - 1);
+
+    if(isStreamNative(backupDevice, mode) == false)
+    {
+        buffered = true;
+    }
+
+    if(buffered == true)
+    {
+        return openBufferedStream(stream, saveBuffer, saveBufferSize);
+    }
+
+    statsBegin(&stream->stats);
+
+    result = medium->openStream(stream);
     if(result != 0)
     {
         return -3;
     }
 
-    if(totalBupSize != bupHeader->dir.datasize + BUP_HEADER_SIZE)
+    if(mode != STREAM_MODE_READ || !(medium->capabilities & BACKUP_CAP_BUP_HEADER) || size < BUP_HEADER_SIZE)
     {
-       // return -4
+        return 0;
     }
 
-    memcpy(saveName, bupHeader->dir.filename, sizeof(bupHeader->dir.filename));
-    saveName[sizeof(bupHeader->dir.filename) -1] = '\0';
+    // peek at the header to catch packed saves
+    result = readDevice(stream, stream->header, BUP_HEADER_SIZE);
+    if(result < 0)
+    {
+        medium->closeStream(stream);
+        return -4;
+    }
+    stream->headerSize = BUP_HEADER_SIZE;
 
-    memcpy(saveComment, bupHeader->dir.comment, sizeof(bupHeader->dir.comment));
-    saveComment[sizeof(bupHeader->dir.comment) -1] = '\0';
+    if(bup_is_packed(stream->header))
+    {
+        // the chunk buffers are shared
+        if(g_PackedStream != NULL)
+        {
+            sgc_core_error("Another packed save is open!!");
+            medium->closeStream(stream);
+            return -5;
+        }
+
+        g_PackedStream = stream;
+        stream->packed = true;
+        stream->packedRemaining = bup_packed_size(stream->header) - BUP_HEADER_SIZE;
+
+        // callers see the plain header
+        memset(stream->header + BUP_PACK_OFFSET_MAGIC, 0, BUP_PACK_MAGIC_LEN * 2);
+    }
+
+    return 0;
+}
 
-    *saveLanguage = bupHeader->dir.language;
-    *saveDate = bupHeader->dir.date;
-    *saveSize = bupHeader->dir.datasize;
-    *saveBlocks = bupHeader->dir.blocksize;
+// streams devices without native streaming through the caller's whole save buffer
+// a save doesn't fit in the Jo heap next to the save buffer jo_main() allocates
+static int openBufferedStream(PBACKUP_STREAM stream, unsigned char* saveBuffer, unsigned int saveBufferSize)
+{
+    int result = 0;
+
+    if(saveBuffer == NULL || stream->size > saveBufferSize)
+    {
+        sgc_core_error("No buffer for the %d byte save!!", stream->size);
+        return -1;
+    }
+
+    stream->buffer = saveBuffer;
+
+    if(stream->mode == STREAM_MODE_READ)
+    {
+        result = readSaveFile(stream->backupDevice, stream->filename, stream->buffer, stream->size);
+        if(result != 0)
+        {
+            stream->buffer = NULL;
+            return -2;
+        }
+    }
 
     return 0;
 }
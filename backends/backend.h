@@ -24,6 +24,11 @@
 #define SerialBackup (VCDCardBackup + 1)
 #define ModemBackup (SerialBackup + 1)
 
+// result of validating a save's .BUP header
+#define SAVE_STATUS_VALID       0 // header is consistent
+#define SAVE_STATUS_SUSPECT     1 // header has unusual values but the save can be copied
+#define SAVE_STATUS_CORRUPT     2 // header is unusable, the save must not be copied
+
 // meta data related to save files
 typedef struct  _SAVES {
     char filename[MAX_FILENAME]; // filename on the medium. Will have .BUP extension on CD FS and ODEs.
@@ -33,24 +38,101 @@ typedef struct  _SAVES {
     unsigned int date;
     unsigned int datasize;
     unsigned short blocksize;
+    unsigned char status; // SAVE_STATUS_XXX
+    bool directory; // subdirectory entry, browsed instead of copied
 } SAVES, *PSAVES;
 
+// capabilities of a backup device
+#define BACKUP_CAP_READ             0x0001 // saves can be read
+#define BACKUP_CAP_WRITE            0x0002 // saves can be written
+#define BACKUP_CAP_LIST             0x0004 // saves can be listed and browsed
+#define BACKUP_CAP_DELETE           0x0008 // saves can be deleted
+#define BACKUP_CAP_FORMAT           0x0010 // device can be formatted
+#define BACKUP_CAP_SAVE_NAME        0x0080 // saves are addressed by save name instead of filename
+#define BACKUP_CAP_BUP_HEADER       0x0100 // saves start with a .BUP header
+#define BACKUP_CAP_CD_BLOCK         0x0200 // device is accessed through the CD block
+#define BACKUP_CAP_DIRECTORIES      0x0400 // saves can be organized in per-game subdirectories
+
+#define STREAM_MODE_READ            0
+#define STREAM_MODE_WRITE           1
+
+// counters sampled when an operation starts, see stats.h
+typedef struct _STATS_MARK
+{
+    unsigned int startTicks;
+    unsigned int retries;
+    unsigned int switches;
+    unsigned int switchTicks;
+} STATS_MARK, *PSTATS_MARK;
+
+// an open save being read or written a chunk at a time
+typedef struct _BACKUP_STREAM
+{
+    int backupDevice;
+    char filename[MAX_FILENAME];
+    unsigned char mode; // STREAM_MODE_XXX
+    unsigned int size; // size of the save including the .BUP header
+    unsigned int position; // bytes transferred to or from the caller so far
+    unsigned int devicePosition; // bytes transferred to or from the device so far
+
+    int handle; // device specific, e.g. the Satiator file descriptor
+    unsigned int crc; // CRC32 of the data written, for devices that read back to verify
+
+    // reads peek at the .BUP header to catch packed saves
+    unsigned char header[BUP_HEADER_SIZE];
+    unsigned int headerSize;
+
+    // whole save buffer for devices without native streaming, lent by the caller
+    unsigned char* buffer;
+
+    // packed saves are unpacked a chunk at a time while reading
+    bool packed;
+    unsigned int packedRemaining; // bytes of the chunk list not read from the device yet
+    unsigned int chunkSize; // unpacked bytes of the current chunk
+    unsigned int chunkPosition; // bytes of the current chunk given to the caller
+    unsigned int goodChunks;
+
+    STATS_MARK stats; // native streams are timed from open to close
+} BACKUP_STREAM, *PBACKUP_STREAM;
+
+typedef bool (*BACKUP_AVAILABLE_FN)(int backupDevice);
 typedef int (*BACKUP_LIST_FN)(int backupDevice, PSAVES saves, unsigned int numSaves);
 typedef int (*BACKUP_READ_FN)(int backupDevice, char* filename, unsigned char* outBuffer, unsigned int outSize);
 typedef int (*BACKUP_WRITE_FN)(int backupDevice, char* filename, unsigned char* inBuffer, unsigned int inSize);
 typedef int (*BACKUP_DELETE_FN)(int backupDevice, char* filename);
 typedef int (*BACKUP_FORMAT_FN)(int backupDevice);
+typedef int (*BACKUP_OPEN_STREAM_FN)(PBACKUP_STREAM stream);
+typedef int (*BACKUP_READ_CHUNK_FN)(PBACKUP_STREAM stream, unsigned char* buffer, unsigned int size);
+typedef int (*BACKUP_WRITE_CHUNK_FN)(PBACKUP_STREAM stream, unsigned char* buffer, unsigned int size);
+typedef int (*BACKUP_CLOSE_STREAM_FN)(PBACKUP_STREAM stream);
+typedef int (*BACKUP_GENERATION_FN)(int backupDevice, unsigned int* generation);
+typedef int (*BACKUP_CHANGE_DIRECTORY_FN)(int backupDevice, char* directory);
 
+// describes a backup device. Operations a device doesn't support are NULL
+// devices without the stream functions are streamed through a whole save buffer
+// getGeneration returns a value that changes when the saves are changed outside of SGC
+// changeDirectory enters a subdirectory of the save directory or returns with JO_PARENT_DIR
 typedef struct _BACKUP_MEDIUM
 {
     int backupDevice;
     char* deviceName;
+    unsigned int capabilities; // BACKUP_CAP_XXX
+    unsigned int maxChunkSize; // largest single transfer the device does, 0 if there is no limit
 
+    BACKUP_AVAILABLE_FN isBackupDeviceAvailable;
     BACKUP_LIST_FN listSaveFiles;
     BACKUP_READ_FN readSaveFile;
     BACKUP_WRITE_FN writeSaveFile;
     BACKUP_DELETE_FN deleteSaveFile;
     BACKUP_FORMAT_FN formatDevice;
+
+    BACKUP_OPEN_STREAM_FN openStream;
+    BACKUP_READ_CHUNK_FN readChunk;
+    BACKUP_WRITE_CHUNK_FN writeChunk;
+    BACKUP_CLOSE_STREAM_FN closeStream;
+
+    BACKUP_GENERATION_FN getGeneration;
+    BACKUP_CHANGE_DIRECTORY_FN changeDirectory;
 } BACKUP_MEDIUM, *PBACKUP_MEDIUM;
 
 // access the save data
@@ -61,11 +143,26 @@ int readSaveFile(int backupDevice, char* filename, unsigned char* outBuffer, uns
 int writeSaveFile(int backupDevice, char* filename, unsigned char* inBuffer, unsigned int inSize);
 int deleteSaveFile(int backupDevice, char* filename);
 int formatDevice(int backupDevice);
+int changeSaveDirectory(int backupDevice, char* directory);
+const char* getSaveDirectory(int backupDevice);
+void resetSaveDirectory(int backupDevice);
+
+// stream the save data a chunk at a time
+int openSaveStream(PBACKUP_STREAM stream, int backupDevice, char* filename, unsigned char mode, unsigned int size, unsigned char* saveBuffer, unsigned int saveBufferSize);
+int readSaveStream(PBACKUP_STREAM stream, unsigned char* buffer, unsigned int size);
+int writeSaveStream(PBACKUP_STREAM stream, unsigned char* buffer, unsigned int size);
+int closeSaveStream(PBACKUP_STREAM stream);
+bool isStreamNative(int backupDevice, unsigned char mode);
+int openSaveStreamForCopy(PBACKUP_STREAM source, int sourceDevice, char* sourceFilename, int targetDevice, unsigned int size, unsigned char* saveBuffer, unsigned int saveBufferSize);
 
 // helper functions
+const BACKUP_MEDIUM* getBackupMedium(int backupDevice);
+bool hasBackupDeviceCapability(int backupDevice, unsigned int capabilities);
 int getBackupDeviceName(unsigned int backupDevice, char** deviceName);
 bool isFileBUPExt(char* filename);
-int parseBupHeaderValues(PBUP_HEADER bupHeader, unsigned int totalBupSize, char* saveName, char* saveComment, unsigned char* saveLanguage, unsigned int* saveDate, unsigned int* saveSize, unsigned short* saveBlocks);
+int parseBupHeader(const void* bupHeader, unsigned int totalBupSize, PSAVES save);
+int validateBupHeader(const void* bupHeader, unsigned int totalBupSize);
+const char* getSaveStatusString(unsigned char status);
 
 // prototypes to keep compiler happy
 int snprintf(char *str, size_t size, const char *format, ...);
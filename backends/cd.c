@@ -1,7 +1,20 @@
+#include "STDLIB.H"
 #include "cd.h"
+#include "cdindex.h"
+#include "session.h"
 
-static SAVES g_CachedSaveFiles[255] = {0};
-static unsigned int g_CachedSaveFilesCount = 0;
+// the CD block only serves one file at a time
+static jo_file g_StreamFile = {0};
+
+// per-game subdirectory of SATSAVES, empty when in SATSAVES itself
+static char g_CdDirectory[MAX_FILENAME] = {0};
+
+static bool cdIsDirectory(Sint32 fid);
+static int cdListDirectories(PSAVES saves, unsigned int numSaves);
+static GfsHn cdOpenFile(char* filename, unsigned int* fileSize);
+static int cdReadFile(GfsHn gfs, unsigned char* buffer, unsigned int size);
+static int cdListIndexedSaveFiles(PSAVES saves, unsigned int numSaves);
+static int compareIndexFilename(const void* key, const void* entry);
 
 // always return true for saves being present
 bool cdIsBackupDeviceAvailable(int backupDevice)
@@ -19,25 +32,25 @@ int cdListSaveFiles(int backupDevice, PSAVES saves, unsigned int numSaves)
 {
     unsigned int count = 0;
     GfsHn gfs = 0;
-    char* sub_dir = SAVES_DIRECTORY;
     BUP_HEADER bupHeader = {0};
+    int result = 0;
 
     if(backupDevice != CdMemoryBackup)
     {
         return -1;
     }
 
-    // check if we already cached the cd dir for faster perf
-    if(g_CachedSaveFilesCount > 0)
-    {
-        count = MIN(numSaves, g_CachedSaveFilesCount);
-        memcpy(saves, g_CachedSaveFiles, count * sizeof(SAVES));
-        return (int)count;
-    }
+    // stays in the SATSAVES directory until another device needs the CD block
+    sessionAcquire(SESSION_CDROM);
+
+    // subdirectories go first so a full directory of saves can't hide them
+    count = cdListDirectories(saves, numSaves);
 
-    if (sub_dir != JO_NULL)
+    // use the index generated at build time if it matches the disc
+    result = cdListIndexedSaveFiles(&saves[count], numSaves - count);
+    if(result >= 0)
     {
-        jo_fs_cd(sub_dir);
+        return count + result;
     }
 
     // Save-Game-Copier/issues/53
@@ -46,43 +59,47 @@ int cdListSaveFiles(int backupDevice, PSAVES saves, unsigned int numSaves)
     jo_printf(2, 5, "Reading saves, please wait...");
 
     // loop through the files on the directory
-    for(unsigned int i = 0; i < numSaves; i++)
+    for(unsigned int i = 2; count < numSaves; i++)
     {
         int numBytes = 0;
         char* filename = NULL;
 
-        gfs = GFS_Open(i+2);
-        if(gfs == NULL)
+        filename = (char*)GFS_IdToName(i);
+        if(filename == NULL)
         {
             break;
         }
 
+        // skip directories and other files without opening them
+        if(isFileBUPExt(filename) == false)
+        {
+            //sgc_core_error("Not a .BUP %s", filename);
+            continue;
+        }
+
+        gfs = GFS_Open(i);
+        if(gfs == NULL)
+        {
+            sgc_core_error("Failed to open .BUP %s", filename);
+            continue;
+        }
+
         // query the file size
         GFS_GetFileInfo(gfs, NULL, NULL, (Sint32*)&numBytes, NULL);
-        GFS_Close(gfs);
 
-        filename = (char*)GFS_IdToName(i+2);
-
-        if(filename && numBytes)
+        if(numBytes)
         {
-            bool result = false;
-
-            result = isFileBUPExt(filename);
-            if(result == false)
-            {
-                // not a .BUP file, skip
-                //sgc_core_error("Not a .BUP %s", filename);
-                continue;
-            }
+            // read the .BUP header while the file is still open
+            result = cdReadFile(gfs, (unsigned char*)&bupHeader, sizeof(BUP_HEADER));
+            GFS_Close(gfs);
 
-            result = cdReadBUPHeader(filename, &bupHeader);
             if(result != 0)
             {
                 sgc_core_error("Failed to read .BUP %s (%d)", filename, result);
                 continue;
             }
 
-            result = parseBupHeaderValues(&bupHeader, numBytes, saves[count].name, saves[count].comment, &saves[count].language, &saves[count].date, &saves[count].datasize, &saves[count].blocksize);
+            result = parseBupHeader(&bupHeader, numBytes, &saves[count]);
             if(result != 0)
             {
                 sgc_core_error("parseBup fail %s (%d)", filename, result);
@@ -93,29 +110,25 @@ int cdListSaveFiles(int backupDevice, PSAVES saves, unsigned int numSaves)
             strncpy((char*)saves[count].filename, filename, MAX_FILENAME);
             count++;
         }
+        else
+        {
+            GFS_Close(gfs);
+        }
     }
 
     // "erase" the waiting message    
     jo_printf(2, 5, "                             ");
 
-    // cache the cd results for faster perf
-    g_CachedSaveFilesCount = MIN((unsigned int)count, COUNTOF(g_CachedSaveFiles));
-    memcpy(g_CachedSaveFiles, saves, g_CachedSaveFilesCount * sizeof(SAVES));
-
-    if (sub_dir != JO_NULL)
-    {
-        jo_fs_cd(JO_PARENT_DIR);
-    }
-
     return count;
 }
 
 // read the save game
+// the whole .BUP is read straight into outBuffer with a single GFS request
 int cdReadSaveFile(int backupDevice, char* filename, unsigned char* outBuffer, unsigned int outSize)
 {
-    unsigned char* saveData = NULL;
-    char* sub_dir = SAVES_DIRECTORY;
-    int length = 0;
+    unsigned int fileSize = 0;
+    GfsHn gfs = NULL;
+    int result = 0;
 
     if(backupDevice != CdMemoryBackup)
     {
@@ -134,76 +147,382 @@ int cdReadSaveFile(int backupDevice, char* filename, unsigned char* outBuffer, u
         return -2;
     }
 
-    if(sub_dir != JO_NULL)
+    sessionAcquire(SESSION_CDROM);
+
+    gfs = cdOpenFile(filename, &fileSize);
+    if(gfs == NULL)
     {
-        jo_fs_cd(sub_dir);
+        // failed to open the save file
+        return -3;
     }
 
-    saveData = (unsigned char*)jo_fs_read_file(filename, &length);
+    result = cdReadFile(gfs, outBuffer, MIN(fileSize, outSize));
+    GFS_Close(gfs);
 
-    if(sub_dir != JO_NULL)
+    if(result != 0)
     {
-        jo_fs_cd(JO_PARENT_DIR);
+        // failed to read the save file
+        return -4;
     }
 
-    if(saveData != NULL)
+    return 0;
+}
+
+// enters a per-game subdirectory of SATSAVES or returns to SATSAVES with JO_PARENT_DIR
+int cdChangeDirectory(int backupDevice, char* directory)
+{
+    bool result = false;
+
+    if(backupDevice != CdMemoryBackup)
     {
-        // copy the save game data and free the jo engine buffer
-        memcpy(outBuffer, saveData, length);
-        jo_free(saveData);
+        return -1;
+    }
+
+    sessionAcquire(SESSION_CDROM);
+
+    if(strcmp(directory, JO_PARENT_DIR) == 0)
+    {
+        if(g_CdDirectory[0] == '\0')
+        {
+            // already in SATSAVES
+            return -2;
+        }
+
+        jo_fs_cd(JO_PARENT_DIR);
+        g_CdDirectory[0] = '\0';
         return 0;
     }
 
-    // failed to read the save file
-    return -3;
+    if(g_CdDirectory[0] != '\0')
+    {
+        sgc_core_error("Only one level of CD subdirectories is supported");
+        return -3;
+    }
+
+    result = jo_fs_cd(directory);
+    if(result != true)
+    {
+        sgc_core_error("failed to enter %s", directory);
+        return -4;
+    }
+
+    strncpy(g_CdDirectory, directory, MAX_FILENAME);
+    g_CdDirectory[MAX_FILENAME - 1] = '\0';
+
+    return 0;
 }
 
-// read the bup header
-int cdReadBUPHeader(char* filename, PBUP_HEADER bupHeader)
+// checksum of the GFS directory table of the current directory, read from
+// memory. The table is loaded from the disc whenever the CD block returns to
+// CD-ROM mode, so a different disc shows up the next time SGC comes back to the CD
+int cdGetGeneration(int backupDevice, unsigned int* generation)
 {
-    int result = 0;
-    jo_file joFile = {0};
-    bool openedFile = false;
+    GfsDirId dirInfo = {0};
+    unsigned int crc = 0;
 
-    if(!filename || !bupHeader)
+    if(backupDevice != CdMemoryBackup)
     {
         return -1;
     }
 
-    result = jo_fs_open(&joFile, filename);
+    sessionAcquire(SESSION_CDROM);
+
+    for(Sint32 i = 2; GFS_GetDirInfo(i, &dirInfo) == GFS_ERR_OK; i++)
+    {
+        crc = calculateCRC32((unsigned char*)&dirInfo.dirrec.fad, sizeof(dirInfo.dirrec.fad), crc);
+        crc = calculateCRC32((unsigned char*)&dirInfo.dirrec.size, sizeof(dirInfo.dirrec.size), crc);
+    }
+
+    *generation = crc;
+    return 0;
+}
+
+// switches to the current save directory when the CD block returns to CD-ROM mode
+// called by the session layer
+int cdEnter(void)
+{
+    jo_fs_cd(SAVES_DIRECTORY);
+
+    if(g_CdDirectory[0] != '\0')
+    {
+        jo_fs_cd(g_CdDirectory);
+    }
+
+    return 0;
+}
+
+// returns to the root directory of the ISO
+// called by the session layer
+void cdExit(void)
+{
+    if(g_CdDirectory[0] != '\0')
+    {
+        jo_fs_cd(JO_PARENT_DIR);
+    }
+
+    jo_fs_cd(JO_PARENT_DIR);
+}
+
+// open the save for streaming
+int cdOpenStream(PBACKUP_STREAM stream)
+{
+    bool result = false;
+
+    if(stream->mode != STREAM_MODE_READ)
+    {
+        return -1;
+    }
+
+    sessionAcquire(SESSION_CDROM);
+
+    result = jo_fs_open(&g_StreamFile, stream->filename);
+
     if(result != true)
+    {
+        sgc_core_error("failed to open %s", stream->filename);
+        return -2;
+    }
+
+    return 0;
+}
+
+// read the next bytes of the save
+int cdReadChunk(PBACKUP_STREAM stream, unsigned char* buffer, unsigned int size)
+{
+    UNUSED_ARG(stream);
+
+    return jo_fs_read_next_bytes(&g_StreamFile, (char*)buffer, size);
+}
+
+int cdCloseStream(PBACKUP_STREAM stream)
+{
+    UNUSED_ARG(stream);
+
+    jo_fs_close(&g_StreamFile);
+    return 0;
+}
+
+// checks the directory flag of the entry in the GFS directory table
+static bool cdIsDirectory(Sint32 fid)
+{
+    GfsDirId dirInfo = {0};
+
+    if(GFS_GetDirInfo(fid, &dirInfo) != GFS_ERR_OK)
+    {
+        return false;
+    }
+
+    return (dirInfo.dirrec.atr & GFS_ATR_DIR) != 0;
+}
+
+// adds an entry for every subdirectory of the current directory
+// the names come from the GFS directory table so this doesn't read the CD
+static int cdListDirectories(PSAVES saves, unsigned int numSaves)
+{
+    unsigned int count = 0;
+
+    for(unsigned int i = 2; count < numSaves; i++)
+    {
+        char* name = (char*)GFS_IdToName(i);
+
+        if(name == NULL)
+        {
+            break;
+        }
+
+        if(cdIsDirectory(i) == false)
+        {
+            continue;
+        }
+
+        // nothing below the per-game subdirectories
+        if(g_CdDirectory[0] != '\0')
+        {
+            sgc_core_error("%.12s has folders, only 1 level is listed", g_CdDirectory);
+            return 0;
+        }
+
+        memset(&saves[count], 0, sizeof(SAVES));
+        strncpy(saves[count].filename, name, MAX_FILENAME - 1);
+        strncpy(saves[count].name, name, MAX_SAVE_FILENAME - 1);
+        saves[count].directory = true;
+        count++;
+    }
+
+    return count;
+}
+
+// opens the file in the current directory and queries its size
+// returns NULL if the file doesn't exist
+static GfsHn cdOpenFile(char* filename, unsigned int* fileSize)
+{
+    Sint32 fid = 0;
+    Sint32 size = 0;
+    GfsHn gfs = NULL;
+
+    fid = GFS_NameToId((Sint8*)filename);
+    if(fid < 0)
+    {
+        return NULL;
+    }
+
+    gfs = GFS_Open(fid);
+    if(gfs == NULL)
     {
         sgc_core_error("failed to open %s", filename);
+        return NULL;
+    }
+
+    GFS_GetFileInfo(gfs, NULL, NULL, &size, NULL);
+    *fileSize = size;
+
+    return gfs;
+}
+
+// reads the first size bytes of the file directly into buffer
+// GFS transfers whole sectors from the CD block but stops copying at size bytes
+static int cdReadFile(GfsHn gfs, unsigned char* buffer, unsigned int size)
+{
+    Sint32 numSectors = (size + CD_SECTOR_SIZE - 1) / CD_SECTOR_SIZE;
+    Sint32 bytesRead = 0;
+
+    bytesRead = GFS_Fread(gfs, numSectors, buffer, size);
+    if(bytesRead < 0)
+    {
+        sgc_core_error("GFS_Fread failed %d", bytesRead);
+        return -1;
+    }
+
+    if(bytesRead < (Sint32)size)
+    {
+        sgc_core_error("Short read %d of %d", bytesRead, size);
+        return -2;
+    }
+
+    return 0;
+}
+
+// lists the saves from SATSAVES/INDEX.BIN with a single read
+// returns the number of saves, negative if the index is missing or stale
+static int cdListIndexedSaveFiles(PSAVES saves, unsigned int numSaves)
+{
+    PCD_INDEX_HEADER header = NULL;
+    PCD_INDEX_ENTRY entries = NULL;
+    unsigned char* index = NULL;
+    unsigned int numBupFiles = 0;
+    unsigned int count = 0;
+    unsigned int length = 0;
+    GfsHn gfs = NULL;
+    int result = 0;
+
+    // ISOs built without sgcindex or edited by hand don't have an index
+    gfs = cdOpenFile(CD_INDEX_FILENAME, &length);
+    if(gfs == NULL)
+    {
+        return -1;
+    }
+
+    index = jo_malloc(length);
+    if(index == NULL)
+    {
+        sgc_core_error("Failed to allocate CD save index!!");
+        GFS_Close(gfs);
+        return -2;
+    }
+
+    result = cdReadFile(gfs, index, length);
+    GFS_Close(gfs);
+
+    if(result != 0)
+    {
         result = -2;
         goto exit;
     }
 
-    openedFile = true;
+    header = (PCD_INDEX_HEADER)index;
+    entries = (PCD_INDEX_ENTRY)(index + sizeof(CD_INDEX_HEADER));
 
-    // read the .BUP header
-    result = jo_fs_read_next_bytes(&joFile, (char*)bupHeader, sizeof(BUP_HEADER));
-    if(result < 0)
+    if(length < sizeof(CD_INDEX_HEADER) ||
+       memcmp(header->magic, CD_INDEX_MAGIC, CD_INDEX_MAGIC_LEN) != 0 ||
+       header->version != CD_INDEX_VERSION ||
+       header->entrySize != sizeof(CD_INDEX_ENTRY) ||
+       header->numEntries > (length - sizeof(CD_INDEX_HEADER)) / sizeof(CD_INDEX_ENTRY))
     {
-        sgc_core_error("failed to read bup header %d", result);
+        sgc_core_error("Invalid CD save index");
         result = -3;
         goto exit;
     }
 
-    if(result < (int)sizeof(BUP_HEADER))
+    // the directory table is already in memory, so checking that every
+    // .BUP on the disc is in the index doesn't cost any CD reads
+    for(unsigned int i = 2; ; i++)
     {
-        sgc_core_error("bup header is too small");
-        result = -4;
-        goto exit;
+        char* filename = (char*)GFS_IdToName(i);
+        PCD_INDEX_ENTRY entry = NULL;
+        GfsDirId dirInfo = {0};
+
+        if(filename == NULL)
+        {
+            break;
+        }
+
+        if(isFileBUPExt(filename) == false)
+        {
+            continue;
+        }
+
+        entry = bsearch(filename, entries, header->numEntries, sizeof(CD_INDEX_ENTRY), compareIndexFilename);
+        if(entry == NULL)
+        {
+            // saves were added after the index was built
+            result = -4;
+            goto exit;
+        }
+
+        // a save replaced by one of the same name has a different size or
+        // was written somewhere else on the disc, sgcindex doesn't know the FAD
+        if(GFS_GetDirInfo(i, &dirInfo) != GFS_ERR_OK ||
+           (unsigned int)dirInfo.dirrec.size != entry->fileSize ||
+           (entry->fad != 0 && (unsigned int)dirInfo.dirrec.fad != entry->fad))
+        {
+            result = -6;
+            goto exit;
+        }
+
+        numBupFiles++;
     }
 
-    result = 0;
+    if(numBupFiles != header->numEntries)
+    {
+        // saves were removed after the index was built
+        result = -5;
+        goto exit;
+    }
 
-exit:
-    if(openedFile == true)
+    for(unsigned int i = 0; i < header->numEntries && count < numSaves; i++)
     {
-        jo_fs_close(&joFile);
+        PCD_INDEX_ENTRY entry = &entries[i];
+
+        result = parseBupHeader(entry->bupHeader, entry->fileSize, &saves[count]);
+        if(result != 0)
+        {
+            sgc_core_error("parseBup fail %s (%d)", entry->filename, result);
+            continue;
+        }
+
+        strncpy((char*)saves[count].filename, entry->filename, MAX_FILENAME);
+        count++;
     }
 
+    result = count;
+
+exit:
+    jo_free(index);
     return result;
 }
 
+// bsearch() comparison of a filename against an index entry
+static int compareIndexFilename(const void* key, const void* entry)
+{
+    return strcmp((const char*)key, ((PCD_INDEX_ENTRY)entry)->filename);
+}
@@ -2,10 +2,18 @@
 
 #include "backend.h"
 
+#define CD_SECTOR_SIZE 2048
+
 bool cdIsBackupDeviceAvailable(int backupDevice);
 int cdListSaveFiles(int backupDevice, PSAVES fileSaves, unsigned int numSaves);
 int cdReadSaveFile(int backupDevice, char* filename, unsigned char* ouBuffer, unsigned int outBufSize);
+int cdOpenStream(PBACKUP_STREAM stream);
+int cdReadChunk(PBACKUP_STREAM stream, unsigned char* buffer, unsigned int size);
+int cdCloseStream(PBACKUP_STREAM stream);
+int cdChangeDirectory(int backupDevice, char* directory);
+int cdGetGeneration(int backupDevice, unsigned int* generation);
 
-// helper functions
-int cdReadBUPHeader(char* filename, PBUP_HEADER bupHeader);
+// session helpers
+int cdEnter(void);
+void cdExit(void);
 
@@ -0,0 +1,48 @@
+/*
+ * cdindex.h - prebuilt listing of the CD saves
+ *
+ * tools/sgcindex generates SATSAVES/INDEX.BIN when the ISO is built so the
+ * CD backend can list every save with a single read instead of opening each
+ * .BUP. The file is a header followed by numEntries entries sorted by
+ * filename:
+ *
+ *  header
+ *  0-3   : CD_INDEX_MAGIC
+ *  4-7   : CD_INDEX_VERSION
+ *  8-11  : number of entries
+ *  12-15 : size in bytes of each entry
+ *
+ *  entry
+ *  0-15  : .BUP filename as it appears on the disc, NULL terminated
+ *  16-19 : size in bytes of the .BUP file
+ *  20-23 : FAD of the .BUP on the disc, 0 if not known when the index was built
+ *  24-87 : the 64 byte .BUP header
+ *
+ * Multibyte values are stored as big-endian. This header is shared with the
+ * host tool so it must not include any Saturn headers.
+ */
+#pragma once
+
+#define CD_INDEX_FILENAME           "INDEX.BIN"
+#define CD_INDEX_MAGIC              "SGCI"
+#define CD_INDEX_MAGIC_LEN          4
+#define CD_INDEX_VERSION            2
+
+#define CD_INDEX_MAX_FILENAME       16 // 8.3 name plus NULL, padded
+#define CD_INDEX_BUP_HEADER_SIZE    64
+
+typedef struct _CD_INDEX_HEADER
+{
+    char magic[CD_INDEX_MAGIC_LEN];
+    unsigned int version;
+    unsigned int numEntries;
+    unsigned int entrySize;
+} CD_INDEX_HEADER, *PCD_INDEX_HEADER;
+
+typedef struct _CD_INDEX_ENTRY
+{
+    char filename[CD_INDEX_MAX_FILENAME];
+    unsigned int fileSize;
+    unsigned int fad;
+    unsigned char bupHeader[CD_INDEX_BUP_HEADER_SIZE];
+} CD_INDEX_ENTRY, *PCD_INDEX_ENTRY;
@@ -0,0 +1,226 @@
+#include "dircache.h"
+
+// indexed by device id
+static DIR_CACHE g_DirCache[ModemBackup + 1] = {0};
+
+static PDIR_CACHE getDirCache(int backupDevice);
+static int getDeviceGeneration(int backupDevice, unsigned int* generation);
+static int findCachedSave(int backupDevice, PDIR_CACHE cache, char* filename);
+
+// copies the cached listing to saves
+// returns the number of saves, or -1 if the listing isn't cached or is stale
+int dirCacheGet(int backupDevice, PSAVES saves, unsigned int numSaves)
+{
+    PDIR_CACHE cache = getDirCache(backupDevice);
+    unsigned int generation = 0;
+    unsigned int count = 0;
+    int result = 0;
+
+    if(cache == NULL || cache->valid == false || saves == NULL)
+    {
+        return -1;
+    }
+
+    // catch changes made outside of SGC
+    result = getDeviceGeneration(backupDevice, &generation);
+    if(result != 0 || generation != cache->generation)
+    {
+        dirCacheInvalidate(backupDevice);
+        return -1;
+    }
+
+    count = MIN(numSaves, cache->numSaves);
+    memcpy(saves, cache->saves, count * sizeof(SAVES));
+
+    return (int)count;
+}
+
+// caches a fresh listing of the device
+void dirCacheStore(int backupDevice, PSAVES saves, unsigned int numSaves)
+{
+    PDIR_CACHE cache = getDirCache(backupDevice);
+    int result = 0;
+
+    if(cache == NULL || saves == NULL)
+    {
+        return;
+    }
+
+    cache->valid = false;
+
+    if(cache->saves == NULL)
+    {
+        cache->saves = jo_malloc(MAX_SAVES * sizeof(SAVES));
+        if(cache->saves == NULL)
+        {
+            // not fatal, the device just gets listed every time
+            return;
+        }
+    }
+
+    result = getDeviceGeneration(backupDevice, &cache->generation);
+    if(result != 0)
+    {
+        return;
+    }
+
+    cache->numSaves = MIN(numSaves, MAX_SAVES);
+    memcpy(cache->saves, saves, cache->numSaves * sizeof(SAVES));
+    cache->valid = true;
+}
+
+// adds or replaces the save in the cached listing after it was written
+// bupHeader and totalBupSize describe the .BUP that was written
+void dirCacheUpdateSave(int backupDevice, char* filename, const void* bupHeader, unsigned int totalBupSize)
+{
+    PDIR_CACHE cache = getDirCache(backupDevice);
+    SAVES save = {0};
+    int index = 0;
+    int result = 0;
+
+    if(cache == NULL || cache->valid == false)
+    {
+        return;
+    }
+
+    result = parseBupHeader(bupHeader, totalBupSize, &save);
+    if(result != 0)
+    {
+        // no idea what was written, list the device again
+        dirCacheInvalidate(backupDevice);
+        return;
+    }
+
+    // BUGBUG: internal devices are addressed by save name, see displaySave_draw()
+    if(hasBackupDeviceCapability(backupDevice, BACKUP_CAP_SAVE_NAME))
+    {
+        strncpy(save.name, filename, MAX_SAVE_FILENAME);
+        save.name[MAX_SAVE_FILENAME - 1] = '\0';
+        snprintf(save.filename, MAX_FILENAME, "%s.BUP", save.name);
+    }
+    else
+    {
+        strncpy(save.filename, filename, MAX_FILENAME);
+        save.filename[MAX_FILENAME - 1] = '\0';
+    }
+
+    index = findCachedSave(backupDevice, cache, filename);
+    if(index < 0)
+    {
+        if(cache->numSaves >= MAX_SAVES)
+        {
+            dirCacheInvalidate(backupDevice);
+            return;
+        }
+
+        index = cache->numSaves++;
+    }
+
+    cache->saves[index] = save;
+
+    // our own write shouldn't look like an outside change
+    result = getDeviceGeneration(backupDevice, &cache->generation);
+    if(result != 0)
+    {
+        dirCacheInvalidate(backupDevice);
+    }
+}
+
+// removes the save from the cached listing after it was deleted
+void dirCacheRemoveSave(int backupDevice, char* filename)
+{
+    PDIR_CACHE cache = getDirCache(backupDevice);
+    int index = 0;
+    int result = 0;
+
+    if(cache == NULL || cache->valid == false)
+    {
+        return;
+    }
+
+    index = findCachedSave(backupDevice, cache, filename);
+    if(index >= 0)
+    {
+        // keep the listing in device order
+        memmove(&cache->saves[index], &cache->saves[index + 1], (cache->numSaves - index - 1) * sizeof(SAVES));
+        cache->numSaves--;
+    }
+
+    result = getDeviceGeneration(backupDevice, &cache->generation);
+    if(result != 0)
+    {
+        dirCacheInvalidate(backupDevice);
+    }
+}
+
+// forces the device to be listed again
+void dirCacheInvalidate(int backupDevice)
+{
+    PDIR_CACHE cache = getDirCache(backupDevice);
+
+    if(cache == NULL)
+    {
+        return;
+    }
+
+    cache->valid = false;
+    cache->numSaves = 0;
+}
+
+// only listable devices that can tell when their saves changed are cached
+// without a generation a save changed outside of SGC, e.g. on the MODE's SD
+// card, would be listed with stale data until SGC was reset
+static PDIR_CACHE getDirCache(int backupDevice)
+{
+    const BACKUP_MEDIUM* medium = NULL;
+
+    if(backupDevice < 0 || backupDevice >= (int)COUNTOF(g_DirCache))
+    {
+        return NULL;
+    }
+
+    medium = getBackupMedium(backupDevice);
+    if(medium == NULL || medium->getGeneration == NULL || !(medium->capabilities & BACKUP_CAP_LIST))
+    {
+        return NULL;
+    }
+
+    return &g_DirCache[backupDevice];
+}
+
+static int getDeviceGeneration(int backupDevice, unsigned int* generation)
+{
+    const BACKUP_MEDIUM* medium = getBackupMedium(backupDevice);
+
+    *generation = 0;
+
+    if(medium == NULL || medium->getGeneration == NULL)
+    {
+        return -1;
+    }
+
+    return medium->getGeneration(backupDevice, generation);
+}
+
+// returns the index of the save in the cached listing or -1 if it isn't cached
+static int findCachedSave(int backupDevice, PDIR_CACHE cache, char* filename)
+{
+    bool bySaveName = hasBackupDeviceCapability(backupDevice, BACKUP_CAP_SAVE_NAME);
+
+    if(filename == NULL)
+    {
+        return -1;
+    }
+
+    for(unsigned int i = 0; i < cache->numSaves; i++)
+    {
+        char* cachedName = bySaveName ? cache->saves[i].name : cache->saves[i].filename;
+
+        if(strcmp(cachedName, filename) == 0)
+        {
+            return (int)i;
+        }
+    }
+
+    return -1;
+}
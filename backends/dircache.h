@@ -0,0 +1,27 @@
+#pragma once
+
+#include "backend.h"
+
+//
+// Directory cache - remembers the save listing of each device
+//
+// Listings are updated in place when saves are written or deleted through
+// backend.c. Devices are re-listed when their generation changes, e.g. a
+// different floppy disk was inserted. Devices without a generation function
+// are listed every time.
+//
+
+// cached listing of one device
+typedef struct _DIR_CACHE
+{
+    PSAVES saves; // allocated on first use
+    unsigned int numSaves;
+    unsigned int generation; // device generation when the listing was cached
+    bool valid;
+} DIR_CACHE, *PDIR_CACHE;
+
+int dirCacheGet(int backupDevice, PSAVES saves, unsigned int numSaves);
+void dirCacheStore(int backupDevice, PSAVES saves, unsigned int numSaves);
+void dirCacheUpdateSave(int backupDevice, char* filename, const void* bupHeader, unsigned int totalBupSize);
+void dirCacheRemoveSave(int backupDevice, char* filename);
+void dirCacheInvalidate(int backupDevice);
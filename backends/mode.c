@@ -1,5 +1,6 @@
 #include "mode.h"
 #include "mode/mode_intf.h"
+#include "session.h"
 #include "STRING.H"
 #include "SEGA_CDC.H"
 
@@ -9,7 +10,7 @@
 
 // Adjust this to be sector aligned, as MODE transfers entire sector blocks so align to sector size (+1) add an extra sector block at the end (+16)
 static struct _SatDirList SatSaves[MAX_SAVES + 1 + 16] __attribute__((section(".bss")));
-static unsigned char SectorBuffer[2048] __attribute__((section(".bss")));
+static unsigned char SectorBuffer[MODE_SECTOR_SIZE] __attribute__((section(".bss")));
 const char* SaveDirectory = "0:/SATSAVES";
 static char tmpFilename[64] __attribute__((section(".bss")));
 
@@ -35,15 +36,20 @@ bool modeIsBackupDeviceAvailable(int backupDevice)
     }
 
     // Trying to open MODE interface in a disc with a <40000h toc will hang due to the seek address wait.
-    MODE_Open();
+    sessionAcquire(SESSION_MODE);
 
     ms = MODE_GetMountStatus();	// GetMountStatus returns NULL if the MODE response is not right
     vi = MODE_GetVersionInfo(); // Actually mi and vi will share the same pointer if right, but we are only using data from vi from now on
 
-    modeExit();
+    // Needs at least 1.04 version for the File IO Interface
+    if(ms == NULL || ((vi->Ver << 8) | vi->Subver) < 0x0104)
+    {
+        sessionRelease();
+        return false;
+    }
 
-    // found MODE
-    return ms != NULL && ((vi->Ver << 8) | vi->Subver) >= 0x0104; // Needs at least 1.04 version for the File IO Interface
+    // found MODE, leave the interface open for the first listing
+    return true;
 }
 
 // queries the saves on the MODE and fills out the saves array
@@ -52,14 +58,14 @@ int modeListSaveFiles(int backupDevice, PSAVES saves, unsigned int numSaves)
     int len = 0;
     int result = 0;
     unsigned int count = 0;
-    BUP_HEADER bupHeader = {0};
+    const unsigned char* bupHeader = NULL;
 
     if(backupDevice != MODEBackup)
     {
         return -1;
     }
 
-    modeEnter();
+    sessionAcquire(SESSION_MODE);
 
     result = MODE_ReadFileListing(SaveDirectory, SatSaves, MAX_SAVES);
 
@@ -123,10 +129,12 @@ int modeListSaveFiles(int backupDevice, PSAVES saves, unsigned int numSaves)
         if (result != 0)
         {
             sgc_core_error("bup header %s", saves[n].filename);
+            saves[n].status = SAVE_STATUS_CORRUPT;
             continue;
         }
 
-        result = parseBupHeaderValues(&bupHeader, saves[n].datasize, saves[n].name, saves[n].comment, &saves[n].language, &saves[n].date, &saves[n].datasize, &saves[n].blocksize);
+        // the header is parsed straight out of the sector buffer
+        result = parseBupHeader(bupHeader, saves[n].datasize, &saves[n]);
         if (result != 0)
         {
             sgc_core_error("Failed with %d %s", result, saves[n].filename);
@@ -137,8 +145,6 @@ int modeListSaveFiles(int backupDevice, PSAVES saves, unsigned int numSaves)
         }
     }
 
-	modeExit();
-
     return count;
 }
 
@@ -164,7 +170,7 @@ int modeReadSaveFile(int backupDevice, char* filename, unsigned char* outBuffer,
         return -2;
     }
 
-    modeEnter();
+    sessionAcquire(SESSION_MODE);
 
     strcpy(tmpFilename, SaveDirectory);
     strcat(tmpFilename, "/");
@@ -173,7 +179,6 @@ int modeReadSaveFile(int backupDevice, char* filename, unsigned char* outBuffer,
     result = MODE_OpenFile(tmpFilename, 0);
     if(result != 0)
     {
-        modeExit();
         sgc_core_error("modeReadSaveFile: Failed to open MODE file!!");
         return -2;
     }
@@ -182,9 +187,9 @@ int modeReadSaveFile(int backupDevice, char* filename, unsigned char* outBuffer,
     {
         unsigned int count;
 
-        count = MIN(outSize - bytesRead, 2048);
+        count = MIN(outSize - bytesRead, MODE_SECTOR_SIZE);
 
-        MODE_ReadFile(SectorBuffer, bytesRead, 2048);
+        MODE_ReadFile(SectorBuffer, bytesRead, MODE_SECTOR_SIZE);
 
         for (unsigned int c = 0; c < count; ++c)
         {
@@ -196,8 +201,6 @@ int modeReadSaveFile(int backupDevice, char* filename, unsigned char* outBuffer,
 
     MODE_CloseFile();
 
-    modeExit();
-
     return 0;
 }
 
@@ -223,7 +226,7 @@ int modeWriteSaveFile(int backupDevice, char* filename, unsigned char* inBuffer,
         return -2;
     }
 
-    modeEnter();
+    sessionAcquire(SESSION_MODE);
 
     strcpy(tmpFilename, SaveDirectory);
     strcat(tmpFilename, "/");
@@ -232,7 +235,6 @@ int modeWriteSaveFile(int backupDevice, char* filename, unsigned char* inBuffer,
     result = MODE_OpenFile(tmpFilename, 1);
     if (result != 0)
     {
-        modeExit();
         sgc_core_error("modeWriteSaveFile: Failed to open MODE file for writing!!");
         return -2;
     }
@@ -241,7 +243,7 @@ int modeWriteSaveFile(int backupDevice, char* filename, unsigned char* inBuffer,
     {
         unsigned int count;
 
-        count = MIN(inSize - bytesWritten, 2048);
+        count = MIN(inSize - bytesWritten, MODE_SECTOR_SIZE);
 
         MODE_WriteFile(inBuffer + bytesWritten, bytesWritten, count);
 
@@ -250,8 +252,6 @@ int modeWriteSaveFile(int backupDevice, char* filename, unsigned char* inBuffer,
 
     MODE_CloseFile();
 
-    modeExit();
-
     return 0;
 }
 
@@ -269,7 +269,7 @@ int modeDeleteSaveFile(int backupDevice, char* filename)
         return -1;
     }
 
-    modeEnter();
+    sessionAcquire(SESSION_MODE);
 
     strcpy(tmpFilename, SaveDirectory);
     strcat(tmpFilename, "/");
@@ -277,11 +277,88 @@ int modeDeleteSaveFile(int backupDevice, char* filename)
 
     MODE_DeleteFile(tmpFilename);
 
-    modeExit();
+    return 0;
+}
+
+// open the save for streaming
+// MODE only has one file open at a time
+int modeOpenStream(PBACKUP_STREAM stream)
+{
+    int result = 0;
+
+    sessionAcquire(SESSION_MODE);
+
+    strcpy(tmpFilename, SaveDirectory);
+    strcat(tmpFilename, "/");
+    strcat(tmpFilename, stream->filename);
+
+    result = MODE_OpenFile(tmpFilename, stream->mode == STREAM_MODE_WRITE ? 1 : 0);
+    if(result != 0)
+    {
+        sgc_core_error("modeOpenStream: Failed to open MODE file!!");
+        return -1;
+    }
+
+    return 0;
+}
+
+// read up to the end of the sector at the current position
+// the header peek leaves the position mid-sector, MODE only reads whole
+// sectors from a sector boundary so the rest is served from SectorBuffer
+int modeReadChunk(PBACKUP_STREAM stream, unsigned char* buffer, unsigned int size)
+{
+    unsigned int offset = stream->devicePosition % MODE_SECTOR_SIZE;
+
+    size = MIN(size, MODE_SECTOR_SIZE - offset);
+
+    MODE_ReadFile(SectorBuffer, stream->devicePosition - offset, MODE_SECTOR_SIZE);
+    memcpy(buffer, SectorBuffer + offset, size);
+
+    return size;
+}
+
+// write up to the end of the sector at the current position
+// partial sectors are gathered in SectorBuffer and written once full or at close
+int modeWriteChunk(PBACKUP_STREAM stream, unsigned char* buffer, unsigned int size)
+{
+    unsigned int offset = stream->devicePosition % MODE_SECTOR_SIZE;
+
+    size = MIN(size, MODE_SECTOR_SIZE - offset);
+
+    // whole sector, no need to gather it
+    if(offset == 0 && size == MODE_SECTOR_SIZE)
+    {
+        MODE_WriteFile(buffer, stream->devicePosition, size);
+        return size;
+    }
+
+    memcpy(SectorBuffer + offset, buffer, size);
+
+    if(offset + size == MODE_SECTOR_SIZE)
+    {
+        MODE_WriteFile(SectorBuffer, stream->devicePosition - offset, MODE_SECTOR_SIZE);
+    }
+
+    return size;
+}
+
+// writes the last partial sector before closing the file
+int modeCloseStream(PBACKUP_STREAM stream)
+{
+    unsigned int offset = stream->devicePosition % MODE_SECTOR_SIZE;
+
+    if(stream->mode == STREAM_MODE_WRITE && offset != 0)
+    {
+        MODE_WriteFile(SectorBuffer, stream->devicePosition - offset, offset);
+    }
+
+    MODE_CloseFile();
 
     return 0;
 }
 
+// open the MODE command interface
+// called by the session layer, backends use sessionAcquire(SESSION_MODE)
 int modeEnter(void)
 {
     MODE_Open();
@@ -302,7 +379,9 @@ void MODE_WaitVSync(void)
 }
 
 // read the bup header
-int modeReadBUPHeader(char* filename, PBUP_HEADER bupHeader)
+// on success bupHeader points to the header within the sector buffer. It is
+// only valid until the next MODE read
+int modeReadBUPHeader(char* filename, const unsigned char** bupHeader)
 {
     int result = 0;
 
@@ -323,8 +402,8 @@ int modeReadBUPHeader(char* filename, PBUP_HEADER bupHeader)
     }
 
     //MODE always reads in sector chunks, so we would be overwritting the stack if reading directly to the header buffer
-    MODE_ReadFile(SectorBuffer, 0, 2048);
-    memcpy((unsigned char*)bupHeader, SectorBuffer, sizeof(BUP_HEADER));
+    MODE_ReadFile(SectorBuffer, 0, MODE_SECTOR_SIZE);
+    *bupHeader = SectorBuffer;
 
     MODE_CloseFile();
 
@@ -2,6 +2,8 @@
 
 #include "backend.h"
 
+#define MODE_SECTOR_SIZE 2048
+
 //
 // MODE support contributed by Terraonion (https://github.com/Terraonion-dev)
 //
@@ -11,8 +13,12 @@ int modeListSaveFiles(int backupDevice, PSAVES fileSaves, unsigned int numSaves)
 int modeReadSaveFile(int backupDevice, char* filename, unsigned char* ouBuffer, unsigned int outBufSize);
 int modeWriteSaveFile(int backupDevice, char* filename, unsigned char* saveData, unsigned int saveDataLen);
 int modeDeleteSaveFile(int backupDevice, char* filename);
+int modeOpenStream(PBACKUP_STREAM stream);
+int modeReadChunk(PBACKUP_STREAM stream, unsigned char* buffer, unsigned int size);
+int modeWriteChunk(PBACKUP_STREAM stream, unsigned char* buffer, unsigned int size);
+int modeCloseStream(PBACKUP_STREAM stream);
 
 // helper functions
 int modeEnter(void);
 int modeExit(void);
-int modeReadBUPHeader(char* filename, PBUP_HEADER bupHeader);
+int modeReadBUPHeader(char* filename, const unsigned char** bupHeader);
@@ -1,5 +1,6 @@
 #include <jo/modem.h>
 #include "modem.h"
+#include "stats.h"
 
 #define CONNECT_DIAL_NUMBER   "199407"
 #define CONNECT_DIAL_TIMEOUT  180000000  /* ~60 seconds at 28.6MHz */
@@ -10,6 +11,7 @@ saturn_uart16550_t g_uart = {0};
 static bool g_modem_initialized = false;
 
 static int connect_modem(void);
+static int send_bytes(unsigned char* data, unsigned int size);
 
 // Check if the modem interface is available
 bool modemIsBackupDeviceAvailable(int backupDevice)
@@ -67,9 +69,7 @@ int modemReadSaveFile(int backupDevice, char* filename, unsigned char* outBuffer
 
 // Write the save
 int modemWriteSaveFile(int backupDevice, char* filename, unsigned char* saveData, unsigned int saveDataLen)
-{   
-    unsigned int bytesWritten = 0; 
-    int consecutiveErrors = 0;
+{
     int result = 0;
 
     if(backupDevice != ModemBackup)
@@ -95,33 +95,54 @@ int modemWriteSaveFile(int backupDevice, char* filename, unsigned char* saveData
         sgc_core_error("modemWriteSaveFile: Save file size is invalid %d!!", saveDataLen);
         return -2;
     }
-    
-    while(bytesWritten < saveDataLen)
-    {        
-        result = modem_send_bytes(&g_uart, &saveData[bytesWritten], sizeof(unsigned char));
-        if(result != 1)
-        {
-            consecutiveErrors++;
-            // check if we had too many errors in a row
-            if(consecutiveErrors >= MAX_SEND_ERRORS)
-            {
-                sgc_core_error("modem send %d %d", result, bytesWritten);
-                return -3;
-            }
-            else
-            {
-                continue;
-            }
-        }
 
-        // reset error count after every successful send
-        consecutiveErrors = 0;
-        bytesWritten += 1;
+    return send_bytes(saveData, saveDataLen);
+}
+
+// Open a save to stream over the modem
+// dials on first use, the connection stays up for later saves
+int modemOpenStream(PBACKUP_STREAM stream)
+{
+    int result = 0;
+
+    if(stream->mode != STREAM_MODE_WRITE)
+    {
+        return -1;
+    }
+
+    result = connect_modem();
+    if(result != 0)
+    {
+        sgc_core_error("connect: %d", result);
+        return result;
     }
 
     return 0;
 }
 
+// Send the next chunk of the save
+int modemWriteChunk(PBACKUP_STREAM stream, unsigned char* buffer, unsigned int size)
+{
+    int result = 0;
+
+    UNUSED_ARG(stream);
+
+    result = send_bytes(buffer, size);
+    if(result != 0)
+    {
+        return result;
+    }
+
+    return size;
+}
+
+int modemCloseStream(PBACKUP_STREAM stream)
+{
+    UNUSED_ARG(stream);
+
+    return 0;
+}
+
 // Delete the save
 // TODO: this will involve having something on the other end respond
 int modemDeleteSaveFile(int backupDevice, char* filename)
@@ -166,6 +187,8 @@ static int connect_modem(void)
         {
             break;
         }
+
+        statsAddRetries(1);
     }
 
     if(result != MODEM_OK)
@@ -194,3 +217,37 @@ static int connect_modem(void)
 
     return 0;
 }
+
+// send the bytes, retrying on errors
+static int send_bytes(unsigned char* data, unsigned int size)
+{
+    unsigned int bytesWritten = 0;
+    int consecutiveErrors = 0;
+    int result = 0;
+
+    while(bytesWritten < size)
+    {
+        result = modem_send_bytes(&g_uart, &data[bytesWritten], sizeof(unsigned char));
+        if(result != 1)
+        {
+            consecutiveErrors++;
+            statsAddRetries(1);
+            // check if we had too many errors in a row
+            if(consecutiveErrors >= MAX_SEND_ERRORS)
+            {
+                sgc_core_error("modem send %d %d", result, bytesWritten);
+                return -3;
+            }
+            else
+            {
+                continue;
+            }
+        }
+
+        // reset error count after every successful send
+        consecutiveErrors = 0;
+        bytesWritten += 1;
+    }
+
+    return 0;
+}
@@ -8,3 +8,6 @@ int modemListSaveFiles(int backupDevice, PSAVES fileSaves, unsigned int numSaves
 int modemReadSaveFile(int backupDevice, char* filename, unsigned char* ouBuffer, unsigned int outBufSize);
 int modemWriteSaveFile(int backupDevice, char* filename, unsigned char* saveData, unsigned int saveDataLen);
 int modemDeleteSaveFile(int backupDevice, char* filename);
+int modemOpenStream(PBACKUP_STREAM stream);
+int modemWriteChunk(PBACKUP_STREAM stream, unsigned char* buffer, unsigned int size);
+int modemCloseStream(PBACKUP_STREAM stream);
@@ -0,0 +1,326 @@
+#include "ramdisk.h"
+
+static unsigned char* g_RamDisk = NULL;
+static unsigned int g_RamDiskSize = 0;
+static unsigned int g_RamDiskUsed = 0; // files are packed at the start of the storage
+
+static RAMDISK_FILE g_RamDiskFiles[RAMDISK_MAX_FILES] = {0};
+static unsigned int g_RamDiskNumFiles = 0;
+
+static int initRamDisk(void);
+static int findFile(char* filename);
+static int createFile(char* filename, unsigned int size);
+static void removeFile(int index);
+
+// returns true if there is memory for the RAM disk
+bool ramdiskIsBackupDeviceAvailable(int backupDevice)
+{
+    if(backupDevice != MemoryBackup)
+    {
+        return false;
+    }
+
+    return initRamDisk() == 0;
+}
+
+// lists the .BUP files on the RAM disk
+int ramdiskListSaveFiles(int backupDevice, PSAVES saves, unsigned int numSaves)
+{
+    unsigned int count = 0;
+    int result = 0;
+
+    if(backupDevice != MemoryBackup || initRamDisk() != 0)
+    {
+        return -1;
+    }
+
+    for(unsigned int i = 0; i < g_RamDiskNumFiles && count < numSaves; i++)
+    {
+        PRAMDISK_FILE file = &g_RamDiskFiles[i];
+
+        memset(&saves[count], 0, sizeof(SAVES));
+
+        result = parseBupHeader(g_RamDisk + file->offset, file->size, &saves[count]);
+        if(result != 0)
+        {
+            sgc_core_error("bup header %.20s", file->filename);
+            saves[count].status = SAVE_STATUS_CORRUPT;
+        }
+
+        strncpy(saves[count].filename, file->filename, MAX_FILENAME);
+        saves[count].filename[MAX_FILENAME - 1] = '\0';
+        count++;
+    }
+
+    return count;
+}
+
+// copies the file to outBuffer
+int ramdiskReadSaveFile(int backupDevice, char* filename, unsigned char* outBuffer, unsigned int outSize)
+{
+    int index = 0;
+
+    if(backupDevice != MemoryBackup || initRamDisk() != 0)
+    {
+        return -1;
+    }
+
+    if(outBuffer == NULL || filename == NULL)
+    {
+        sgc_core_error("ramdiskReadSaveFile: Save file data buffer is NULL!!");
+        return -1;
+    }
+
+    index = findFile(filename);
+    if(index < 0)
+    {
+        sgc_core_error("ramdiskReadSaveFile: %.20s not found!!", filename);
+        return -2;
+    }
+
+    memcpy(outBuffer, g_RamDisk + g_RamDiskFiles[index].offset, MIN(outSize, g_RamDiskFiles[index].size));
+
+    return 0;
+}
+
+// writes the file, replacing it if it already exists
+int ramdiskWriteSaveFile(int backupDevice, char* filename, unsigned char* inBuffer, unsigned int inSize)
+{
+    int index = 0;
+
+    if(backupDevice != MemoryBackup || initRamDisk() != 0)
+    {
+        return -1;
+    }
+
+    if(inBuffer == NULL || filename == NULL || inSize == 0)
+    {
+        sgc_core_error("ramdiskWriteSaveFile: Save file size is invalid %d!!", inSize);
+        return -2;
+    }
+
+    index = createFile(filename, inSize);
+    if(index < 0)
+    {
+        return -3;
+    }
+
+    memcpy(g_RamDisk + g_RamDiskFiles[index].offset, inBuffer, inSize);
+
+    return 0;
+}
+
+// deletes the file and compacts the files after it
+int ramdiskDeleteSaveFile(int backupDevice, char* filename)
+{
+    int index = 0;
+
+    if(backupDevice != MemoryBackup || initRamDisk() != 0)
+    {
+        return -1;
+    }
+
+    if(filename == NULL)
+    {
+        sgc_core_error("ramdiskDeleteSaveFile: Filename is NULL!!");
+        return -1;
+    }
+
+    index = findFile(filename);
+    if(index < 0)
+    {
+        return -2;
+    }
+
+    removeFile(index);
+
+    return 0;
+}
+
+// deletes every file
+int ramdiskFormatDevice(int backupDevice)
+{
+    if(backupDevice != MemoryBackup || initRamDisk() != 0)
+    {
+        return -1;
+    }
+
+    g_RamDiskNumFiles = 0;
+    g_RamDiskUsed = 0;
+
+    return 0;
+}
+
+// open the file for streaming
+// writes reserve the whole file up front
+int ramdiskOpenStream(PBACKUP_STREAM stream)
+{
+    int index = 0;
+
+    if(initRamDisk() != 0)
+    {
+        return -1;
+    }
+
+    if(stream->mode == STREAM_MODE_READ)
+    {
+        index = findFile(stream->filename);
+    }
+    else
+    {
+        index = createFile(stream->filename, stream->size);
+    }
+
+    if(index < 0)
+    {
+        sgc_core_error("ramdiskOpenStream: Failed to open %.20s!!", stream->filename);
+        return -2;
+    }
+
+    stream->handle = index;
+    return 0;
+}
+
+// read the next bytes of the file
+int ramdiskReadChunk(PBACKUP_STREAM stream, unsigned char* buffer, unsigned int size)
+{
+    PRAMDISK_FILE file = &g_RamDiskFiles[stream->handle];
+
+    if(stream->devicePosition >= file->size)
+    {
+        return 0;
+    }
+
+    size = MIN(size, file->size - stream->devicePosition);
+    memcpy(buffer, g_RamDisk + file->offset + stream->devicePosition, size);
+
+    return size;
+}
+
+// write the next bytes of the file
+int ramdiskWriteChunk(PBACKUP_STREAM stream, unsigned char* buffer, unsigned int size)
+{
+    PRAMDISK_FILE file = &g_RamDiskFiles[stream->handle];
+
+    size = MIN(size, file->size - stream->devicePosition);
+    memcpy(g_RamDisk + file->offset + stream->devicePosition, buffer, size);
+
+    return size;
+}
+
+// partially written files are deleted
+int ramdiskCloseStream(PBACKUP_STREAM stream)
+{
+    if(stream->mode == STREAM_MODE_WRITE && stream->devicePosition != stream->size)
+    {
+        removeFile(stream->handle);
+        return -1;
+    }
+
+    return 0;
+}
+
+// bytes left for new files
+unsigned int ramdiskGetFreeBytes(void)
+{
+    if(initRamDisk() != 0)
+    {
+        return 0;
+    }
+
+    return g_RamDiskSize - g_RamDiskUsed;
+}
+
+// picks the RAM disk storage on first use
+static int initRamDisk(void)
+{
+    unsigned char cartId = 0;
+
+    if(g_RamDisk != NULL)
+    {
+        return 0;
+    }
+
+    cartId = *(volatile unsigned char*)RAMDISK_CART_ID_ADDRESS;
+
+    if(cartId == RAMDISK_CART_ID_1MB || cartId == RAMDISK_CART_ID_4MB)
+    {
+        *(volatile unsigned short*)RAMDISK_CART_ENABLE = 1;
+
+        g_RamDisk = (unsigned char*)RAMDISK_CART_RAM;
+        g_RamDiskSize = cartId == RAMDISK_CART_ID_4MB ? RAMDISK_CART_4MB_SIZE : RAMDISK_CART_1MB_SIZE;
+        return 0;
+    }
+
+    g_RamDisk = jo_malloc(RAMDISK_HEAP_SIZE);
+    if(g_RamDisk == NULL)
+    {
+        return -1;
+    }
+
+    g_RamDiskSize = RAMDISK_HEAP_SIZE;
+    return 0;
+}
+
+// returns the index of the file or -1 if it doesn't exist
+static int findFile(char* filename)
+{
+    for(unsigned int i = 0; i < g_RamDiskNumFiles; i++)
+    {
+        if(strncmp(g_RamDiskFiles[i].filename, filename, MAX_FILENAME) == 0)
+        {
+            return (int)i;
+        }
+    }
+
+    return -1;
+}
+
+// allocates space for the file at the end of the storage, replacing any existing file
+// returns the index of the file or negative if the RAM disk is full
+static int createFile(char* filename, unsigned int size)
+{
+    PRAMDISK_FILE file = NULL;
+    int index = 0;
+
+    index = findFile(filename);
+    if(index >= 0)
+    {
+        removeFile(index);
+    }
+
+    if(g_RamDiskNumFiles >= RAMDISK_MAX_FILES || size > g_RamDiskSize - g_RamDiskUsed)
+    {
+        sgc_core_error("RAM disk is full!!");
+        return -1;
+    }
+
+    file = &g_RamDiskFiles[g_RamDiskNumFiles];
+    strncpy(file->filename, filename, MAX_FILENAME);
+    file->filename[MAX_FILENAME - 1] = '\0';
+    file->offset = g_RamDiskUsed;
+    file->size = size;
+
+    g_RamDiskUsed += size;
+
+    return g_RamDiskNumFiles++;
+}
+
+// removes the file and slides the files after it down so the free space stays contiguous
+static void removeFile(int index)
+{
+    PRAMDISK_FILE file = &g_RamDiskFiles[index];
+    unsigned int end = file->offset + file->size;
+    unsigned int size = file->size;
+
+    memmove(g_RamDisk + file->offset, g_RamDisk + end, g_RamDiskUsed - end);
+    g_RamDiskUsed -= size;
+
+    for(unsigned int i = index + 1; i < g_RamDiskNumFiles; i++)
+    {
+        g_RamDiskFiles[i].offset -= size;
+        g_RamDiskFiles[i - 1] = g_RamDiskFiles[i];
+    }
+
+    g_RamDiskNumFiles--;
+}
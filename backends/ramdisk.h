@@ -0,0 +1,46 @@
+#pragma once
+
+#include "backend.h"
+
+//
+// RAM disk - holds .BUP files in memory as a fast staging area
+//
+// Uses the RAM of an extended RAM cartridge if one is inserted, otherwise a
+// region of the Jo Engine heap. The contents are lost on reset.
+//
+
+// the host build in tools/sgcsim points the addresses at a simulated cartridge
+#ifndef RAMDISK_CART_ID_ADDRESS
+#define RAMDISK_CART_ID_ADDRESS     0x24FFFFFF // cartridge id register
+#define RAMDISK_CART_ENABLE         0x257EFFFE // write 1 to enable writes to the cartridge RAM
+#define RAMDISK_CART_RAM            0x22400000
+#endif
+#define RAMDISK_CART_ID_1MB         0x5A
+#define RAMDISK_CART_ID_4MB         0x5C
+#define RAMDISK_CART_1MB_SIZE       (512 * 1024) // 1MB carts are two 512KB banks, only the first is used
+#define RAMDISK_CART_4MB_SIZE       (4 * 1024 * 1024)
+#define RAMDISK_HEAP_SIZE           (256 * 1024) // used without a RAM cartridge
+#define RAMDISK_MAX_FILES           MAX_SAVES
+
+// a file on the RAM disk
+// files are packed back to back in the order they were written
+typedef struct _RAMDISK_FILE
+{
+    char filename[MAX_FILENAME];
+    unsigned int offset; // from the start of the RAM disk storage
+    unsigned int size; // size of the file including the .BUP header
+} RAMDISK_FILE, *PRAMDISK_FILE;
+
+bool ramdiskIsBackupDeviceAvailable(int backupDevice);
+int ramdiskListSaveFiles(int backupDevice, PSAVES saves, unsigned int numSaves);
+int ramdiskReadSaveFile(int backupDevice, char* filename, unsigned char* outBuffer, unsigned int outSize);
+int ramdiskWriteSaveFile(int backupDevice, char* filename, unsigned char* inBuffer, unsigned int inSize);
+int ramdiskDeleteSaveFile(int backupDevice, char* filename);
+int ramdiskFormatDevice(int backupDevice);
+int ramdiskOpenStream(PBACKUP_STREAM stream);
+int ramdiskReadChunk(PBACKUP_STREAM stream, unsigned char* buffer, unsigned int size);
+int ramdiskWriteChunk(PBACKUP_STREAM stream, unsigned char* buffer, unsigned int size);
+int ramdiskCloseStream(PBACKUP_STREAM stream);
+
+// helper functions
+unsigned int ramdiskGetFreeBytes(void);
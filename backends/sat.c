@@ -92,7 +92,7 @@ int satListSaves(unsigned char* partitionBuf, unsigned int partitionSize, unsign
         // validate range
         if((unsigned char*)metadata < partitionBuf || (unsigned char*)metadata >= partitionBuf + partitionSize)
         {
-            sgc_core_error("%x %x %x\n", partitionBuf, metadata, partitionSize);
+            sgc_core_error("%p %p %x\n", partitionBuf, metadata, partitionSize);
             return -3;
         }
 
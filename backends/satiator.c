@@ -1,5 +1,75 @@
 #include "satiator.h"
 #include "satiator/satiator.h"
+#include "session.h"
+#include "../bup_pack.h"
+
+// API mode resets the CD block, GFS is initialized again on the way out
+// the table only has to hold the root directory of the ISO, jo_fs_cd() loads
+// SATSAVES into jo engine's own table
+#define SATIATOR_GFS_OPEN_MAX       4
+#define SATIATOR_GFS_ROOT_ENTRIES   32
+
+static GfsDirTbl g_GfsDirTable;
+static GfsDirName g_GfsDirNames[SATIATOR_GFS_ROOT_ENTRIES];
+static Uint32 g_GfsWork[GFS_WORK_SIZE(SATIATOR_GFS_OPEN_MAX) / sizeof(Uint32)];
+
+// directory entry fields that change when a save is rewritten
+typedef struct _SATIATOR_FILE_KEY
+{
+    unsigned int size;
+    unsigned short date;
+    unsigned short time;
+} SATIATOR_FILE_KEY, *PSATIATOR_FILE_KEY;
+
+// .BUP header read during an earlier listing
+typedef struct _SATIATOR_HEADER
+{
+    char filename[MAX_FILENAME];
+    SATIATOR_FILE_KEY key;
+    BUP_HEADER bupHeader;
+    bool valid;
+} SATIATOR_HEADER, *PSATIATOR_HEADER;
+
+// headers of the saves in one directory
+// entries are kept in directory order so most lookups hit on the first try
+typedef struct _SATIATOR_HEADER_CACHE
+{
+    char directory[MAX_FILENAME]; // empty for SATSAVES
+    PSATIATOR_HEADER headers;
+    unsigned int numHeaders;
+    unsigned int lastUsed;
+} SATIATOR_HEADER_CACHE, *PSATIATOR_HEADER_CACHE;
+
+// every open/read/close is a round trip through the CD block so headers are
+// only read again when the save's directory entry changes. This is what keeps
+// listing the Satiator cheap, it has no generation for dircache.c: telling if
+// any save changed takes the same directory walk as listing with this cache
+// SATSAVES and the most recently browsed per-game directories stay cached
+#define SATIATOR_CACHED_DIRECTORIES 3
+static SATIATOR_HEADER_CACHE g_HeaderCaches[SATIATOR_CACHED_DIRECTORIES] = {0};
+static PSATIATOR_HEADER_CACHE g_HeaderCache = NULL; // cache of the current directory
+static unsigned int g_HeaderCacheClock = 0;
+
+// true while the CD block is in Satiator API mode
+static bool g_SatiatorApiMode = false;
+
+// current per-game subdirectory of SATSAVES, empty for SATSAVES itself
+static char g_SatiatorDirectory[MAX_FILENAME] = {0};
+
+// saves are written here first and renamed over the save once complete
+// so an interrupted write never leaves a truncated .BUP behind
+// not a .BUP so a leftover temp file is never listed
+#define SATIATOR_TEMP_FILENAME "SGCWRITE.TMP"
+
+// directory entry of each listed save, indexed like the saves array
+static SATIATOR_FILE_KEY g_ListingKeys[MAX_SAVES] = {0};
+
+static void selectHeaderCache(void);
+static int findCachedHeader(char* filename, PSATIATOR_FILE_KEY key, unsigned int hint);
+static int getBUPHeader(char* filename, PSATIATOR_FILE_KEY key, unsigned int index, PBUP_HEADER bupHeader);
+static void forgetCachedHeader(char* filename);
+static int satiatorCommitFile(char* filename);
+static int satiatorRead(int fd, unsigned char* buffer, unsigned int size);
 
 // returns true if the backup device is found
 bool satiatorIsBackupDeviceAvailable(int backupDevice)
@@ -11,7 +81,7 @@ bool satiatorIsBackupDeviceAvailable(int backupDevice)
         return false;
     }
 
-    result = satiatorEnter();
+    result = sessionAcquire(SESSION_SATIATOR);
     if(result != 0)
     {
         // failed to find Satiator
@@ -37,7 +107,7 @@ int satiatorListSaveFiles(int backupDevice, PSAVES saves, unsigned int numSaves)
         return -1;
     }
 
-    result = satiatorEnter();
+    result = sessionAcquire(SESSION_SATIATOR);
     if(result != 0)
     {
         sgc_core_error("Failed to detect satiator");
@@ -51,20 +121,39 @@ int satiatorListSaveFiles(int backupDevice, PSAVES saves, unsigned int numSaves)
         return -2;
     }
 
+    selectHeaderCache();
+
     // loop through the files in the directory
     while ((len = s_stat(NULL, st, sizeof(statbuf)-1)) > 0)
     {
         st->name[len] = 0;
 
-        //skip directories
-        if(st->attrib & AM_DIR)
+        // skip . and .. (and anything beginning with .)
+        if (st->name[0] == '.')
         {
             continue;
         }
 
-        // skip . and .. (and anything beginning with .)
-        if (st->name[0] == '.')
+        // per-game directories, only one level below SATSAVES
+        // names that don't fit can't be entered so they are skipped
+        if(st->attrib & AM_DIR)
         {
+            if(g_SatiatorDirectory[0] != '\0' || len >= MAX_FILENAME)
+            {
+                continue;
+            }
+
+            memset(&saves[count], 0, sizeof(SAVES));
+            strncpy(saves[count].filename, st->name, MAX_FILENAME - 1);
+            strncpy(saves[count].name, st->name, MAX_SAVE_FILENAME - 1);
+            saves[count].directory = true;
+            count++;
+
+            if(count >= numSaves || count >= MAX_SAVES)
+            {
+                break;
+            }
+
             continue;
         }
 
@@ -77,11 +166,16 @@ int satiatorListSaveFiles(int backupDevice, PSAVES saves, unsigned int numSaves)
 
         strncpy((char*)saves[count].filename, st->name, MAX_FILENAME);
         saves[count].filename[MAX_FILENAME - 1] = '\0';
+        saves[count].directory = false;
         saves[count].datasize = st->size - sizeof(BUP_HEADER);
         saves[count].blocksize = 0; // blocksize on the Satiator doesn't matter
+
+        g_ListingKeys[count].size = st->size;
+        g_ListingKeys[count].date = st->date;
+        g_ListingKeys[count].time = st->time;
         count++;
 
-        if(count >= numSaves)
+        if(count >= numSaves || count >= MAX_SAVES)
         {
             break;
         }
@@ -92,14 +186,20 @@ int satiatorListSaveFiles(int backupDevice, PSAVES saves, unsigned int numSaves)
     {
         BUP_HEADER bupHeader = {0};
 
-        result = satiatorReadBUPHeader(saves[i].filename, &bupHeader);
+        if(saves[i].directory == true)
+        {
+            continue;
+        }
+
+        result = getBUPHeader(saves[i].filename, &g_ListingKeys[i], i, &bupHeader);
         if(result != 0)
         {
             sgc_core_error("bup header %s", saves[i].filename);
+            saves[i].status = SAVE_STATUS_CORRUPT;
             continue;
         }
 
-        result = parseBupHeaderValues(&bupHeader, saves[count].datasize + sizeof(BUP_HEADER), saves[i].name, saves[i].comment, &saves[i].language, &saves[i].date, &saves[i].datasize, &saves[i].blocksize);
+        result = parseBupHeader(&bupHeader, saves[i].datasize + sizeof(BUP_HEADER), &saves[i]);
         if(result != 0)
         {
             sgc_core_error("Failed with %d", result);
@@ -112,6 +212,12 @@ int satiatorListSaveFiles(int backupDevice, PSAVES saves, unsigned int numSaves)
         }
     }
 
+    // headers past the end of the listing belong to deleted saves
+    if(g_HeaderCache != NULL)
+    {
+        g_HeaderCache->numHeaders = MIN(g_HeaderCache->numHeaders, count);
+    }
+
     // BUGBUG: close the directory??
     return count;
 }
@@ -127,8 +233,8 @@ int satiatorReadSaveFile(int backupDevice, char* filename, unsigned char* outBuf
         return -1;
     }
 
-    result = satiatorEnter();
-    if(result == 0)
+    result = sessionAcquire(SESSION_SATIATOR);
+    if(result != 0)
     {
         // why is it failing to detect now??
         //sgc_core_error("Failed to detect satiator %d", result);
@@ -154,26 +260,18 @@ int satiatorReadSaveFile(int backupDevice, char* filename, unsigned char* outBuf
         return -2;
     }
 
-    for(unsigned int bytesRead = 0; bytesRead < outSize; )
-    {
-        unsigned int count;
-
-        count = MIN(outSize - bytesRead, S_MAXBUF);
+    result = satiatorRead(fd, outBuffer, outSize);
 
-        // BUGBUG: fix this
-        result = s_read(fd, outBuffer + bytesRead, count);
-        if(result <= 0)
-        {
-            sgc_core_error("Bad read result: %x", result);
-            s_close(fd);
-            return result;
-        }
+    s_close(fd);
 
-        bytesRead += count;
+    // packed saves are smaller than the unpacked size the caller asks for
+    if(result >= 0 && (unsigned int)result < outSize &&
+       (result < BUP_HEADER_SIZE || bup_is_packed(outBuffer) == false))
+    {
+        sgc_core_error("Bad read result: %x", result);
+        result = -1;
     }
 
-    s_close(fd);
-
     if(result < 0)
     {
         sgc_core_error("readSatiatorSaveFile: Failed to read satiator file!!");
@@ -194,7 +292,7 @@ int satiatorWriteSaveFile(int backupDevice, char* filename, unsigned char* inBuf
         return -1;
     }
 
-    result = satiatorEnter();
+    result = sessionAcquire(SESSION_SATIATOR);
     if(result != 0)
     {
         sgc_core_error("Failed to detect satiator");
@@ -213,7 +311,9 @@ int satiatorWriteSaveFile(int backupDevice, char* filename, unsigned char* inBuf
         return -2;
     }
 
-    fd = s_open(filename, FA_WRITE|FA_CREATE_ALWAYS);
+    forgetCachedHeader(filename);
+
+    fd = s_open(SATIATOR_TEMP_FILENAME, FA_WRITE|FA_CREATE_ALWAYS);
     if(fd < 0)
     {
         sgc_core_error("writeSatiatorSaveData: Failed to open satiator file!!");
@@ -226,30 +326,49 @@ int satiatorWriteSaveFile(int backupDevice, char* filename, unsigned char* inBuf
 
         count = MIN(inSize - bytesWritten, S_MAXBUF);
 
-        // BUGBUG: fix this
         result = s_write(fd, inBuffer + bytesWritten, count);
 
-        s_sync(fd);
-
         if(result <= 0)
         {
             sgc_core_error("Bad write result: %x", result);
             s_close(fd);
+            s_unlink(SATIATOR_TEMP_FILENAME);
             return result;
-            break;
         }
 
-        bytesWritten += count;
+        // short writes are retried with the remainder
+        bytesWritten += result;
     }
 
+    // syncing every chunk flushes the SD card for every 2KB
+    // one sync at the end is enough to make sure the save reached the card
+    result = s_sync(fd);
     s_close(fd);
 
     if(result < 0)
     {
-        sgc_core_error("writeSatiatorSaveData: Failed to read satiator file!!");
+        sgc_core_error("writeSatiatorSaveData: Failed to sync satiator file!!");
+        s_unlink(SATIATOR_TEMP_FILENAME);
         return -3;
     }
 
+#if SATIATOR_WRITE_POLICY == SATIATOR_WRITE_PARANOID
+    result = satiatorVerifyFile(SATIATOR_TEMP_FILENAME, inSize, calculateCRC32(inBuffer, inSize, 0));
+    if(result != 0)
+    {
+        sgc_core_error("writeSatiatorSaveData: Failed to verify satiator file!!");
+        s_unlink(SATIATOR_TEMP_FILENAME);
+        return -4;
+    }
+#endif
+
+    result = satiatorCommitFile(filename);
+    if(result != 0)
+    {
+        sgc_core_error("writeSatiatorSaveData: Failed to rename satiator file!!");
+        return -5;
+    }
+
     return 0;
 }
 
@@ -263,7 +382,7 @@ int satiatorDeleteSaveFile(int backupDevice, char* filename)
         return -1;
     }
 
-    result = satiatorEnter();
+    result = sessionAcquire(SESSION_SATIATOR);
     if(result != 0)
     {
         sgc_core_error("Failed to detect satiator");
@@ -276,6 +395,8 @@ int satiatorDeleteSaveFile(int backupDevice, char* filename)
         return -1;
     }
 
+    forgetCachedHeader(filename);
+
     result = s_unlink(filename);
 
     if(result < 0)
@@ -287,8 +408,116 @@ int satiatorDeleteSaveFile(int backupDevice, char* filename)
     return 0;
 }
 
+// open the save for streaming
+int satiatorOpenStream(PBACKUP_STREAM stream)
+{
+    int fd = 0;
+
+    // see satiatorReadSaveFile(), detection isn't reliable here
+    sessionAcquire(SESSION_SATIATOR);
+
+    if(stream->mode == STREAM_MODE_READ)
+    {
+        fd = s_open(stream->filename, FA_READ);
+    }
+    else
+    {
+        forgetCachedHeader(stream->filename);
+        fd = s_open(SATIATOR_TEMP_FILENAME, FA_WRITE|FA_CREATE_ALWAYS);
+    }
+
+    if(fd < 0)
+    {
+        sgc_core_error("satiatorOpenStream: Failed to open satiator file!!");
+        return -1;
+    }
+
+    stream->handle = fd;
+    stream->crc = 0;
+    return 0;
+}
+
+// read up to S_MAXBUF bytes
+int satiatorReadChunk(PBACKUP_STREAM stream, unsigned char* buffer, unsigned int size)
+{
+    return satiatorRead(stream->handle, buffer, size);
+}
+
+// write up to S_MAXBUF bytes
+int satiatorWriteChunk(PBACKUP_STREAM stream, unsigned char* buffer, unsigned int size)
+{
+    int result = 0;
+
+    result = s_write(stream->handle, buffer, size);
+
+#if SATIATOR_WRITE_POLICY == SATIATOR_WRITE_PARANOID
+    if(result > 0)
+    {
+        stream->crc = calculateCRC32(buffer, result, stream->crc);
+    }
+#endif
+
+    return result;
+}
+
+// written saves are synced once here instead of after every chunk
+// and only replace the existing save once they are complete
+int satiatorCloseStream(PBACKUP_STREAM stream)
+{
+    int result = 0;
+
+    if(stream->mode == STREAM_MODE_READ)
+    {
+        result = s_close(stream->handle);
+        if(result < 0)
+        {
+            sgc_core_error("satiatorCloseStream: Failed to close satiator file!!");
+            return -5;
+        }
+
+        return 0;
+    }
+
+    result = s_sync(stream->handle);
+    s_close(stream->handle);
+
+    if(result < 0)
+    {
+        sgc_core_error("satiatorCloseStream: Failed to sync satiator file!!");
+        s_unlink(SATIATOR_TEMP_FILENAME);
+        return -1;
+    }
+
+    // never replace a save with a partial one
+    if(stream->devicePosition != stream->size)
+    {
+        s_unlink(SATIATOR_TEMP_FILENAME);
+        return -2;
+    }
+
+#if SATIATOR_WRITE_POLICY == SATIATOR_WRITE_PARANOID
+    result = satiatorVerifyFile(SATIATOR_TEMP_FILENAME, stream->size, stream->crc);
+    if(result != 0)
+    {
+        sgc_core_error("satiatorCloseStream: Failed to verify satiator file!!");
+        s_unlink(SATIATOR_TEMP_FILENAME);
+        return -3;
+    }
+#endif
+
+    result = satiatorCommitFile(stream->filename);
+    if(result != 0)
+    {
+        sgc_core_error("satiatorCloseStream: Failed to rename satiator file!!");
+        return -4;
+    }
+
+    return 0;
+}
+
 // enable satiator extra mode
 // without this you cannot access the filesystem
+// called by the session layer, backends use sessionAcquire(SESSION_SATIATOR)
 int satiatorEnter(void)
 {
     int result;
@@ -298,18 +527,138 @@ int satiatorEnter(void)
     {
         return -1;
     }
-    s_chdir("/SATSAVES");
+
+    g_SatiatorApiMode = true;
+
+    // create SATSAVES on a fresh SD card
+    result = s_chdir("/" SAVES_DIRECTORY);
+    if(result != 0)
+    {
+        s_mkdir("/" SAVES_DIRECTORY);
+        result = s_chdir("/" SAVES_DIRECTORY);
+        if(result != 0)
+        {
+            // the session layer expects the CD block back in CD-ROM mode
+            satiatorExit();
+            return -2;
+        }
+
+        // a new card, the per-game folder last used is on the old one
+        if(g_SatiatorDirectory[0] != '\0')
+        {
+            g_SatiatorDirectory[0] = '\0';
+            resetSaveDirectory(SatiatorBackup);
+        }
+    }
+
+    if(g_SatiatorDirectory[0] != '\0')
+    {
+        result = s_chdir(g_SatiatorDirectory);
+        if(result != 0)
+        {
+            // removed from another machine, stay in SATSAVES
+            g_SatiatorDirectory[0] = '\0';
+            resetSaveDirectory(SatiatorBackup);
+        }
+    }
+
+    return 0;
+}
+
+// enters a per-game subdirectory of SATSAVES, JO_PARENT_DIR goes back up
+// the directory is created if it doesn't exist
+int satiatorChangeDirectory(int backupDevice, char* directory)
+{
+    int result = 0;
+
+    if(backupDevice != SatiatorBackup)
+    {
+        return -1;
+    }
+
+    result = sessionAcquire(SESSION_SATIATOR);
+    if(result != 0)
+    {
+        return -1;
+    }
+
+    if(strcmp(directory, JO_PARENT_DIR) == 0)
+    {
+        if(g_SatiatorDirectory[0] == '\0')
+        {
+            // already in SATSAVES
+            return -2;
+        }
+
+        s_chdir("..");
+        g_SatiatorDirectory[0] = '\0';
+        return 0;
+    }
+
+    if(g_SatiatorDirectory[0] != '\0')
+    {
+        sgc_core_error("Only one level of Satiator subdirectories is supported");
+        return -3;
+    }
+
+    if(strlen(directory) >= MAX_FILENAME)
+    {
+        return -4;
+    }
+
+    result = s_chdir(directory);
+    if(result != 0)
+    {
+        s_mkdir(directory);
+        result = s_chdir(directory);
+        if(result != 0)
+        {
+            sgc_core_error("failed to enter %s", directory);
+            return -5;
+        }
+    }
+
+    strncpy(g_SatiatorDirectory, directory, MAX_FILENAME);
+    g_SatiatorDirectory[MAX_FILENAME - 1] = '\0';
+
     return 0;
 }
 
 // exit satiator extra mode
-// BUGBUG: this does not appear to work and ends up with the ISO no longer being accessible
+// returns the CD block to CD-ROM mode in the root directory of the ISO
+// the Satiator API reuses the CD block buffers GFS reads through so GFS
+// must be initialized again before the ISO can be accessed
+// called by the session layer
 int satiatorExit(void)
 {
+    int result = 0;
 
-    // BUGBUG: this doesn't quite work correctly
-    //s_chdir("..");
-    //s_mode(S_MODE_CDROM);
+    if(g_SatiatorApiMode == false)
+    {
+        return 0;
+    }
+
+    g_SatiatorApiMode = false;
+
+    // waits for the drive to settle
+    result = s_mode(s_cdrom);
+    if(result != 0)
+    {
+        sgc_core_error("Failed to return the Satiator to CD-ROM mode");
+        return -1;
+    }
+
+    GFS_DIRTBL_TYPE(&g_GfsDirTable) = GFS_DIR_NAME;
+    GFS_DIRTBL_DIRNAME(&g_GfsDirTable) = g_GfsDirNames;
+    GFS_DIRTBL_NDIR(&g_GfsDirTable) = SATIATOR_GFS_ROOT_ENTRIES;
+
+    // returns the number of entries in the root directory, . and .. included
+    result = GFS_Init(SATIATOR_GFS_OPEN_MAX, g_GfsWork, &g_GfsDirTable);
+    if(result <= 2)
+    {
+        sgc_core_error("Failed to reinitialize the CD file system");
+        return -2;
+    }
 
     return 0;
 }
@@ -333,8 +682,10 @@ int satiatorReadBUPHeader(char* filename, PBUP_HEADER bupHeader)
         return -2;
     }
 
+    openedFile = true;
+
     // read the .BUP header
-    result = s_read(fd, (unsigned char*)bupHeader, sizeof(BUP_HEADER));
+    result = satiatorRead(fd, (unsigned char*)bupHeader, sizeof(BUP_HEADER));
     if(result <= 0)
     {
         sgc_core_error("Bad read result: %x", result);
@@ -342,8 +693,6 @@ int satiatorReadBUPHeader(char* filename, PBUP_HEADER bupHeader)
         goto exit;
     }
 
-    openedFile = true;
-
     if(result < (int)sizeof(BUP_HEADER))
     {
         sgc_core_error("bup header is too small");
@@ -362,18 +711,331 @@ exit:
     return result;
 }
 
-// relaunch the satiator menu
-void satiatorReboot(void)
+// reads the file back and compares its size and CRC32
+// returns 0 if the file matches
+int satiatorVerifyFile(char* filename, unsigned int size, unsigned int crc)
+{
+    static unsigned char buffer[S_MAXBUF] __attribute__((aligned(4)));
+    unsigned int bytesRead = 0;
+    unsigned int fileCrc = 0;
+    int result = 0;
+    int fd = 0;
+
+    fd = s_open(filename, FA_READ);
+    if(fd < 0)
+    {
+        return -1;
+    }
+
+    while(bytesRead < size)
+    {
+        result = satiatorRead(fd, buffer, MIN(size - bytesRead, S_MAXBUF));
+        if(result <= 0)
+        {
+            break;
+        }
+
+        fileCrc = calculateCRC32(buffer, result, fileCrc);
+        bytesRead += result;
+    }
+
+    // the file must not be longer than what was written either
+    if(bytesRead == size && satiatorRead(fd, buffer, 1) != 0)
+    {
+        bytesRead++;
+    }
+
+    s_close(fd);
+
+    if(bytesRead != size || fileCrc != crc)
+    {
+        return -2;
+    }
+
+    return 0;
+}
+
+// s_read() into a buffer of any alignment, until size bytes or the end of the file
+// the data register is read a 32-bit word at a time into an aligned buffer
+// and the last word is stored whole. After a short read the next byte is
+// mid-word, so reads up to the next word boundary and the last few bytes of
+// the buffer go through a word on the stack
+// returns the number of bytes read, negative on error
+static int satiatorRead(int fd, unsigned char* buffer, unsigned int size)
+{
+    unsigned int bytesRead = 0;
+    int result = 0;
+
+    while(bytesRead < size)
+    {
+        unsigned char* next = buffer + bytesRead;
+        unsigned int count = MIN(size - bytesRead, S_MAXBUF);
+        unsigned int head = (4 - ((unsigned long)next & 3)) & 3;
+
+        if(head != 0 || count < 4)
+        {
+            unsigned int word = 0;
+
+            if(head != 0)
+            {
+                count = MIN(count, head);
+            }
+
+            result = s_read(fd, &word, count);
+            if(result > 0)
+            {
+                memcpy(next, &word, result);
+            }
+        }
+        else
+        {
+            // whole words so the last one stays inside the buffer
+            result = s_read(fd, next, count & ~3);
+        }
+
+        if(result < 0)
+        {
+            return result;
+        }
+
+        // end of the file
+        if(result == 0)
+        {
+            break;
+        }
+
+        bytesRead += result;
+    }
+
+    return bytesRead;
+}
+
+// points g_HeaderCache at the cache of the current directory
+// the least recently listed directory is evicted to make room
+static void selectHeaderCache(void)
+{
+    PSATIATOR_HEADER_CACHE cache = NULL;
+
+    g_HeaderCacheClock++;
+
+    for(unsigned int i = 0; i < SATIATOR_CACHED_DIRECTORIES; i++)
+    {
+        if(strcmp(g_HeaderCaches[i].directory, g_SatiatorDirectory) == 0 && g_HeaderCaches[i].lastUsed != 0)
+        {
+            cache = &g_HeaderCaches[i];
+            break;
+        }
+
+        if(cache == NULL || g_HeaderCaches[i].lastUsed < cache->lastUsed)
+        {
+            cache = &g_HeaderCaches[i];
+        }
+    }
+
+    if(strcmp(cache->directory, g_SatiatorDirectory) != 0 || cache->lastUsed == 0)
+    {
+        // the header array is reused by the new directory
+        strncpy(cache->directory, g_SatiatorDirectory, MAX_FILENAME);
+        cache->directory[MAX_FILENAME - 1] = '\0';
+        cache->numHeaders = 0;
+    }
+
+    cache->lastUsed = g_HeaderCacheClock;
+    g_HeaderCache = cache;
+}
+
+// returns the index of the cached header for the file, -1 if it isn't cached
+// hint is checked first, it is where the header was in the previous listing
+static int findCachedHeader(char* filename, PSATIATOR_FILE_KEY key, unsigned int hint)
+{
+    for(unsigned int i = 0; i <= g_HeaderCache->numHeaders; i++)
+    {
+        // try the hint first, then everything else
+        unsigned int index = (i == 0) ? hint : i - 1;
+        PSATIATOR_HEADER header = NULL;
+
+        if(index >= g_HeaderCache->numHeaders || (i != 0 && index == hint))
+        {
+            continue;
+        }
+
+        header = &g_HeaderCache->headers[index];
+
+        if(header->valid &&
+           header->key.size == key->size &&
+           header->key.date == key->date &&
+           header->key.time == key->time &&
+           strcmp(header->filename, filename) == 0)
+        {
+            return index;
+        }
+    }
+
+    return -1;
+}
+
+// returns the .BUP header of the listed save from the cache or the Satiator
+// the header is cached at index, the save's position in the listing
+static int getBUPHeader(char* filename, PSATIATOR_FILE_KEY key, unsigned int index, PBUP_HEADER bupHeader)
 {
-    s_mode(s_api);
-    for (volatile int i=0; i<2000; i++)
-        ;
+    PSATIATOR_HEADER header = NULL;
+    int found = 0;
+    int result = 0;
 
-    int (**bios_get_mpeg_rom)(uint32_t index, uint32_t size, uint32_t addr) = (void*)0x06000298;
-    (*bios_get_mpeg_rom)(2, 2, 0x200000);
+    if(g_HeaderCache->headers == NULL)
+    {
+        g_HeaderCache->headers = jo_malloc(MAX_SAVES * sizeof(SATIATOR_HEADER));
+        if(g_HeaderCache->headers == NULL)
+        {
+            // no cache, read the header every time
+            return satiatorReadBUPHeader(filename, bupHeader);
+        }
+        g_HeaderCache->numHeaders = 0;
+    }
 
-    ((void(*)(void))0x200000)();
+    found = findCachedHeader(filename, key, index);
+    if(found >= 0)
+    {
+        // keep the cache in directory order for the next listing
+        if((unsigned int)found != index && index < g_HeaderCache->numHeaders)
+        {
+            SATIATOR_HEADER temp = g_HeaderCache->headers[index];
+            g_HeaderCache->headers[index] = g_HeaderCache->headers[found];
+            g_HeaderCache->headers[found] = temp;
+            found = index;
+        }
 
-    // should never get here
+        memcpy(bupHeader, &g_HeaderCache->headers[found].bupHeader, sizeof(BUP_HEADER));
+        return 0;
+    }
+
+    result = satiatorReadBUPHeader(filename, bupHeader);
+    if(result != 0)
+    {
+        return result;
+    }
+
+    // append the header so the entry at index, which a later save in the
+    // listing may still need, isn't lost. Only overwrite it when full
+    if(g_HeaderCache->numHeaders < MAX_SAVES)
+    {
+        found = g_HeaderCache->numHeaders;
+        g_HeaderCache->numHeaders++;
+    }
+    else if(index < MAX_SAVES)
+    {
+        found = index;
+    }
+    else
+    {
+        return 0;
+    }
+
+    header = &g_HeaderCache->headers[found];
+    strncpy(header->filename, filename, MAX_FILENAME);
+    header->filename[MAX_FILENAME - 1] = '\0';
+    header->key = *key;
+    memcpy(&header->bupHeader, bupHeader, sizeof(BUP_HEADER));
+    header->valid = true;
+
+    // keep the cache in directory order for the next listing
+    if((unsigned int)found != index && index < g_HeaderCache->numHeaders)
+    {
+        SATIATOR_HEADER temp = g_HeaderCache->headers[index];
+        g_HeaderCache->headers[index] = g_HeaderCache->headers[found];
+        g_HeaderCache->headers[found] = temp;
+    }
+
+    return 0;
 }
 
+// drops the cached header of a save that is being rewritten or deleted
+// FAT timestamps have a 2 second resolution so the key alone can't be trusted
+static void forgetCachedHeader(char* filename)
+{
+    for(unsigned int i = 0; i < SATIATOR_CACHED_DIRECTORIES; i++)
+    {
+        PSATIATOR_HEADER_CACHE cache = &g_HeaderCaches[i];
+
+        if(cache->lastUsed == 0 || strcmp(cache->directory, g_SatiatorDirectory) != 0)
+        {
+            continue;
+        }
+
+        for(unsigned int j = 0; j < cache->numHeaders; j++)
+        {
+            if(strcmp(cache->headers[j].filename, filename) == 0)
+            {
+                cache->headers[j].valid = false;
+            }
+        }
+    }
+}
+
+// replaces the save with the completely written temp file
+// FAT can't rename over an existing file so the old save is first renamed to
+// filename~, which is only deleted once the new save has its name. There is
+// always a complete copy of the save on the card. If power is lost midway
+// filename~ holds the old save and is restored by the next write of the save
+static int satiatorCommitFile(char* filename)
+{
+    char backup[MAX_FILENAME + 1] = {0};
+    char statbuf[280] = {0};
+    s_stat_t *st = (s_stat_t*)statbuf;
+    bool haveBackup = false;
+    unsigned int len = 0;
+    int result = 0;
+
+    len = strlen(filename);
+    if(len >= MAX_FILENAME)
+    {
+        return -1;
+    }
+
+    memcpy(backup, filename, len);
+    backup[len] = '~';
+    backup[len + 1] = '\0';
+
+    // left behind by an interrupted commit
+    if(s_stat(backup, st, sizeof(statbuf) - 1) >= 0)
+    {
+        if(s_stat(filename, st, sizeof(statbuf) - 1) >= 0)
+        {
+            // the save itself is complete, the backup is stale
+            s_unlink(backup);
+        }
+        else
+        {
+            s_rename(backup, filename);
+        }
+    }
+
+    result = s_rename(filename, backup);
+    if(result == 0)
+    {
+        haveBackup = true;
+    }
+    else if(result != -FR_NO_FILE)
+    {
+        // the temp file is kept, the old save is untouched
+        return -2;
+    }
+
+    result = s_rename(SATIATOR_TEMP_FILENAME, filename);
+    if(result != 0)
+    {
+        // put the old save back, the temp file is kept
+        if(haveBackup == true)
+        {
+            s_rename(backup, filename);
+        }
+        return -3;
+    }
+
+    if(haveBackup == true)
+    {
+        s_unlink(backup);
+    }
+
+    return 0;
+}
@@ -2,14 +2,33 @@
 
 #include "backend.h"
 
+// how hard the Satiator works to make sure a save reached the SD card
+// fast: chunks are written to a temp file without syncing, the temp file is
+//   synced once and only then renamed over the save. Losing power before the
+//   rename leaves the old save, after it the complete new one. Syncing every
+//   chunk as before only made the discarded temp file more complete, at a
+//   sync per 2KB, see "./sgcsim satiator-sync"
+// paranoid: same as fast but after the sync the temp file is read back and
+//   its CRC32 compared before the rename. FatFs may serve the last sector from
+//   its buffer, so this catches a bad transfer, not a card losing data
+#define SATIATOR_WRITE_FAST         0
+#define SATIATOR_WRITE_PARANOID     1
+#define SATIATOR_WRITE_POLICY       SATIATOR_WRITE_FAST
+
 bool satiatorIsBackupDeviceAvailable(int backupDevice);
 int satiatorListSaveFiles(int backupDevice, PSAVES fileSaves, unsigned int numSaves);
 int satiatorReadSaveFile(int backupDevice, char* filename, unsigned char* ouBuffer, unsigned int outBufSize);
 int satiatorWriteSaveFile(int backupDevice, char* filename, unsigned char* saveData, unsigned int saveDataLen);
 int satiatorDeleteSaveFile(int backupDevice, char* filename);
+int satiatorOpenStream(PBACKUP_STREAM stream);
+int satiatorReadChunk(PBACKUP_STREAM stream, unsigned char* buffer, unsigned int size);
+int satiatorWriteChunk(PBACKUP_STREAM stream, unsigned char* buffer, unsigned int size);
+int satiatorCloseStream(PBACKUP_STREAM stream);
+int satiatorChangeDirectory(int backupDevice, char* directory);
 
 // helper functions
 int satiatorEnter(void);
 int satiatorExit(void);
 int satiatorReadBUPHeader(char* filename, PBUP_HEADER bupHeader);
+int satiatorVerifyFile(char* filename, unsigned int size, unsigned int crc);
 void satiatorReboot(void);
@@ -49,15 +49,37 @@ static inline int buffer_xfer(void *buf, int len, int dir) {
 
     while (!(CDB_REG_HIRQ & HIRQ_DRDY));
 
+    // unrolled 8 words at a time, the loop overhead is as expensive
+    // as the data register access itself
     uint32_t *p = buf;
     uint16_t n = (len+3)/4;
     if (dir) {
+        for (; n >= 8; n -= 8, p += 8) {
+            CDB_REG_DATATRNS = p[0];
+            CDB_REG_DATATRNS = p[1];
+            CDB_REG_DATATRNS = p[2];
+            CDB_REG_DATATRNS = p[3];
+            CDB_REG_DATATRNS = p[4];
+            CDB_REG_DATATRNS = p[5];
+            CDB_REG_DATATRNS = p[6];
+            CDB_REG_DATATRNS = p[7];
+        }
         while (n--)
             CDB_REG_DATATRNS = *p++;
         // mandatory but mysterious
         CDB_REG_DATATRNS = 0;
         CDB_REG_DATATRNS = 0;
     } else {
+        for (; n >= 8; n -= 8, p += 8) {
+            p[0] = CDB_REG_DATATRNS;
+            p[1] = CDB_REG_DATATRNS;
+            p[2] = CDB_REG_DATATRNS;
+            p[3] = CDB_REG_DATATRNS;
+            p[4] = CDB_REG_DATATRNS;
+            p[5] = CDB_REG_DATATRNS;
+            p[6] = CDB_REG_DATATRNS;
+            p[7] = CDB_REG_DATATRNS;
+        }
         while (n--)
             *p++ = CDB_REG_DATATRNS;
     }
@@ -244,11 +266,42 @@ static int is_satiator_active(void) {
 }
 static enum satiator_mode cur_mode = s_cdrom;
 
+// The drive is stopped when API mode is entered. Wait for the CD block
+// to report a settled drive status before anything reads the disc again.
+// Returns 0 when the drive is ready, -1 on timeout or if there's no disc.
+static int wait_cdrom_ready(void) {
+    for (int tries = 0; tries < 1000; tries++) {
+        cmd_t cmd = {0x0000, 0, 0, 0};  // CD get status
+        exec_cmd(cmd, 0);
+        uint8_t status = CDB_REG_CR1 >> 8;
+
+        if (status != STATUS_REJECT && !(status & STATUS_WAIT)) {
+            switch (status & 0x0f) {
+                case STATUS_PAUSE:
+                case STATUS_STANDBY:
+                case STATUS_PLAY:
+                    return 0;
+                case STATUS_OPEN:
+                case STATUS_NODISC:
+                case STATUS_FATAL:
+                    return -1;
+                default:
+                    break;
+            }
+        }
+
+        for (volatile int i = 0; i < 10000; i++) { }
+    }
+
+    return -1;
+}
+
 int s_mode(enum satiator_mode mode) {
     /* Switch between emulating a CD drive and exposing the SD card API.
      * This function returns:
      *      0: success
-     *      -1: Satiator not detected
+     *      -1: Satiator not detected, or the drive didn't come back
+     *          after returning to CD-ROM mode
      */
     if (mode == cur_mode)
         return 0;
@@ -256,6 +309,8 @@ int s_mode(enum satiator_mode mode) {
     if (mode == s_cdrom) {
         cmd_t cmd = {0x9300, 1, 0, 0};
         exec_cmd(cmd, HIRQ_MPED);
+        cur_mode = mode;
+        return wait_cdrom_ready();
     } else {
         cmd_t cmd = {0xe000, 0x0000, 0x00c1, 0x05e7};
 
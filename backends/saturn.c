@@ -66,7 +66,7 @@ int saturnListSaveFiles(int backupDevice, PSAVES saves, unsigned int numSaves)
         }
 
         // fill out the SAVES structure
-        snprintf(saves[i].filename, MAX_FILENAME, "%s.BUP", filename);
+        snprintf(saves[i].filename, MAX_FILENAME, "%.*s.BUP", MAX_SAVE_FILENAME, filename);
         strncpy(saves[i].name, filename, MAX_SAVE_FILENAME);
         strncpy(saves[i].comment, (char*)comment, sizeof(comment));
         saves[i].language = language;
@@ -110,19 +110,29 @@ int saturnReadSaveFile(int backupDevice, char* filename, unsigned char* outBuffe
         return -3;
     }
 
+    // the BIOS doesn't store the rest of the header, don't copy whatever
+    // was left in the buffer along with the save
+    memset(outBuffer, 0, sizeof(BUP_HEADER));
+
     // query the save metadata
     unsigned int blockSize = 0;
-    result = jo_backup_get_file_info(backupDevice, filename, (char*)&temp->dir.comment, &temp->dir.language, &temp->dir.date, &temp->dir.datasize, &blockSize);
+    unsigned int date = 0;
+    unsigned int datasize = 0;
+    result = jo_backup_get_file_info(backupDevice, filename, (char*)&temp->dir.comment, &temp->dir.language, &date, &datasize, &blockSize);
 
     if(result == false)
     {
         sgc_core_error("Failed to save metadata  size!!");
+        jo_free(saveData);
         return -1;
     }
     memcpy(temp->magic, VMEM_MAGIC_STRING, VMEM_MAGIC_STRING_LEN);
     strncpy((char*)temp->dir.filename, filename, MAX_SAVE_FILENAME);
-    temp->date = temp->dir.date; // date is duplicated
-    temp->dir.blocksize = blockSize;
+
+    // multibyte fields are big-endian whatever the host
+    bup_set_date(outBuffer, date);
+    bup_set_datasize(outBuffer, datasize);
+    bup_set_blocksize(outBuffer, blockSize);
 
     // copy the save game data and free the jo engine buffer
     memcpy(outBuffer + sizeof(BUP_HEADER), saveData, outBufSize);
@@ -135,10 +145,11 @@ int saturnWriteSaveFile(int backupDevice, char* filename, unsigned char* saveDat
 {
     bool result = false;
     PBUP_HEADER temp = NULL;
+    BUP_VIEW view = {0};
     jo_backup saveMeta = {0};
 
     // BUP header is required
-    if(saveDataLen < sizeof(BUP_HEADER))
+    if(saveDataLen < sizeof(BUP_HEADER) || bup_view_init(&view, saveData, saveDataLen) != 0)
     {
         sgc_core_error("Invalid .BUP header");
         return -1;
@@ -160,7 +171,7 @@ int saturnWriteSaveFile(int backupDevice, char* filename, unsigned char* saveDat
     saveMeta.contents = saveData + sizeof(BUP_HEADER);
     saveMeta.content_size = saveDataLen - sizeof(BUP_HEADER);
     saveMeta.language_num = temp->dir.language;
-    saveMeta.save_timestamp = temp->dir.date;
+    saveMeta.save_timestamp = bup_view_date(&view);
 
     result = jo_backup_save(&saveMeta);
     if(result == false)
@@ -192,3 +203,46 @@ int saturnDeleteSaveFile(int backupDevice, char* filename)
 
     return 0;
 }
+
+// format a backup device
+int saturnFormatDevice(int backupDevice)
+{
+    bool result = false;
+
+    result = jo_backup_mount(backupDevice);
+    if(result == false)
+    {
+        char* deviceName = NULL;
+        getBackupDeviceName(backupDevice, &deviceName);
+
+        sgc_core_error("Failed to mount %s!!", deviceName);
+        return -2;
+    }
+
+    result = jo_backup_format_device(backupDevice);
+    if(result == false)
+    {
+        sgc_core_error("Failed to format device!!");
+        return -3;
+    }
+
+    return 0;
+}
+
+// the free block count changes when a save is written or deleted, or a
+// different disk is put in the floppy drive
+// BUGBUG: swapping in a disk with the same number of free blocks isn't caught
+int saturnGetGeneration(int backupDevice, unsigned int* generation)
+{
+    bool result = false;
+
+    result = jo_backup_mount(backupDevice);
+    if(result == false)
+    {
+        return -1;
+    }
+
+    *generation = jo_backup_get_free_block_count(backupDevice);
+
+    return 0;
+}
@@ -8,3 +8,4 @@ int saturnReadSaveFile(int backupDevice, char* filename, unsigned char* outBuffe
 int saturnWriteSaveFile(int backupDevice, char* filename, unsigned char* inBuffer, unsigned int inSize);
 int saturnDeleteSaveFile(int backupDevice, char* filename);
 int saturnFormatDevice(int backupDevice);
+int saturnGetGeneration(int backupDevice, unsigned int* generation);
@@ -1,5 +1,6 @@
 #include <jo/serial.h>
 #include "serial.h"
+#include "stats.h"
 
 #define SERIAL_SEND_BUSY        (-2)
 #define MAX_SEND_BUSY_ERRORS    (0x400)
@@ -7,6 +8,7 @@
 bool g_serial_initialized = false;
 
 static void init_serial(void);
+static int send_bytes(unsigned char* data, unsigned int size);
 
 // Check if the serial interface is available
 bool serialIsBackupDeviceAvailable(int backupDevice)
@@ -67,11 +69,7 @@ int serialReadSaveFile(int backupDevice, char* filename, unsigned char* outBuffe
 
 // Write the save
 int serialWriteSaveFile(int backupDevice, char* filename, unsigned char* saveData, unsigned int saveDataLen)
-{   
-    unsigned int bytesWritten = 0; 
-    int consecutiveErrors = 0;
-    int result = 0;
-
+{
     if(backupDevice != SerialBackup)
     {
         return -1;
@@ -90,38 +88,44 @@ int serialWriteSaveFile(int backupDevice, char* filename, unsigned char* saveDat
         sgc_core_error("serialWriteSaveFile: Save file size is invalid %d!!", saveDataLen);
         return -2;
     }
-    
-    while(bytesWritten < saveDataLen)
+
+    return send_bytes(saveData, saveDataLen);
+}
+
+// Open a save to stream over the link
+// the link is a raw byte stream so there is nothing to send up front
+int serialOpenStream(PBACKUP_STREAM stream)
+{
+    if(stream->mode != STREAM_MODE_WRITE)
     {
-        result = jo_serial_send_byte(saveData[bytesWritten]);
-        if(result != 0)
-        {
-            // retry if the serial link is busy
-            if(result == SERIAL_SEND_BUSY)
-            {
-                consecutiveErrors++;
+        return -1;
+    }
 
-                // check if we had too many errors in a row
-                if(consecutiveErrors >= MAX_SEND_BUSY_ERRORS)
-                {
-                    sgc_core_error("Serial busy %d %d", result, bytesWritten);
-                    return result;
-                }
+    init_serial();
 
-                continue;
-            }
-            else
-            {                
-                sgc_core_error("Serial error %d %d", result, bytesWritten);
-                return result;
-            }            
-        }
+    return 0;
+}
 
-        // reset error count after every successful send
-        consecutiveErrors = 0;
-        bytesWritten += 1;
+// Send the next chunk of the save
+int serialWriteChunk(PBACKUP_STREAM stream, unsigned char* buffer, unsigned int size)
+{
+    int result = 0;
+
+    UNUSED_ARG(stream);
+
+    result = send_bytes(buffer, size);
+    if(result != 0)
+    {
+        return result;
     }
 
+    return size;
+}
+
+int serialCloseStream(PBACKUP_STREAM stream)
+{
+    UNUSED_ARG(stream);
+
     return 0;
 }
 
@@ -158,3 +162,45 @@ static void init_serial(void)
 
     g_serial_initialized = true;
 }
+
+// send the bytes, retrying while the link is busy
+static int send_bytes(unsigned char* data, unsigned int size)
+{
+    unsigned int bytesWritten = 0;
+    int consecutiveErrors = 0;
+    int result = 0;
+
+    while(bytesWritten < size)
+    {
+        result = jo_serial_send_byte(data[bytesWritten]);
+        if(result != 0)
+        {
+            // retry if the serial link is busy
+            if(result == SERIAL_SEND_BUSY)
+            {
+                consecutiveErrors++;
+                statsAddRetries(1);
+
+                // check if we had too many errors in a row
+                if(consecutiveErrors >= MAX_SEND_BUSY_ERRORS)
+                {
+                    sgc_core_error("Serial busy %d %d", result, bytesWritten);
+                    return result;
+                }
+
+                continue;
+            }
+            else
+            {
+                sgc_core_error("Serial error %d %d", result, bytesWritten);
+                return result;
+            }
+        }
+
+        // reset error count after every successful send
+        consecutiveErrors = 0;
+        bytesWritten += 1;
+    }
+
+    return 0;
+}
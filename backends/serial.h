@@ -8,3 +8,6 @@ int serialListSaveFiles(int backupDevice, PSAVES fileSaves, unsigned int numSave
 int serialReadSaveFile(int backupDevice, char* filename, unsigned char* ouBuffer, unsigned int outBufSize);
 int serialWriteSaveFile(int backupDevice, char* filename, unsigned char* saveData, unsigned int saveDataLen);
 int serialDeleteSaveFile(int backupDevice, char* filename);
+int serialOpenStream(PBACKUP_STREAM stream);
+int serialWriteChunk(PBACKUP_STREAM stream, unsigned char* buffer, unsigned int size);
+int serialCloseStream(PBACKUP_STREAM stream);
@@ -0,0 +1,110 @@
+#include "session.h"
+#include "satiator.h"
+#include "mode.h"
+#include "cd.h"
+
+static int g_SessionOwner = SESSION_NONE;
+static unsigned int g_SessionSwitches = 0;
+static unsigned int g_SessionSwitchTicks = 0;
+
+static void leaveSession(void);
+
+// switches the CD block to the requested owner
+// does nothing if the owner already has the CD block
+// returns 0 on success
+int sessionAcquire(int owner)
+{
+    unsigned int startTicks = 0;
+    int result = 0;
+
+    if(owner == g_SessionOwner)
+    {
+        return 0;
+    }
+
+    startTicks = jo_get_ticks();
+
+    leaveSession();
+    g_SessionSwitches++;
+
+    switch(owner)
+    {
+        case SESSION_NONE:
+            break;
+
+        case SESSION_CDROM:
+            result = cdEnter();
+            break;
+
+        case SESSION_SATIATOR:
+            result = satiatorEnter();
+            break;
+
+        case SESSION_MODE:
+            result = modeEnter();
+            break;
+
+        default:
+            sgc_core_error("Invalid session owner %d!!", owner);
+            return -1;
+    }
+
+    g_SessionSwitchTicks += jo_get_ticks() - startTicks;
+
+    if(result != 0)
+    {
+        // the CD block is back in CD-ROM mode
+        return -2;
+    }
+
+    g_SessionOwner = owner;
+    return 0;
+}
+
+// returns the CD block to CD-ROM mode in the root directory
+void sessionRelease(void)
+{
+    sessionAcquire(SESSION_NONE);
+}
+
+// returns the device that currently owns the CD block
+int sessionGetOwner(void)
+{
+    return g_SessionOwner;
+}
+
+// number of times the CD block changed owners
+unsigned int sessionGetSwitchCount(void)
+{
+    return g_SessionSwitches;
+}
+
+// total time spent switching the CD block between owners
+unsigned int sessionGetSwitchTicks(void)
+{
+    return g_SessionSwitchTicks;
+}
+
+// undo whatever the current owner did to the CD block
+static void leaveSession(void)
+{
+    switch(g_SessionOwner)
+    {
+        case SESSION_CDROM:
+            cdExit();
+            break;
+
+        case SESSION_SATIATOR:
+            satiatorExit();
+            break;
+
+        case SESSION_MODE:
+            modeExit();
+            break;
+
+        default:
+            break;
+    }
+
+    g_SessionOwner = SESSION_NONE;
+}
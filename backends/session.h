@@ -0,0 +1,22 @@
+#pragma once
+
+#include "backend.h"
+
+//
+// CD block session - tracks which device currently owns the CD block
+//
+// The CD drive, Satiator and MODE all talk through the CD block and only one
+// of them can use it at a time. Switching is slow so the owner is kept until
+// another device actually needs the CD block.
+//
+
+#define SESSION_NONE        0 // CD-ROM mode in the root directory of the ISO
+#define SESSION_CDROM       1 // CD-ROM mode in SATSAVES, or the current subdirectory of SATSAVES
+#define SESSION_SATIATOR    2 // Satiator API mode in /SATSAVES
+#define SESSION_MODE        3 // MODE command interface is open
+
+int sessionAcquire(int owner);
+void sessionRelease(void);
+int sessionGetOwner(void);
+unsigned int sessionGetSwitchCount(void);
+unsigned int sessionGetSwitchTicks(void);
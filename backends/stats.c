@@ -0,0 +1,127 @@
+#include "stats.h"
+#include "session.h"
+
+// oldest records are overwritten once the ring is full
+static STATS_RECORD g_StatsRecords[STATS_MAX_RECORDS] = {0};
+static unsigned int g_StatsNext = 0;
+static unsigned int g_StatsCount = 0;
+static unsigned int g_StatsRetries = 0;
+
+// samples the counters at the start of an operation
+void statsBegin(PSTATS_MARK mark)
+{
+    mark->startTicks = jo_get_ticks();
+    mark->retries = g_StatsRetries;
+    mark->switches = sessionGetSwitchCount();
+    mark->switchTicks = sessionGetSwitchTicks();
+}
+
+// records the operation started by statsBegin()
+void statsEnd(PSTATS_MARK mark, unsigned char operation, int backupDevice, int result, unsigned int bytes)
+{
+    PSTATS_RECORD record = &g_StatsRecords[g_StatsNext];
+
+    record->operation = operation;
+    record->backupDevice = (unsigned char)backupDevice;
+    record->result = (short)result;
+    record->startTicks = mark->startTicks;
+    record->ticks = jo_get_ticks() - mark->startTicks;
+    record->bytes = bytes;
+    record->retries = (unsigned short)MIN(g_StatsRetries - mark->retries, 0xFFFF);
+    record->switches = (unsigned short)MIN(sessionGetSwitchCount() - mark->switches, 0xFFFF);
+    record->switchTicks = sessionGetSwitchTicks() - mark->switchTicks;
+
+    g_StatsNext = (g_StatsNext + 1) % STATS_MAX_RECORDS;
+    if(g_StatsCount < STATS_MAX_RECORDS)
+    {
+        g_StatsCount++;
+    }
+}
+
+// called by the link backends every time they retry a send
+void statsAddRetries(unsigned int retries)
+{
+    g_StatsRetries += retries;
+}
+
+// number of records in the ring
+unsigned int statsGetCount(void)
+{
+    return g_StatsCount;
+}
+
+// returns the record by age, 0 is the oldest
+PSTATS_RECORD statsGetRecord(unsigned int index)
+{
+    if(index >= g_StatsCount)
+    {
+        return NULL;
+    }
+
+    return &g_StatsRecords[(g_StatsNext + STATS_MAX_RECORDS - g_StatsCount + index) % STATS_MAX_RECORDS];
+}
+
+// returns a short description of the operation
+const char* statsOperationString(unsigned char operation)
+{
+    switch(operation)
+    {
+        case STATS_OP_LIST:
+            return "List";
+        case STATS_OP_READ:
+            return "Read";
+        case STATS_OP_WRITE:
+            return "Write";
+        case STATS_OP_DELETE:
+            return "Delete";
+        case STATS_OP_FORMAT:
+            return "Format";
+        case STATS_OP_STREAM_READ:
+            return "SRead";
+        case STATS_OP_STREAM_WRITE:
+            return "SWrite";
+        default:
+            return "Unknown";
+    }
+}
+
+// writes the records as CSV text, oldest first
+// returns the number of bytes written
+unsigned int statsExport(char* buffer, unsigned int bufferSize)
+{
+    unsigned int length = 0;
+    int result = 0;
+
+    if(buffer == NULL || bufferSize == 0)
+    {
+        return 0;
+    }
+
+    result = snprintf(buffer, bufferSize, "op,device,result,start_ms,ms,bytes,retries,switches,switch_ms\n");
+    if(result < 0 || (unsigned int)result >= bufferSize)
+    {
+        return 0;
+    }
+    length = result;
+
+    for(unsigned int i = 0; i < g_StatsCount; i++)
+    {
+        PSTATS_RECORD record = statsGetRecord(i);
+        char* deviceName = NULL;
+
+        getBackupDeviceName(record->backupDevice, &deviceName);
+
+        result = snprintf(buffer + length, bufferSize - length, "%s,%s,%d,%u,%u,%u,%u,%u,%u\n",
+            statsOperationString(record->operation), deviceName ? deviceName : "",
+            record->result, record->startTicks, record->ticks, record->bytes,
+            record->retries, record->switches, record->switchTicks);
+        if(result < 0 || (unsigned int)result >= bufferSize - length)
+        {
+            // out of room, keep the complete lines
+            break;
+        }
+        length += result;
+    }
+
+    return length;
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "backend.h"
+
+//
+// Transfer statistics - times every backend operation into a ring buffer
+//
+
+#define STATS_MAX_RECORDS       64
+#define STATS_EXPORT_SIZE       (STATS_MAX_RECORDS * 112) // CSV text of every record
+
+// operations that are timed
+#define STATS_OP_LIST           0
+#define STATS_OP_READ           1
+#define STATS_OP_WRITE          2
+#define STATS_OP_DELETE         3
+#define STATS_OP_FORMAT         4
+#define STATS_OP_STREAM_READ    5
+#define STATS_OP_STREAM_WRITE   6
+
+// a completed operation
+typedef struct _STATS_RECORD
+{
+    unsigned char operation; // STATS_OP_XXX
+    unsigned char backupDevice;
+    short result; // 0 on success, the backend's error code otherwise
+    unsigned int startTicks;
+    unsigned int ticks; // time the operation took
+    unsigned int bytes; // bytes moved, or saves listed for STATS_OP_LIST
+    unsigned short retries; // serial busy and modem send retries
+    unsigned short switches; // CD block mode switches
+    unsigned int switchTicks; // time spent switching the CD block, included in ticks
+} STATS_RECORD, *PSTATS_RECORD;
+
+void statsBegin(PSTATS_MARK mark);
+void statsEnd(PSTATS_MARK mark, unsigned char operation, int backupDevice, int result, unsigned int bytes);
+void statsAddRetries(unsigned int retries);
+unsigned int statsGetCount(void);
+PSTATS_RECORD statsGetRecord(unsigned int index);
+const char* statsOperationString(unsigned char operation);
+unsigned int statsExport(char* buffer, unsigned int bufferSize);
@@ -0,0 +1,334 @@
+// Batch copy - copies a list of saves to a target device
+#include "STDLIB.H"
+#include "batch.h"
+
+static int compareBatchItems(const void* a, const void* b);
+static bool needsStaging(PBATCH_ITEM item);
+static void stageItems(PBATCH_SESSION session);
+static int startItem(PBATCH_SESSION session, PBATCH_ITEM item);
+static void finishItem(PBATCH_SESSION session, PBATCH_ITEM item, unsigned char status);
+
+// prepares an empty batch
+// staging is used to group reads from devices sharing the CD block
+// returns 0 on success
+int batchStart(PBATCH_SESSION session, unsigned char* staging, unsigned int stagingSize)
+{
+    if(session == NULL || staging == NULL || stagingSize < sizeof(BUP_HEADER))
+    {
+        sgc_core_error("Invalid parameters to batchStart!!");
+        return -1;
+    }
+
+    memset(session, 0, sizeof(BATCH_SESSION));
+    session->staging = staging;
+    session->stagingSize = stagingSize;
+
+    session->items = jo_malloc(MAX_SAVES * sizeof(BATCH_ITEM));
+    if(session->items == NULL)
+    {
+        sgc_core_error("Failed to allocate batch queue!!");
+        return -2;
+    }
+    memset(session->items, 0, MAX_SAVES * sizeof(BATCH_ITEM));
+
+    return 0;
+}
+
+// queues the save to be copied to the target device
+// corrupt saves are queued as skipped so they show up in the report
+// returns 0 on success
+int batchAdd(PBATCH_SESSION session, int sourceDevice, PSAVES save, int targetDevice)
+{
+    PBATCH_ITEM item = NULL;
+
+    if(session == NULL || session->items == NULL || save == NULL || session->scheduled == true)
+    {
+        return -1;
+    }
+
+    if(session->numItems >= MAX_SAVES)
+    {
+        return -2;
+    }
+
+    item = &session->items[session->numItems];
+    item->sourceDevice = sourceDevice;
+    item->targetDevice = targetDevice;
+    item->size = save->datasize + sizeof(BUP_HEADER);
+    item->order = session->numItems;
+
+    strncpy(item->name, save->name, MAX_SAVE_FILENAME - 1);
+
+    // BUGBUG: internal devices are read by save name, everything else by
+    // the .BUP filename. See displaySave_draw()
+    if(hasBackupDeviceCapability(sourceDevice, BACKUP_CAP_SAVE_NAME))
+    {
+        strncpy(item->sourceFilename, save->name, MAX_FILENAME - 1);
+    }
+    else
+    {
+        strncpy(item->sourceFilename, save->filename, MAX_FILENAME - 1);
+    }
+
+    if(hasBackupDeviceCapability(targetDevice, BACKUP_CAP_SAVE_NAME))
+    {
+        strncpy(item->targetFilename, save->name, MAX_FILENAME - 1);
+    }
+    else
+    {
+        strncpy(item->targetFilename, save->filename, MAX_FILENAME - 1);
+    }
+
+    if(save->status == SAVE_STATUS_CORRUPT)
+    {
+        item->status = BATCH_SKIPPED;
+    }
+
+    session->numItems++;
+    return 0;
+}
+
+// advances the batch by up to a frame's worth of copying
+// returns 1 if there is more to copy, 0 when done, negative on error
+int batchStep(PBATCH_SESSION session)
+{
+    PBATCH_ITEM item = NULL;
+    int result = 0;
+
+    if(session == NULL || session->items == NULL)
+    {
+        return -1;
+    }
+
+    if(session->done == true)
+    {
+        return 0;
+    }
+
+    // group the queue by device so each device is switched to as few times as possible
+    if(session->scheduled == false)
+    {
+        qsort(session->items, session->numItems, sizeof(BATCH_ITEM), compareBatchItems);
+        session->scheduled = true;
+        session->startTicks = jo_get_ticks();
+    }
+
+    if(session->copying == true)
+    {
+        item = &session->items[session->current];
+
+        result = copyStep(&session->copy);
+        if(result > 0)
+        {
+            return 1;
+        }
+
+        result = copyEnd(&session->copy);
+        session->copying = false;
+
+        item->ticks += session->copy.elapsedTicks;
+        finishItem(session, item, (result == 0) ? BATCH_COPIED : BATCH_FAILED);
+        session->current++;
+        return 1;
+    }
+
+    if(session->current >= session->numItems)
+    {
+        session->elapsedTicks = jo_get_ticks() - session->startTicks;
+        session->done = true;
+        return 0;
+    }
+
+    item = &session->items[session->current];
+
+    if(item->status == BATCH_SKIPPED)
+    {
+        session->numSkipped++;
+        session->current++;
+        return 1;
+    }
+
+    // failed to read while staging
+    if(item->status == BATCH_FAILED)
+    {
+        finishItem(session, item, BATCH_FAILED);
+        session->current++;
+        return 1;
+    }
+
+    result = startItem(session, item);
+    if(result != 0)
+    {
+        finishItem(session, item, BATCH_FAILED);
+        session->current++;
+        return 1;
+    }
+
+    session->copying = true;
+    return 1;
+}
+
+// frees the queue and aborts any copy in progress
+void batchEnd(PBATCH_SESSION session)
+{
+    if(session == NULL)
+    {
+        return;
+    }
+
+    if(session->copying == true)
+    {
+        copyEnd(&session->copy);
+        session->copying = false;
+    }
+
+    if(session->items)
+    {
+        jo_free(session->items);
+        session->items = NULL;
+    }
+
+    session->numItems = 0;
+}
+
+// bytes per second
+unsigned int batchThroughput(unsigned int bytes, unsigned int ticks)
+{
+    if(ticks == 0)
+    {
+        return 0;
+    }
+
+    return (unsigned int)(((unsigned long long)bytes * 1000) / ticks);
+}
+
+// returns a short description of the batch result
+const char* batchStatusString(unsigned char status)
+{
+    switch(status)
+    {
+        case BATCH_PENDING:
+            return "Pending";
+        case BATCH_COPIED:
+            return "Copied";
+        case BATCH_FAILED:
+            return "Failed";
+        case BATCH_SKIPPED:
+            return "Corrupt";
+        default:
+            return "Unknown";
+    }
+}
+
+// order by source device, then target device, then the user's selection
+static int compareBatchItems(const void* a, const void* b)
+{
+    PBATCH_ITEM aItem = (PBATCH_ITEM)a;
+    PBATCH_ITEM bItem = (PBATCH_ITEM)b;
+
+    if(aItem->sourceDevice != bItem->sourceDevice)
+    {
+        return aItem->sourceDevice - bItem->sourceDevice;
+    }
+
+    if(aItem->targetDevice != bItem->targetDevice)
+    {
+        return aItem->targetDevice - bItem->targetDevice;
+    }
+
+    return (int)aItem->order - (int)bItem->order;
+}
+
+// devices sharing the CD block can't both have a file open
+static bool needsStaging(PBATCH_ITEM item)
+{
+    return item->sourceDevice != item->targetDevice &&
+        hasBackupDeviceCapability(item->sourceDevice, BACKUP_CAP_CD_BLOCK) &&
+        hasBackupDeviceCapability(item->targetDevice, BACKUP_CAP_CD_BLOCK);
+}
+
+// reads as many of the upcoming saves as fit in the staging buffer
+// so the CD block switches to the source once for the whole group
+static void stageItems(PBATCH_SESSION session)
+{
+    PBATCH_ITEM first = &session->items[session->current];
+    unsigned int used = 0;
+
+    for(unsigned int i = session->current; i < session->numItems; i++)
+    {
+        PBATCH_ITEM item = &session->items[i];
+        unsigned int startTicks = 0;
+        int result = 0;
+
+        if(item->sourceDevice != first->sourceDevice || item->targetDevice != first->targetDevice)
+        {
+            break;
+        }
+
+        if(item->status != BATCH_PENDING)
+        {
+            continue;
+        }
+
+        if(used + item->size > session->stagingSize)
+        {
+            break;
+        }
+
+        startTicks = jo_get_ticks();
+        result = readSaveFile(item->sourceDevice, item->sourceFilename, session->staging + used, item->size);
+        item->ticks += jo_get_ticks() - startTicks;
+
+        if(result != 0)
+        {
+            item->status = BATCH_FAILED;
+            continue;
+        }
+
+        item->staged = session->staging + used;
+
+        // keep the next save word aligned
+        used += (item->size + 3) & ~3;
+    }
+}
+
+// opens the copy for the item
+static int startItem(PBATCH_SESSION session, PBATCH_ITEM item)
+{
+    if(needsStaging(item))
+    {
+        if(item->staged == NULL)
+        {
+            stageItems(session);
+        }
+
+        // failed to read the save while staging
+        if(item->staged == NULL)
+        {
+            return -1;
+        }
+
+        return copyStartFromMemory(&session->copy, item->staged, item->size, item->targetDevice, item->targetFilename);
+    }
+
+    // nothing is staged while other items are copied, lend the buffer to the copy
+    return copyStart(&session->copy, item->sourceDevice, item->sourceFilename, item->targetDevice, item->targetFilename, item->size,
+        session->staging, session->stagingSize);
+}
+
+// records the item result and updates the report totals
+static void finishItem(PBATCH_SESSION session, PBATCH_ITEM item, unsigned char status)
+{
+    item->status = status;
+    item->staged = NULL;
+
+    if(status == BATCH_COPIED)
+    {
+        session->numCopied++;
+        session->bytesCopied += item->size;
+    }
+    else
+    {
+        session->numFailed++;
+    }
+}
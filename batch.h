@@ -0,0 +1,64 @@
+#pragma once
+
+#include "backends/backend.h"
+#include "copy.h"
+
+//
+// Batch copy - copies a list of saves to a target device
+//
+
+// result of copying a save in the batch
+#define BATCH_PENDING           0 // not copied yet
+#define BATCH_COPIED            1 // copied successfully
+#define BATCH_FAILED            2 // failed to read or write the save
+#define BATCH_SKIPPED           3 // corrupt save, not copied
+
+// a save queued for copying
+typedef struct _BATCH_ITEM
+{
+    int sourceDevice;
+    int targetDevice;
+    char name[MAX_SAVE_FILENAME]; // save name for the report
+    char sourceFilename[MAX_FILENAME]; // name the source device addresses the save by
+    char targetFilename[MAX_FILENAME]; // name the target device addresses the save by
+    unsigned int size; // size of the save including the .BUP header
+    unsigned int order; // position in the user's selection, keeps the schedule stable
+
+    unsigned char* staged; // save data read ahead into the staging buffer
+    unsigned int ticks; // time spent reading and writing the save
+    unsigned char status; // BATCH_XXX
+} BATCH_ITEM, *PBATCH_ITEM;
+
+// state of a batch copy. Advanced by batchStep() every frame
+typedef struct _BATCH_SESSION
+{
+    PBATCH_ITEM items;
+    unsigned int numItems;
+    unsigned int current; // item being copied
+    bool scheduled; // items have been ordered by device
+
+    COPY_ENGINE copy;
+    bool copying;
+
+    // saves between devices sharing the CD block are read in a group
+    // before being written, instead of switching the CD block per save
+    unsigned char* staging;
+    unsigned int stagingSize;
+
+    // report totals
+    unsigned int numCopied;
+    unsigned int numFailed;
+    unsigned int numSkipped;
+    unsigned int bytesCopied;
+    unsigned int startTicks;
+    unsigned int elapsedTicks;
+
+    bool done;
+} BATCH_SESSION, *PBATCH_SESSION;
+
+int batchStart(PBATCH_SESSION session, unsigned char* staging, unsigned int stagingSize);
+int batchAdd(PBATCH_SESSION session, int sourceDevice, PSAVES save, int targetDevice);
+int batchStep(PBATCH_SESSION session);
+void batchEnd(PBATCH_SESSION session);
+unsigned int batchThroughput(unsigned int bytes, unsigned int ticks);
+const char* batchStatusString(unsigned char status);
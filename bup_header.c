@@ -1,5 +1,135 @@
 #include "bup_header.h"
 
+int memcmp(const void *s1, const void *s2, unsigned int n);
+
+static unsigned int bup_read_be32(const unsigned char* p);
+static unsigned short bup_read_be16(const unsigned char* p);
+static void bup_write_be32(unsigned char* p, unsigned int value);
+static void bup_write_be16(unsigned char* p, unsigned short value);
+static unsigned int bup_field_length(const unsigned char* p, unsigned int maxLength);
+
+/* Days elapsed before each month for a leap year and for a common year */
+static const unsigned short bup_month_days[2][13] =
+{
+    {0, 31, 60, 91, 121, 152, 182, 213, 244, 274, 305, 335, 366},
+    {0, 31, 59, 90, 120, 151, 181, 212, 243, 273, 304, 334, 365},
+};
+
+/*
+ *  Validates the BUP magic and points the view at the header in buffer.
+ *  buffer must stay valid for as long as the view is used.
+ *  Returns 0 on success.
+ */
+int bup_view_init(PBUP_VIEW view, const void* buffer, unsigned int bufferSize)
+{
+    if(!view || !buffer)
+    {
+        return -1;
+    }
+
+    if(bufferSize < BUP_HEADER_SIZE)
+    {
+        return -2;
+    }
+
+    if(memcmp((const unsigned char*)buffer + BUP_OFFSET_MAGIC, VMEM_MAGIC_STRING, VMEM_MAGIC_STRING_LEN) != 0)
+    {
+        return -3;
+    }
+
+    view->header = (const unsigned char*)buffer;
+    return 0;
+}
+
+/* Save name, not necessarily NULL terminated. length is set to the number of valid characters. */
+const char* bup_view_name(PBUP_VIEW view, unsigned int* length)
+{
+    *length = bup_field_length(view->header + BUP_OFFSET_NAME, JO_BACKUP_MAX_FILENAME_LENGTH - 1);
+    return (const char*)(view->header + BUP_OFFSET_NAME);
+}
+
+/* Save comment, not necessarily NULL terminated. length is set to the number of valid characters. */
+const char* bup_view_comment(PBUP_VIEW view, unsigned int* length)
+{
+    *length = bup_field_length(view->header + BUP_OFFSET_COMMENT, JO_BACKUP_MAX_COMMENT_LENGTH);
+    return (const char*)(view->header + BUP_OFFSET_COMMENT);
+}
+
+unsigned char bup_view_language(PBUP_VIEW view)
+{
+    return view->header[BUP_OFFSET_LANGUAGE];
+}
+
+unsigned int bup_view_date(PBUP_VIEW view)
+{
+    return bup_read_be32(view->header + BUP_OFFSET_DATE);
+}
+
+unsigned int bup_view_datasize(PBUP_VIEW view)
+{
+    return bup_read_be32(view->header + BUP_OFFSET_DATASIZE);
+}
+
+unsigned short bup_view_blocksize(PBUP_VIEW view)
+{
+    return bup_read_be16(view->header + BUP_OFFSET_BLOCKSIZE);
+}
+
+/* Byte-wise reads so the fields can be accessed at any alignment on any host */
+static unsigned int bup_read_be32(const unsigned char* p)
+{
+    return ((unsigned int)p[0] << 24) | ((unsigned int)p[1] << 16) | ((unsigned int)p[2] << 8) | p[3];
+}
+
+static unsigned short bup_read_be16(const unsigned char* p)
+{
+    return (unsigned short)((p[0] << 8) | p[1]);
+}
+
+static void bup_write_be32(unsigned char* p, unsigned int value)
+{
+    p[0] = (unsigned char)(value >> 24);
+    p[1] = (unsigned char)(value >> 16);
+    p[2] = (unsigned char)(value >> 8);
+    p[3] = (unsigned char)value;
+}
+
+static void bup_write_be16(unsigned char* p, unsigned short value)
+{
+    p[0] = (unsigned char)(value >> 8);
+    p[1] = (unsigned char)value;
+}
+
+/* Sets the save date. The date is duplicated in the header */
+void bup_set_date(void* header, unsigned int date)
+{
+    bup_write_be32((unsigned char*)header + BUP_OFFSET_DATE, date);
+    bup_write_be32((unsigned char*)header + BUP_OFFSET_HEADER_DATE, date);
+}
+
+void bup_set_datasize(void* header, unsigned int datasize)
+{
+    bup_write_be32((unsigned char*)header + BUP_OFFSET_DATASIZE, datasize);
+}
+
+void bup_set_blocksize(void* header, unsigned short blocksize)
+{
+    bup_write_be16((unsigned char*)header + BUP_OFFSET_BLOCKSIZE, blocksize);
+}
+
+/* Length of a string field that is only NULL terminated if shorter than maxLength */
+static unsigned int bup_field_length(const unsigned char* p, unsigned int maxLength)
+{
+    unsigned int i = 0;
+
+    while(i < maxLength && p[i] != '\0')
+    {
+        i++;
+    }
+
+    return i;
+}
+
 /*
  *  Format          void BUP_GetDate(unsigned int date, jo_backup_date *date)
  *  Input           pdate : data and time data of directory information
@@ -32,43 +162,34 @@ void bup_getdate(unsigned int date, jo_backup_date *tb)
     }
 
     /* To process leap year, simply consider a pack of 4 years whose first one
-     * is a multiple of 4, and loop up to 48 months until getting remaining
-     * days count fitting into one month.
+     * is a multiple of 4. The year within the pack is computed directly, then
+     * the month is looked up from the days elapsed before each month.
      *
-     * It's a bit kind of naive (not to say dumb) implementation, but it works,
-     * and as it's not the kind of routine that require heavy optimization
-     * there's no plan to make this algorithm smarter.
+     * day_of_year / 32 is never past the correct month and at most one month
+     * short of it, so a single comparison finds the month.
      */
     unsigned long year_base   = div / ((365*4) + 1);
     year_base = year_base * 4;
     unsigned long days_remain = div % ((365*4) + 1);
-    const char days_count[12] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    const unsigned short* month_days = bup_month_days[0];
 
-    unsigned char month = 0;
-    int i;
-    for(i=0; i<(4*12); i++)
+    if(days_remain >= 366)
     {
-        unsigned char days_per_month = days_count[i % 12];
-        if(i == 1)
-        {
-            days_per_month++;
-        }
+        unsigned long years = (days_remain - 1) / 365;
 
-        if(days_remain < days_per_month)
-        {
-            break;
-        }
+        days_remain -= (years * 365) + 1;
+        year_base += years;
+        month_days = bup_month_days[1];
+    }
 
-        days_remain -= days_per_month;
+    unsigned char month = (unsigned char)(days_remain >> 5);
+    if(days_remain >= month_days[month + 1])
+    {
         month++;
-
-        if((i % 12) == 11)
-        {
-            month = 0;
-            year_base++;
-        }
     }
 
+    days_remain -= month_days[month];
+
     tb->month = month + 1;
     tb->day   = days_remain + 1;
     tb->year  = year_base;
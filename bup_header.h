@@ -135,6 +135,49 @@ typedef struct _vmem_bup_header_t
 #pragma pack(pop)
 #endif
 
+/*
+ * Byte offsets of the fields within the 64 byte BUP header.
+ * Multibyte values are stored as big-endian.
+ */
+#define BUP_OFFSET_MAGIC        0
+#define BUP_OFFSET_SAVE_ID      4
+#define BUP_OFFSET_NAME         16
+#define BUP_OFFSET_COMMENT      (BUP_OFFSET_NAME + JO_BACKUP_MAX_FILENAME_LENGTH)
+#define BUP_OFFSET_LANGUAGE     (BUP_OFFSET_COMMENT + JO_BACKUP_MAX_COMMENT_LENGTH + 1)
+#define BUP_OFFSET_DATE         (BUP_OFFSET_LANGUAGE + 1)
+#define BUP_OFFSET_DATASIZE     (BUP_OFFSET_DATE + 4)
+#define BUP_OFFSET_BLOCKSIZE    (BUP_OFFSET_DATASIZE + 4)
+#define BUP_OFFSET_HEADER_DATE  52
+#define BUP_OFFSET_UNUSED2      56
+
+/**
+ * Read-only view of a BUP header that lives in some other buffer, e.g. a
+ * sector buffer. The magic is validated once by bup_view_init() and the
+ * fields are then read in place without copying the header.
+ **/
+typedef struct _bup_view_t
+{
+    const unsigned char* header;
+} BUP_VIEW, *PBUP_VIEW;
+
+//
+// Functions for accessing a BUP header in place
+//
+int bup_view_init(PBUP_VIEW view, const void* buffer, unsigned int bufferSize);
+const char* bup_view_name(PBUP_VIEW view, unsigned int* length);
+const char* bup_view_comment(PBUP_VIEW view, unsigned int* length);
+unsigned char bup_view_language(PBUP_VIEW view);
+unsigned int bup_view_date(PBUP_VIEW view);
+unsigned int bup_view_datasize(PBUP_VIEW view);
+unsigned short bup_view_blocksize(PBUP_VIEW view);
+
+//
+// Functions for filling in a BUP header in place
+//
+void bup_set_date(void* header, unsigned int date);
+void bup_set_datasize(void* header, unsigned int datasize);
+void bup_set_blocksize(void* header, unsigned short blocksize);
+
 //
 // Functions for converting dates
 //
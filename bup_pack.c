@@ -0,0 +1,262 @@
+#include "bup_pack.h"
+#include "util.h"
+#include "backends/actionreplay.h" // RLE01 compression
+
+static unsigned int bup_pack_read_be32(const unsigned char* p);
+static unsigned short bup_pack_read_be16(const unsigned char* p);
+static void bup_pack_write_be32(unsigned char* p, unsigned int value);
+static void bup_pack_write_be16(unsigned char* p, unsigned short value);
+
+/*
+ *  Returns non-zero if bupHeader is the header of a packed .BUP
+ */
+int bup_is_packed(const void* bupHeader)
+{
+    const unsigned char* header = (const unsigned char*)bupHeader;
+
+    if(memcmp(header + BUP_OFFSET_MAGIC, VMEM_MAGIC_STRING, VMEM_MAGIC_STRING_LEN) != 0)
+    {
+        return 0;
+    }
+
+    return memcmp(header + BUP_PACK_OFFSET_MAGIC, BUP_PACK_MAGIC, BUP_PACK_MAGIC_LEN) == 0;
+}
+
+/*
+ *  Returns the total size of a packed .BUP including the header
+ */
+unsigned int bup_packed_size(const void* bupHeader)
+{
+    return BUP_HEADER_SIZE + bup_pack_read_be32((const unsigned char*)bupHeader + BUP_PACK_OFFSET_SIZE);
+}
+
+/*
+ *  Packs the plain .BUP in bup into out. out must not overlap bup.
+ *  Each chunk is RLE01 compressed if that makes it smaller, otherwise it is stored.
+ *  Returns 0 on success, 1 if packing would not make the save smaller, negative on error.
+ */
+int bup_pack(const unsigned char* bup, unsigned int bupSize, unsigned char* out, unsigned int outSize, unsigned int* packedSize)
+{
+    unsigned int dataSize = 0;
+    unsigned int pos = 0;
+    int result = 0;
+
+    if(!bup || !out || !packedSize || bupSize < BUP_HEADER_SIZE || outSize < BUP_HEADER_SIZE)
+    {
+        return -1;
+    }
+
+    if(memcmp(bup + BUP_OFFSET_MAGIC, VMEM_MAGIC_STRING, VMEM_MAGIC_STRING_LEN) != 0 || bup_is_packed(bup))
+    {
+        return -2;
+    }
+
+    dataSize = bupSize - BUP_HEADER_SIZE;
+    memcpy(out, bup, BUP_HEADER_SIZE);
+    pos = BUP_HEADER_SIZE;
+
+    for(unsigned int offset = 0; offset < dataSize; offset += BUP_PACK_CHUNK_SIZE)
+    {
+        unsigned char* raw = (unsigned char*)bup + BUP_HEADER_SIZE + offset;
+        unsigned int rawSize = MIN(dataSize - offset, BUP_PACK_CHUNK_SIZE);
+        unsigned int chunkSize = rawSize;
+        unsigned int compressedSize = 0;
+        unsigned char rleKey = 0;
+
+        // no point continuing if the packed save is already bigger
+        if(pos + BUP_PACK_CHUNK_HEADER_SIZE + rawSize >= MIN(outSize, bupSize))
+        {
+            return 1;
+        }
+
+        result = calcRLEKey(raw, rawSize, &rleKey);
+        if(result == 0)
+        {
+            result = compressRLE01(rleKey, raw, rawSize, NULL, &compressedSize);
+        }
+
+        if(result == 0 && compressedSize + 1 < rawSize)
+        {
+            chunkSize = compressedSize + 1;
+            out[pos + BUP_PACK_CHUNK_HEADER_SIZE] = rleKey;
+            compressRLE01(rleKey, raw, rawSize, out + pos + BUP_PACK_CHUNK_HEADER_SIZE + 1, &compressedSize);
+        }
+        else
+        {
+            memcpy(out + pos + BUP_PACK_CHUNK_HEADER_SIZE, raw, rawSize);
+        }
+
+        bup_pack_write_be16(out + pos, (unsigned short)rawSize);
+        bup_pack_write_be16(out + pos + 2, (unsigned short)chunkSize);
+        bup_pack_write_be32(out + pos + 4, calculateCRC32(raw, rawSize, 0));
+
+        pos += BUP_PACK_CHUNK_HEADER_SIZE + chunkSize;
+    }
+
+    if(pos >= bupSize)
+    {
+        return 1;
+    }
+
+    memcpy(out + BUP_PACK_OFFSET_MAGIC, BUP_PACK_MAGIC, BUP_PACK_MAGIC_LEN);
+    bup_pack_write_be32(out + BUP_PACK_OFFSET_SIZE, pos - BUP_HEADER_SIZE);
+    *packedSize = pos;
+
+    return 0;
+}
+
+/*
+ *  Unpacks the packed .BUP in packed into a plain .BUP in out. out must not overlap packed.
+ *  The CRC of every chunk is checked. goodChunks is set to the number of chunks
+ *  unpacked before the first bad one, to report where the save is damaged.
+ *  packed must have 2 readable bytes past packedSize, RLE01 may look ahead.
+ *  Returns 0 on success.
+ */
+int bup_unpack(const unsigned char* packed, unsigned int packedSize, unsigned char* out, unsigned int outSize, unsigned int* goodChunks)
+{
+    unsigned int dataSize = 0;
+    unsigned int pos = 0;
+    unsigned int offset = 0;
+    unsigned int chunkSize = 0;
+    int result = 0;
+
+    if(!packed || !out || !goodChunks || packedSize < BUP_HEADER_SIZE)
+    {
+        return -1;
+    }
+
+    *goodChunks = 0;
+
+    if(!bup_is_packed(packed))
+    {
+        return -2;
+    }
+
+    if(bup_packed_size(packed) > packedSize)
+    {
+        return -3;
+    }
+    packedSize = bup_packed_size(packed);
+
+    dataSize = bup_pack_read_be32(packed + BUP_OFFSET_DATASIZE);
+    if(dataSize + BUP_HEADER_SIZE > outSize)
+    {
+        return -4;
+    }
+
+    // the unpacked header is the original header without the pack marker
+    memcpy(out, packed, BUP_HEADER_SIZE);
+    memset(out + BUP_OFFSET_UNUSED2, 0, BUP_PACK_MAGIC_LEN * 2);
+
+    pos = BUP_HEADER_SIZE;
+    while(offset < dataSize)
+    {
+        if(pos + BUP_PACK_CHUNK_HEADER_SIZE > packedSize)
+        {
+            return -5;
+        }
+
+        chunkSize = bup_chunk_packed_size(packed + pos);
+        if(pos + BUP_PACK_CHUNK_HEADER_SIZE + chunkSize > packedSize)
+        {
+            return -6;
+        }
+
+        result = bup_unpack_chunk(packed + pos, packed + pos + BUP_PACK_CHUNK_HEADER_SIZE, out + BUP_HEADER_SIZE + offset, dataSize - offset);
+        if(result < 0)
+        {
+            return result;
+        }
+
+        pos += BUP_PACK_CHUNK_HEADER_SIZE + chunkSize;
+        offset += result;
+        (*goodChunks)++;
+    }
+
+    return 0;
+}
+
+/*
+ *  Returns the size of the packed data following a chunk header
+ */
+unsigned int bup_chunk_packed_size(const unsigned char* chunkHeader)
+{
+    return bup_pack_read_be16(chunkHeader + 2);
+}
+
+/*
+ *  Unpacks a single chunk. data is the bup_chunk_packed_size() bytes following
+ *  chunkHeader, it must have 2 readable bytes past its end as RLE01 may look ahead.
+ *  At most outSize bytes are written to out and the CRC of the chunk is checked.
+ *  Returns the unpacked size of the chunk, negative on error.
+ */
+int bup_unpack_chunk(const unsigned char* chunkHeader, const unsigned char* data, unsigned char* out, unsigned int outSize)
+{
+    unsigned int rawSize = 0;
+    unsigned int chunkSize = 0;
+    unsigned int bytesNeeded = 0;
+    int result = 0;
+
+    if(!chunkHeader || !data || !out)
+    {
+        return -1;
+    }
+
+    rawSize = bup_pack_read_be16(chunkHeader);
+    chunkSize = bup_pack_read_be16(chunkHeader + 2);
+
+    if(rawSize == 0 || rawSize > outSize || rawSize > BUP_PACK_CHUNK_SIZE || chunkSize == 0 || chunkSize > rawSize)
+    {
+        return -6;
+    }
+
+    if(chunkSize == rawSize)
+    {
+        memcpy(out, data, rawSize);
+    }
+    else
+    {
+        // size the chunk first so a bad chunk can't overflow out
+        unsigned char rleKey = data[0];
+        unsigned char* src = (unsigned char*)data + 1;
+
+        result = decompressRLE01(rleKey, src, chunkSize - 1, NULL, &bytesNeeded);
+        if(result != 0 || bytesNeeded != rawSize)
+        {
+            return -7;
+        }
+
+        decompressRLE01(rleKey, src, chunkSize - 1, out, &bytesNeeded);
+    }
+
+    if(calculateCRC32(out, rawSize, 0) != bup_pack_read_be32(chunkHeader + 4))
+    {
+        return -8;
+    }
+
+    return rawSize;
+}
+
+static unsigned int bup_pack_read_be32(const unsigned char* p)
+{
+    return ((unsigned int)p[0] << 24) | ((unsigned int)p[1] << 16) | ((unsigned int)p[2] << 8) | p[3];
+}
+
+static unsigned short bup_pack_read_be16(const unsigned char* p)
+{
+    return (unsigned short)((p[0] << 8) | p[1]);
+}
+
+static void bup_pack_write_be32(unsigned char* p, unsigned int value)
+{
+    p[0] = (unsigned char)(value >> 24);
+    p[1] = (unsigned char)(value >> 16);
+    p[2] = (unsigned char)(value >> 8);
+    p[3] = (unsigned char)value;
+}
+
+static void bup_pack_write_be16(unsigned char* p, unsigned short value)
+{
+    p[0] = (unsigned char)(value >> 8);
+    p[1] = (unsigned char)value;
+}
@@ -0,0 +1,38 @@
+/*
+ * bup_pack.h - packed .BUP container, RLE compressed save data with a CRC32 per chunk
+ *
+ * A packed .BUP is a regular 64 byte BUP header followed by a list of chunks
+ * instead of the raw save data. dir.datasize is still the unpacked size of
+ * the save. The header's unused2 field marks the container:
+ *
+ *  unused2[0-3] : BUP_PACK_MAGIC
+ *  unused2[4-7] : size in bytes of the chunk list following the header
+ *
+ * Each chunk holds up to BUP_PACK_CHUNK_SIZE bytes of save data:
+ *
+ *  0-1 : unpacked size of the chunk
+ *  2-3 : packed size of the chunk. Equal to the unpacked size if stored as is
+ *  4-7 : CRC32 of the unpacked chunk data
+ *  8-  : packed data. RLE01 key byte followed by the RLE01 compressed data
+ *
+ * Multibyte values are stored as big-endian. SGC reads packed saves and
+ * writes plain ones. Packed saves are made on the PC with tools/sgcpack.c
+ */
+#pragma once
+
+#include "bup_header.h"
+
+#define BUP_PACK_MAGIC                  "SGC2"
+#define BUP_PACK_MAGIC_LEN              4
+#define BUP_PACK_OFFSET_MAGIC           BUP_OFFSET_UNUSED2
+#define BUP_PACK_OFFSET_SIZE            (BUP_OFFSET_UNUSED2 + BUP_PACK_MAGIC_LEN)
+
+#define BUP_PACK_CHUNK_SIZE             2048
+#define BUP_PACK_CHUNK_HEADER_SIZE      8
+
+int bup_is_packed(const void* bupHeader);
+unsigned int bup_packed_size(const void* bupHeader);
+int bup_pack(const unsigned char* bup, unsigned int bupSize, unsigned char* out, unsigned int outSize, unsigned int* packedSize);
+int bup_unpack(const unsigned char* packed, unsigned int packedSize, unsigned char* out, unsigned int outSize, unsigned int* goodChunks);
+unsigned int bup_chunk_packed_size(const unsigned char* chunkHeader);
+int bup_unpack_chunk(const unsigned char* chunkHeader, const unsigned char* data, unsigned char* out, unsigned int outSize);
@@ -4,6 +4,7 @@ SET JO_ENGINE_SRC_DIR=../../jo_engine
 SET PATH=%COMPILER_DIR%\WINDOWS\Other Utilities;%PATH%
 
 rm -f ./cd/0.bin
+rm -f ./cd/SATSAVES/INDEX.BIN ./cd/SATSAVES/*/INDEX.BIN
 rm -f *.o
 rm -f %JO_ENGINE_SRC_DIR%/*.o
 rm -f ./*.bin
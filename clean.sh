@@ -1,5 +1,8 @@
 #!/bin/bash
 rm -f ./cd/0.bin
+rm -f ./cd/SATSAVES/INDEX.BIN ./cd/SATSAVES/*/INDEX.BIN
+rm -f ./tools/sgcindex
+rm -f ./tools/sgciso
 rm -f *.o
 rm -f ../../jo_engine/*.o
 rm -f ./*.bin
@@ -1,5 +1,9 @@
 #!/bin/bash
 export NCPU=`nproc`
-make clean && make -j${NCPU} all
-exit 0
+make clean
+
+# index the CD saves so they can be listed with a single read
+cc -O2 -o tools/sgcindex tools/sgcindex.c && ./tools/sgcindex cd/SATSAVES
 
+make -j${NCPU} all
+exit 0
@@ -0,0 +1,304 @@
+// Copy engine - copies a save a chunk at a time from the frame loop
+#include "copy.h"
+
+static int openTarget(PCOPY_ENGINE engine, int targetDevice, char* targetFilename, unsigned int size);
+static int readChunk(PCOPY_ENGINE engine);
+static int writeChunk(PCOPY_ENGINE engine);
+static int finishCopy(PCOPY_ENGINE engine);
+
+// opens both devices and allocates the chunk buffer
+// saveBuffer holds the whole save for devices that can't stream it, see
+// openSaveStream(). Reading into it happens before the target is opened so a
+// failed read leaves the target alone
+// returns 0 on success
+int copyStart(PCOPY_ENGINE engine, int sourceDevice, char* sourceFilename, int targetDevice, char* targetFilename, unsigned int size, unsigned char* saveBuffer, unsigned int saveBufferSize)
+{
+    int result = 0;
+
+    if(engine == NULL || sourceFilename == NULL)
+    {
+        sgc_core_error("Invalid parameters to copyStart!!");
+        return -1;
+    }
+
+    memset(engine, 0, sizeof(COPY_ENGINE));
+
+    // the target only takes the whole save, read it up front
+    if(isStreamNative(targetDevice, STREAM_MODE_WRITE) == false)
+    {
+        if(saveBuffer == NULL || size > saveBufferSize)
+        {
+            sgc_core_error("No buffer for the %d byte save!!", size);
+            return -2;
+        }
+
+        result = readSaveFile(sourceDevice, sourceFilename, saveBuffer, size);
+        if(result != 0)
+        {
+            return -3;
+        }
+
+        return copyStartFromMemory(engine, saveBuffer, size, targetDevice, targetFilename);
+    }
+
+    engine->buffer = jo_malloc(COPY_CHUNK_SIZE);
+    if(engine->buffer == NULL)
+    {
+        sgc_core_error("Failed to allocate copy buffer!!");
+        return -2;
+    }
+
+    result = openSaveStreamForCopy(&engine->source, sourceDevice, sourceFilename, targetDevice, size, saveBuffer, saveBufferSize);
+    if(result != 0)
+    {
+        copyEnd(engine);
+        return -3;
+    }
+    engine->sourceOpen = true;
+
+    return openTarget(engine, targetDevice, targetFilename, size);
+}
+
+// writes size bytes at data to the target device, e.g. a save that was already read
+// there is nothing to read, the write is only split up per frame
+// returns 0 on success
+int copyStartFromMemory(PCOPY_ENGINE engine, unsigned char* data, unsigned int size, int targetDevice, char* targetFilename)
+{
+    if(engine == NULL || data == NULL)
+    {
+        sgc_core_error("Invalid parameters to copyStartFromMemory!!");
+        return -1;
+    }
+
+    memset(engine, 0, sizeof(COPY_ENGINE));
+    engine->sourceData = data;
+
+    // streaming would only copy the save into another whole save buffer
+    if(isStreamNative(targetDevice, STREAM_MODE_WRITE) == false)
+    {
+        engine->writeWhole = true;
+        engine->targetDevice = targetDevice;
+        strncpy(engine->targetFilename, targetFilename, MAX_FILENAME - 1);
+        engine->size = size;
+        engine->startTicks = jo_get_ticks();
+        return 0;
+    }
+
+    return openTarget(engine, targetDevice, targetFilename, size);
+}
+
+// reads and writes chunks for up to COPY_FRAME_TICKS
+// returns 1 while copying, 0 when done, negative on error
+int copyStep(PCOPY_ENGINE engine)
+{
+    unsigned int frameTicks = 0;
+    int result = 0;
+
+    if(engine == NULL)
+    {
+        return -1;
+    }
+
+    if(engine->done == true)
+    {
+        return engine->result;
+    }
+
+    if(engine->writeWhole == true)
+    {
+        result = writeSaveFile(engine->targetDevice, engine->targetFilename, engine->sourceData, engine->size);
+
+        engine->bytesRead = engine->size;
+        engine->bytesWritten = (result == 0) ? engine->size : 0;
+        engine->elapsedTicks = jo_get_ticks() - engine->startTicks;
+        engine->done = true;
+        engine->result = (result == 0) ? 0 : -5;
+        return engine->result;
+    }
+
+    if(engine->targetOpen == false)
+    {
+        return -1;
+    }
+
+    frameTicks = jo_get_ticks();
+
+    do
+    {
+        if(engine->chunkSize == 0)
+        {
+            result = readChunk(engine);
+            if(result != 0)
+            {
+                engine->done = true;
+                engine->result = -2;
+                return engine->result;
+            }
+        }
+
+        result = writeChunk(engine);
+        if(result != 0)
+        {
+            engine->done = true;
+            engine->result = -3;
+            return engine->result;
+        }
+
+        if(engine->bytesWritten == engine->size)
+        {
+            return finishCopy(engine);
+        }
+
+    } while(jo_get_ticks() - frameTicks < COPY_FRAME_TICKS);
+
+    engine->elapsedTicks = jo_get_ticks() - engine->startTicks;
+
+    return 1;
+}
+
+// closes the devices and frees the chunk buffer
+// returns the result of the copy, 0 on success
+int copyEnd(PCOPY_ENGINE engine)
+{
+    if(engine == NULL)
+    {
+        return -1;
+    }
+
+    if(engine->sourceOpen == true)
+    {
+        closeSaveStream(&engine->source);
+        engine->sourceOpen = false;
+    }
+
+    // an unfinished copy, the target is incomplete
+    if(engine->targetOpen == true)
+    {
+        closeSaveStream(&engine->target);
+        engine->targetOpen = false;
+
+        if(engine->result == 0)
+        {
+            engine->result = -4;
+        }
+    }
+
+    if(engine->buffer != NULL)
+    {
+        jo_free(engine->buffer);
+        engine->buffer = NULL;
+    }
+
+    engine->done = true;
+
+    return engine->result;
+}
+
+// percent of the save written
+unsigned int copyProgress(PCOPY_ENGINE engine)
+{
+    if(engine->size == 0)
+    {
+        return 100;
+    }
+
+    return (unsigned int)(((unsigned long long)engine->bytesWritten * 100) / engine->size);
+}
+
+// bytes per second written to the target
+unsigned int copyThroughput(PCOPY_ENGINE engine)
+{
+    if(engine->elapsedTicks == 0)
+    {
+        return 0;
+    }
+
+    return (unsigned int)(((unsigned long long)engine->bytesWritten * 1000) / engine->elapsedTicks);
+}
+
+static int openTarget(PCOPY_ENGINE engine, int targetDevice, char* targetFilename, unsigned int size)
+{
+    int result = 0;
+
+    // only natively streamed targets get here
+    result = openSaveStream(&engine->target, targetDevice, targetFilename, STREAM_MODE_WRITE, size, NULL, 0);
+    if(result != 0)
+    {
+        copyEnd(engine);
+        return -4;
+    }
+
+    engine->targetOpen = true;
+    engine->size = size;
+    engine->startTicks = jo_get_ticks();
+
+    return 0;
+}
+
+// reads the next chunk from the source
+static int readChunk(PCOPY_ENGINE engine)
+{
+    int bytesRead = 0;
+
+    // copies from memory write straight from the source
+    if(engine->sourceData != NULL)
+    {
+        engine->chunk = engine->sourceData + engine->bytesRead;
+        engine->chunkSize = MIN(engine->size - engine->bytesRead, COPY_CHUNK_SIZE);
+    }
+    else
+    {
+        bytesRead = readSaveStream(&engine->source, engine->buffer, COPY_CHUNK_SIZE);
+        if(bytesRead <= 0)
+        {
+            return -1;
+        }
+
+        engine->chunk = engine->buffer;
+        engine->chunkSize = bytesRead;
+    }
+
+    engine->bytesRead += engine->chunkSize;
+
+    // done with the source, free up the CD block as early as possible
+    if(engine->bytesRead == engine->size && engine->sourceOpen == true)
+    {
+        closeSaveStream(&engine->source);
+        engine->sourceOpen = false;
+    }
+
+    return 0;
+}
+
+// writes as much of the chunk as the target takes in one go
+static int writeChunk(PCOPY_ENGINE engine)
+{
+    int bytesWritten = 0;
+
+    bytesWritten = writeSaveStream(&engine->target, engine->chunk, engine->chunkSize);
+    if(bytesWritten <= 0)
+    {
+        return -1;
+    }
+
+    engine->chunk += bytesWritten;
+    engine->chunkSize -= bytesWritten;
+    engine->bytesWritten += bytesWritten;
+
+    return 0;
+}
+
+// closing the target flushes buffered devices
+static int finishCopy(PCOPY_ENGINE engine)
+{
+    int result = 0;
+
+    result = closeSaveStream(&engine->target);
+    engine->targetOpen = false;
+
+    engine->elapsedTicks = jo_get_ticks() - engine->startTicks;
+    engine->done = true;
+    engine->result = (result == 0) ? 0 : -5;
+
+    return engine->result;
+}
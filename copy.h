@@ -0,0 +1,58 @@
+#pragma once
+
+#include "backends/backend.h"
+
+//
+// Copy engine - copies a save a chunk at a time from the frame loop
+//
+// The backends block and the SH2 has nothing to run a read on while a write
+// is in progress, so each chunk is read and then written. The copy takes as
+// long as reading plus writing the save; copying per frame only keeps the
+// screen updating with progress instead of freezing for the whole transfer.
+//
+// There is a single chunk buffer on purpose. A second one could only be
+// filled before or after the current chunk is written, never during it, so
+// ping-pong buffers would cost another COPY_CHUNK_SIZE of heap for nothing.
+// Overlapping would need a device that transfers on its own, e.g. DMA.
+//
+
+#define COPY_CHUNK_SIZE         (4 * 2048)
+#define COPY_FRAME_TICKS        12 // ms spent copying per frame, leaves time to draw
+
+// state of a copy. Advanced by copyStep() every frame
+typedef struct _COPY_ENGINE
+{
+    BACKUP_STREAM source;
+    BACKUP_STREAM target;
+    bool sourceOpen;
+    bool targetOpen;
+
+    // set when copying from memory instead of a device
+    unsigned char* sourceData;
+    int targetDevice;
+    char targetFilename[MAX_FILENAME];
+    bool writeWhole; // target doesn't stream, write the memory in one go
+
+    // chunk read from the source waiting to be written to the target
+    unsigned char* buffer; // unused when copying from memory
+    unsigned char* chunk; // the chunk data, in buffer or sourceData
+    unsigned int chunkSize; // bytes of the chunk not written yet
+
+    unsigned int size; // size of the save including the .BUP header
+    unsigned int bytesRead;
+    unsigned int bytesWritten;
+
+    // throughput
+    unsigned int startTicks;
+    unsigned int elapsedTicks;
+
+    bool done;
+    int result;
+} COPY_ENGINE, *PCOPY_ENGINE;
+
+int copyStart(PCOPY_ENGINE engine, int sourceDevice, char* sourceFilename, int targetDevice, char* targetFilename, unsigned int size, unsigned char* saveBuffer, unsigned int saveBufferSize);
+int copyStartFromMemory(PCOPY_ENGINE engine, unsigned char* data, unsigned int size, int targetDevice, char* targetFilename);
+int copyStep(PCOPY_ENGINE engine);
+int copyEnd(PCOPY_ENGINE engine);
+unsigned int copyProgress(PCOPY_ENGINE engine);
+unsigned int copyThroughput(PCOPY_ENGINE engine);
@@ -35,9 +35,21 @@
 #include "util.h"
 #include "backends/backend.h"
 #include "backends/satiator.h" // needed for satiatorReboot()
+#include "verify.h"
+#include "copy.h"
+#include "batch.h"
+#include "probe.h"
+#include "search.h"
+#include "backends/stats.h"
 
 GAME g_Game = {0};
 SAVES g_Saves[MAX_SAVES] = {0};
+VERIFY_SESSION g_Verify = {0};
+COPY_ENGINE g_Copy = {0};
+BATCH_SESSION g_Batch = {0};
+PROBE_SCHEDULER g_Probe = {0};
+SAVE_SEARCH g_Search = {0};
+char g_StatsExport[STATS_EXPORT_SIZE] = {0};
 
 void jo_main(void)
 {
@@ -60,6 +72,8 @@ void jo_main(void)
     jo_core_set_restart_game_callback(abcStartHandler);
 
     // callbacks
+    jo_core_add_callback(queryBackupDevices_update);
+
     jo_core_add_callback(main_draw);
     jo_core_add_callback(main_input);
 
@@ -84,6 +98,21 @@ void jo_main(void)
     jo_core_add_callback(credits_draw);
     jo_core_add_callback(credits_input);
 
+    jo_core_add_callback(verifySelect_draw);
+    jo_core_add_callback(verifySelect_input);
+
+    jo_core_add_callback(verify_draw);
+    jo_core_add_callback(verify_input);
+
+    jo_core_add_callback(batchSelect_draw);
+    jo_core_add_callback(batchSelect_input);
+
+    jo_core_add_callback(batch_draw);
+    jo_core_add_callback(batch_input);
+
+    jo_core_add_callback(stats_draw);
+    jo_core_add_callback(stats_input);
+
     // debug output
     //jo_core_add_callback(debugOutput_draw);
 
@@ -124,38 +153,41 @@ void abcStartHandler(void)
     return;
 }
 
-// verifies which backup devices are available
-// needed for dynamic menu
+// queues the backup device probes
+// the devices are probed a few per frame by queryBackupDevices_update() so the
+// main menu is usable while slow devices are still being detected
 void queryBackupDevices(void)
 {
+    int external = 0;
+    int satiator = 0;
+
+    probeInit(&g_Probe);
+
     if(SKIP_DEVICE_CHECKS == 0)
     {
-        g_Game.deviceInternalMemoryBackup = isBackupDeviceAvailable(JoInternalMemoryBackup);
-        g_Game.deviceCartridgeMemoryBackup = isBackupDeviceAvailable(JoCartridgeMemoryBackup);
-        g_Game.deviceExternalDeviceBackup = isBackupDeviceAvailable(JoExternalDeviceBackup);
-        g_Game.deviceActionReplayBackup = isBackupDeviceAvailable(ActionReplayBackup);
-        g_Game.deviceSatiatorBackup = isBackupDeviceAvailable(SatiatorBackup);
-        g_Game.deviceCdMemoryBackup = isBackupDeviceAvailable(CdMemoryBackup);        
-        g_Game.deviceModemBackup = isBackupDeviceAvailable(ModemBackup);
+        // cheapest probes first
+        probeAdd(&g_Probe, JoInternalMemoryBackup, &g_Game.deviceInternalMemoryBackup, PROBE_NO_DEPENDENCY);
+        probeAdd(&g_Probe, JoCartridgeMemoryBackup, &g_Game.deviceCartridgeMemoryBackup, PROBE_NO_DEPENDENCY);
+        external = probeAdd(&g_Probe, JoExternalDeviceBackup, &g_Game.deviceExternalDeviceBackup, PROBE_NO_DEPENDENCY);
+        probeAdd(&g_Probe, MemoryBackup, &g_Game.deviceRamDiskBackup, PROBE_NO_DEPENDENCY);
 
-        if(g_Game.deviceExternalDeviceBackup == false)
-        {
-            g_Game.deviceSerialBackup = true;
-        }
+        // serial link shares the port with the external device
+        probeAdd(&g_Probe, SerialBackup, &g_Game.deviceSerialBackup, external);
+
+        probeAdd(&g_Probe, ActionReplayBackup, &g_Game.deviceActionReplayBackup, PROBE_NO_DEPENDENCY);
+        probeAdd(&g_Probe, CdMemoryBackup, &g_Game.deviceCdMemoryBackup, PROBE_NO_DEPENDENCY);
+        satiator = probeAdd(&g_Probe, SatiatorBackup, &g_Game.deviceSatiatorBackup, PROBE_NO_DEPENDENCY);
 
         // some Satiator users were reporting black screens at boot
         // possibly related to MODE?
-        if(g_Game.deviceSatiatorBackup == false)
-        {
-            g_Game.deviceModeBackup = isBackupDeviceAvailable(MODEBackup);
-        }
+        probeAdd(&g_Probe, MODEBackup, &g_Game.deviceModeBackup, satiator);
 
         // Satiator users are reporting hangs. Possibly related to VCD Card detection
         // in Satiator
-        if(g_Game.deviceSatiatorBackup == false)
-        {
-            g_Game.deviceVCDCardBackup = isBackupDeviceAvailable(VCDCardBackup);
-        }        
+        probeAdd(&g_Probe, VCDCardBackup, &g_Game.deviceVCDCardBackup, satiator);
+
+        // the modem probe retries, do it last
+        probeAdd(&g_Probe, ModemBackup, &g_Game.deviceModemBackup, PROBE_NO_DEPENDENCY);
     }
     else
     {
@@ -169,6 +201,54 @@ void queryBackupDevices(void)
         g_Game.deviceVCDCardBackup = true;
         g_Game.deviceSerialBackup = true;
         g_Game.deviceModemBackup = true;
+        g_Game.deviceRamDiskBackup = true;
+        g_Probe.done = true;
+    }
+
+    return;
+}
+
+// probes a frame's worth of backup devices
+// adds newly found devices to the main menu keeping the cursor on the same option
+void queryBackupDevices_update(void)
+{
+    int option = -1;
+    int found = 0;
+    bool wasDone = g_Probe.done;
+
+    if(g_Probe.done == true)
+    {
+        return;
+    }
+
+    found = probeStep(&g_Probe, PROBE_FRAME_TICKS);
+    if(found <= 0 && wasDone == g_Probe.done)
+    {
+        return;
+    }
+
+    if(g_Game.state != STATE_MAIN)
+    {
+        // the menu is built when we return to it
+        return;
+    }
+
+    if(g_Game.numMenuOptions > 0)
+    {
+        option = g_Game.menuOptions[g_Game.cursorOffset].option;
+    }
+
+    // the options below the new ones shift down
+    clearScreen();
+    g_Game.numStateOptions = initMenuOptions(STATE_MAIN);
+
+    for(unsigned int i = 0; i < g_Game.numMenuOptions; i++)
+    {
+        if((int)g_Game.menuOptions[i].option == option)
+        {
+            g_Game.cursorOffset = i;
+            break;
+        }
     }
 
     return;
@@ -206,6 +286,11 @@ void transitionToState(int newState)
         case STATE_WRITE_MEMORY:
         case STATE_COLLECT:
         case STATE_CREDITS:
+        case STATE_VERIFY_SELECT:
+        case STATE_VERIFY:
+        case STATE_BATCH_SELECT:
+        case STATE_BATCH:
+        case STATE_STATS:
             break;
 
         default:
@@ -230,6 +315,8 @@ void transitionToState(int newState)
             g_Game.numStateOptions = 0; // 0 options until we list the number of saves
             g_Game.numSaves = 0; // number of saves counted
             g_Game.listedSaves = false;
+            g_Game.numSelectedSaves = 0;
+            memset(g_Game.selectedSaves, 0, sizeof(g_Game.selectedSaves));
             break;
 
         case STATE_DISPLAY_SAVE:
@@ -240,7 +327,7 @@ void transitionToState(int newState)
             g_Game.numStateOptions = SAVES_NUM_OPTIONS;
             g_Game.md5Calculated = false;
             g_Game.operationStatus = OPERATION_UNINIT;
-            g_Game.numStateOptions = initMenuOptions(STATE_DISPLAY_SAVE);
+            g_Game.numStateOptions = initMenuOptions(newState);
             break;
 
         case STATE_FORMAT:
@@ -283,6 +370,48 @@ void transitionToState(int newState)
         case STATE_CREDITS:
             break;
 
+        case STATE_VERIFY_SELECT:
+            g_Game.cursorPosX = CURSOR_X;
+            g_Game.cursorPosY = OPTIONS_Y + 1;
+            g_Game.cursorOffset = 0;
+            g_Game.verifySourceDevice = -1;
+            g_Game.verifyTargetDevice = -1;
+            g_Game.numStateOptions = initMenuOptions(STATE_VERIFY_SELECT);
+            break;
+
+        case STATE_VERIFY:
+            g_Game.cursorPosX = CURSOR_X;
+            g_Game.cursorPosY = VERIFY_RESULTS_Y + 1;
+            g_Game.cursorOffset = 0;
+            g_Game.numStateOptions = 0; // 0 options until the verify completes
+            g_Game.verifyStarted = false;
+            verifyEnd(&g_Verify);
+            break;
+
+        case STATE_BATCH_SELECT:
+            g_Game.cursorPosX = CURSOR_X;
+            g_Game.cursorPosY = OPTIONS_Y + 1;
+            g_Game.cursorOffset = 0;
+            g_Game.batchTargetDevice = -1;
+            g_Game.numStateOptions = initMenuOptions(STATE_BATCH_SELECT);
+            break;
+
+        case STATE_BATCH:
+            g_Game.cursorPosX = CURSOR_X;
+            g_Game.cursorPosY = VERIFY_RESULTS_Y + 1;
+            g_Game.cursorOffset = 0;
+            g_Game.numStateOptions = 0; // 0 options until the batch completes
+            g_Game.batchStarted = false;
+            batchEnd(&g_Batch);
+            break;
+
+        case STATE_STATS:
+            g_Game.cursorPosX = CURSOR_X;
+            g_Game.cursorPosY = VERIFY_RESULTS_Y + 1;
+            g_Game.cursorOffset = 0;
+            g_Game.numStateOptions = statsGetCount();
+            break;
+
         default:
             sgc_core_error("%d is an invalid state!!", newState);
             return;
@@ -341,6 +470,26 @@ int pushState(int newState)
     return 0;
 }
 
+// appends an option to menuOptions, or only counts it if menuOptions is NULL
+// returns false if the menu is already full
+bool addMenuOption(PMENUOPTIONS menuOptions, unsigned int* numOptions, char* optionText, unsigned int option)
+{
+    if(*numOptions >= MAX_MENU_OPTIONS)
+    {
+        sgc_core_error("addMenuOption: no room for %s (%d)!!", optionText, *numOptions);
+        return false;
+    }
+
+    if(menuOptions != NULL)
+    {
+        menuOptions[*numOptions].optionText = optionText;
+        menuOptions[*numOptions].option = option;
+    }
+
+    (*numOptions)++;
+    return true;
+}
+
 // initialize the menu for the specified state
 // the dynamic menu should only show options that make sense for the user
 // ex. hide Satiator for non-Satiator users etc
@@ -359,209 +508,214 @@ unsigned int initMenuOptions(int newState)
             // only show main menu options for devices that have been detected
             if(g_Game.deviceInternalMemoryBackup == true)
             {
-                g_Game.menuOptions[numMenuOptions].optionText = "Internal Memory";
-                g_Game.menuOptions[numMenuOptions].option = MAIN_OPTION_INTERNAL;
-                numMenuOptions++;
+                addMenuOption(g_Game.menuOptions, &numMenuOptions, "Internal Memory", MAIN_OPTION_INTERNAL);
             }
 
             if(g_Game.deviceCartridgeMemoryBackup == true)
             {
-                g_Game.menuOptions[numMenuOptions].optionText = "Cartridge Memory";
-                g_Game.menuOptions[numMenuOptions].option = MAIN_OPTION_CARTRIDGE;
-                numMenuOptions++;
+                addMenuOption(g_Game.menuOptions, &numMenuOptions, "Cartridge Memory", MAIN_OPTION_CARTRIDGE);
             }
 
             if(g_Game.deviceExternalDeviceBackup == true)
             {
-                g_Game.menuOptions[numMenuOptions].optionText = "External Device (Floppy)";
-                g_Game.menuOptions[numMenuOptions].option = MAIN_OPTION_EXTERNAL;
-                numMenuOptions++;
+                addMenuOption(g_Game.menuOptions, &numMenuOptions, "External Device (Floppy)", MAIN_OPTION_EXTERNAL);
             }
 
             if(g_Game.deviceActionReplayBackup == true)
             {
-                g_Game.menuOptions[numMenuOptions].optionText = "Action Replay (Read-Only)";
-                g_Game.menuOptions[numMenuOptions].option = MAIN_OPTION_ACTION_REPLAY;
-                numMenuOptions++;
+                addMenuOption(g_Game.menuOptions, &numMenuOptions, "Action Replay (Read-Only)", MAIN_OPTION_ACTION_REPLAY);
             }
 
             if(g_Game.deviceSatiatorBackup == true)
             {
-                g_Game.menuOptions[numMenuOptions].optionText = "Satiator";
-                g_Game.menuOptions[numMenuOptions].option = MAIN_OPTION_SATIATOR;
-                numMenuOptions++;
+                addMenuOption(g_Game.menuOptions, &numMenuOptions, "Satiator", MAIN_OPTION_SATIATOR);
             }
 
             if (g_Game.deviceModeBackup == true)
             {
-                g_Game.menuOptions[numMenuOptions].optionText = "MODE";
-                g_Game.menuOptions[numMenuOptions].option = MAIN_OPTION_MODE;
-                numMenuOptions++;
+                addMenuOption(g_Game.menuOptions, &numMenuOptions, "MODE", MAIN_OPTION_MODE);
             }
 
             if(g_Game.deviceSerialBackup == true)
             {
-                g_Game.menuOptions[numMenuOptions].optionText = "Serial Link";
-                g_Game.menuOptions[numMenuOptions].option = MAIN_OPTION_SERIAL;
-                numMenuOptions++;
+                addMenuOption(g_Game.menuOptions, &numMenuOptions, "Serial Link", MAIN_OPTION_SERIAL);
             }
 
             if(g_Game.deviceModemBackup == true)
             {
-                g_Game.menuOptions[numMenuOptions].optionText = "Modem";
-                g_Game.menuOptions[numMenuOptions].option = MAIN_OPTION_MODEM;
-                numMenuOptions++;
+                addMenuOption(g_Game.menuOptions, &numMenuOptions, "Modem", MAIN_OPTION_MODEM);
             }
 
             if(g_Game.deviceCdMemoryBackup == true)
             {
-                g_Game.menuOptions[numMenuOptions].optionText = "CD File System";
-                g_Game.menuOptions[numMenuOptions].option = MAIN_OPTION_CD;
-                numMenuOptions++;
+                addMenuOption(g_Game.menuOptions, &numMenuOptions, "CD File System", MAIN_OPTION_CD);
             }
 
             if(g_Game.deviceVCDCardBackup == true)
             {
-                g_Game.menuOptions[numMenuOptions].optionText = "VCD Card";
-                g_Game.menuOptions[numMenuOptions].option = MAIN_OPTION_VCD_CARD;
-                numMenuOptions++;
+                addMenuOption(g_Game.menuOptions, &numMenuOptions, "VCD Card", MAIN_OPTION_VCD_CARD);
+            }
+
+            if(g_Game.deviceRamDiskBackup == true)
+            {
+                addMenuOption(g_Game.menuOptions, &numMenuOptions, "RAM Disk", MAIN_OPTION_RAM_DISK);
+            }
+
+            // verifying needs a source and a target
+            if(getVerifyDeviceOptions(-1, NULL) >= 2)
+            {
+                addMenuOption(g_Game.menuOptions, &numMenuOptions, "Verify Saves", MAIN_OPTION_VERIFY);
             }
 
-            g_Game.menuOptions[numMenuOptions].optionText = "Dump Memory";
-            g_Game.menuOptions[numMenuOptions].option = MAIN_OPTION_DUMP_MEMORY;
-            numMenuOptions++;
+            addMenuOption(g_Game.menuOptions, &numMenuOptions, "Transfer Stats", MAIN_OPTION_STATS);
+
+            addMenuOption(g_Game.menuOptions, &numMenuOptions, "Dump Memory", MAIN_OPTION_DUMP_MEMORY);
 
             if(g_Game.deviceInternalMemoryBackup == true)
             {
-                g_Game.menuOptions[numMenuOptions].optionText = "Format Device";
-                g_Game.menuOptions[numMenuOptions].option = MAIN_OPTION_FORMAT;
-                numMenuOptions++;
+                addMenuOption(g_Game.menuOptions, &numMenuOptions, "Format Device", MAIN_OPTION_FORMAT);
             }
 
-            g_Game.menuOptions[numMenuOptions].optionText = "Save Collect Project";
-            g_Game.menuOptions[numMenuOptions].option = MAIN_OPTION_COLLECT;
-            numMenuOptions++;
+            addMenuOption(g_Game.menuOptions, &numMenuOptions, "Save Collect Project", MAIN_OPTION_COLLECT);
 
-            g_Game.menuOptions[numMenuOptions].optionText = "Credits";
-            g_Game.menuOptions[numMenuOptions].option = MAIN_OPTION_CREDITS;
-            numMenuOptions++;
+            addMenuOption(g_Game.menuOptions, &numMenuOptions, "Credits", MAIN_OPTION_CREDITS);
 
-            g_Game.menuOptions[numMenuOptions].optionText = "Exit to CD Player";
-            g_Game.menuOptions[numMenuOptions].option = MAIN_OPTION_EXIT;
-            numMenuOptions++;
+            addMenuOption(g_Game.menuOptions, &numMenuOptions, "Exit to CD Player", MAIN_OPTION_EXIT);
 
             if(g_Game.deviceSatiatorBackup == true)
             {
-                g_Game.menuOptions[numMenuOptions].optionText = "Exit to Satiator";
-                g_Game.menuOptions[numMenuOptions].option = MAIN_OPTION_EXIT_SATIATOR;
-                numMenuOptions++;
+                addMenuOption(g_Game.menuOptions, &numMenuOptions, "Exit to Satiator", MAIN_OPTION_EXIT_SATIATOR);
             }
 
-            g_Game.menuOptions[numMenuOptions].optionText = "Reboot";
-            g_Game.menuOptions[numMenuOptions].option = MAIN_OPTION_REBOOT;
-            numMenuOptions++;
+            addMenuOption(g_Game.menuOptions, &numMenuOptions, "Reboot", MAIN_OPTION_REBOOT);
 
             break;
         }
 
         case STATE_DISPLAY_SAVE:
+        case STATE_DISPLAY_MEMORY:
         {
+            // memory dumps and the stats export aren't on any device and can be copied anywhere
+            int sourceDevice = newState == STATE_DISPLAY_SAVE ? (int)g_Game.backupDevice : -1;
+
             // only show display save menu options for devices that have been detected
             // don't allow user to copy file back to same device
             // don't allow user to delete CD save
-            if(g_Game.deviceInternalMemoryBackup == true && g_Game.backupDevice != JoInternalMemoryBackup)
+            if(g_Game.deviceInternalMemoryBackup == true && sourceDevice != JoInternalMemoryBackup)
+            {
+                addMenuOption(g_Game.menuOptions, &numMenuOptions, "Copy to Internal Memory", SAVE_OPTION_INTERNAL);
+            }
+
+            if(g_Game.deviceCartridgeMemoryBackup == true && sourceDevice != JoCartridgeMemoryBackup)
             {
-                g_Game.menuOptions[numMenuOptions].optionText = "Copy to Internal Memory";
-                g_Game.menuOptions[numMenuOptions].option = SAVE_OPTION_INTERNAL;
-                numMenuOptions++;
+                addMenuOption(g_Game.menuOptions, &numMenuOptions, "Copy to Cartridge Memory", SAVE_OPTION_CARTRIDGE);
             }
 
-            if(g_Game.deviceCartridgeMemoryBackup == true && g_Game.backupDevice != JoCartridgeMemoryBackup)
+            if(g_Game.deviceExternalDeviceBackup == true && sourceDevice != JoExternalDeviceBackup)
             {
-                g_Game.menuOptions[numMenuOptions].optionText = "Copy to Cartridge Memory";
-                g_Game.menuOptions[numMenuOptions].option = SAVE_OPTION_CARTRIDGE;
-                numMenuOptions++;
+                addMenuOption(g_Game.menuOptions, &numMenuOptions, "Copy to External Device (Floppy)", SAVE_OPTION_EXTERNAL);
             }
 
-            if(g_Game.deviceExternalDeviceBackup == true && g_Game.backupDevice != JoExternalDeviceBackup)
+            if(g_Game.deviceSatiatorBackup == true && sourceDevice != SatiatorBackup)
             {
-                g_Game.menuOptions[numMenuOptions].optionText = "Copy to External Device (Floppy)";
-                g_Game.menuOptions[numMenuOptions].option = SAVE_OPTION_EXTERNAL;
-                numMenuOptions++;
+                addMenuOption(g_Game.menuOptions, &numMenuOptions, "Copy to Satiator", SAVE_OPTION_SATIATOR);
             }
 
-            if(g_Game.deviceSatiatorBackup == true && g_Game.backupDevice != SatiatorBackup)
+            if (g_Game.deviceModeBackup == true && sourceDevice != MODEBackup)
             {
-                g_Game.menuOptions[numMenuOptions].optionText = "Copy to Satiator";
-                g_Game.menuOptions[numMenuOptions].option = SAVE_OPTION_SATIATOR;
-                numMenuOptions++;
+                addMenuOption(g_Game.menuOptions, &numMenuOptions, "Copy to MODE", SAVE_OPTION_MODE);
             }
 
-            if (g_Game.deviceModeBackup == true && g_Game.backupDevice != MODEBackup)
+            if (g_Game.deviceSerialBackup == true && sourceDevice != SerialBackup)
             {
-                g_Game.menuOptions[numMenuOptions].optionText = "Copy to MODE";
-                g_Game.menuOptions[numMenuOptions].option = SAVE_OPTION_MODE;
-                numMenuOptions++;
+                addMenuOption(g_Game.menuOptions, &numMenuOptions, "Copy to Serial Link", SAVE_OPTION_SERIAL);
             }
 
-            if (g_Game.deviceSerialBackup == true && g_Game.backupDevice != SerialBackup)
+            if (g_Game.deviceModemBackup == true && sourceDevice != ModemBackup)
             {
-                g_Game.menuOptions[numMenuOptions].optionText = "Copy to Serial Link";
-                g_Game.menuOptions[numMenuOptions].option = SAVE_OPTION_SERIAL;
-                numMenuOptions++;
+                addMenuOption(g_Game.menuOptions, &numMenuOptions, "Copy to Modem", SAVE_OPTION_MODEM);
             }
 
-            if (g_Game.deviceModemBackup == true && g_Game.backupDevice != ModemBackup)
+            if (g_Game.deviceRamDiskBackup == true && sourceDevice != MemoryBackup)
             {
-                g_Game.menuOptions[numMenuOptions].optionText = "Copy to Modem";
-                g_Game.menuOptions[numMenuOptions].option = SAVE_OPTION_MODEM;
-                numMenuOptions++;
+                addMenuOption(g_Game.menuOptions, &numMenuOptions, "Copy to RAM Disk", SAVE_OPTION_RAM_DISK);
             }
 
             // TODO: temporarily disable write to memory option
-            //g_Game.menuOptions[numMenuOptions].optionText = "Write to Memory";
-            //g_Game.menuOptions[numMenuOptions].option = SAVE_OPTION_WRITE_MEMORY;
-            //numMenuOptions++;
+            //addMenuOption(g_Game.menuOptions, &numMenuOptions, "Write to Memory", SAVE_OPTION_WRITE_MEMORY);
 
-            // delete only if writeable medium
-            if(isBackupDeviceWriteable(g_Game.backupDevice))
+            // delete only if the device supports it
+            // doesn't make sense to delete a memory dump
+            if(newState == STATE_DISPLAY_SAVE && hasBackupDeviceCapability(g_Game.backupDevice, BACKUP_CAP_DELETE))
             {
-                g_Game.menuOptions[numMenuOptions].optionText = "Delete Save";
-                g_Game.menuOptions[numMenuOptions].option = SAVE_OPTION_DELETE;
-                numMenuOptions++;
+                addMenuOption(g_Game.menuOptions, &numMenuOptions, "Delete Save", SAVE_OPTION_DELETE);
             }
 
             // back out
-            g_Game.menuOptions[numMenuOptions].optionText = "Back";
-            g_Game.menuOptions[numMenuOptions].option = SAVE_OPTION_BACK;
-            numMenuOptions++;
+            addMenuOption(g_Game.menuOptions, &numMenuOptions, "Back", SAVE_OPTION_BACK);
 
             break;
         }
 
         case STATE_FORMAT:
-            // only show format menu options for devices that have been detected
-            if(g_Game.deviceInternalMemoryBackup == true)
+            // only show format menu options for devices that have been detected and can be formatted
+            if(g_Game.deviceInternalMemoryBackup == true && hasBackupDeviceCapability(JoInternalMemoryBackup, BACKUP_CAP_FORMAT))
             {
-                g_Game.menuOptions[numMenuOptions].optionText = "Internal Memory";
-                g_Game.menuOptions[numMenuOptions].option = MAIN_OPTION_INTERNAL;
-                numMenuOptions++;
+                addMenuOption(g_Game.menuOptions, &numMenuOptions, "Internal Memory", MAIN_OPTION_INTERNAL);
             }
 
-            if(g_Game.deviceCartridgeMemoryBackup == true)
+            if(g_Game.deviceCartridgeMemoryBackup == true && hasBackupDeviceCapability(JoCartridgeMemoryBackup, BACKUP_CAP_FORMAT))
             {
-                g_Game.menuOptions[numMenuOptions].optionText = "Cartridge Memory";
-                g_Game.menuOptions[numMenuOptions].option = MAIN_OPTION_CARTRIDGE;
-                numMenuOptions++;
+                addMenuOption(g_Game.menuOptions, &numMenuOptions, "Cartridge Memory", MAIN_OPTION_CARTRIDGE);
             }
 
-            if(g_Game.deviceExternalDeviceBackup == true)
+            if(g_Game.deviceExternalDeviceBackup == true && hasBackupDeviceCapability(JoExternalDeviceBackup, BACKUP_CAP_FORMAT))
+            {
+                addMenuOption(g_Game.menuOptions, &numMenuOptions, "External Device (Floppy)", MAIN_OPTION_EXTERNAL);
+            }
+
+            if(g_Game.deviceRamDiskBackup == true && hasBackupDeviceCapability(MemoryBackup, BACKUP_CAP_FORMAT))
+            {
+                addMenuOption(g_Game.menuOptions, &numMenuOptions, "RAM Disk", MAIN_OPTION_RAM_DISK);
+            }
+            break;
+
+        case STATE_VERIFY_SELECT:
+            // the device already selected as the source can't also be the target
+            numMenuOptions = getVerifyDeviceOptions(g_Game.verifySourceDevice, g_Game.menuOptions);
+            break;
+
+        case STATE_BATCH_SELECT:
+        {
+            // the selected saves can be copied to any other writeable device
+            const struct
+            {
+                bool detected;
+                int backupDevice;
+                char* optionText;
+            } batchDevices[] =
             {
-                g_Game.menuOptions[numMenuOptions].optionText = "External Device (Floppy)";
-                g_Game.menuOptions[numMenuOptions].option = MAIN_OPTION_EXTERNAL;
-                numMenuOptions++;
+                {g_Game.deviceInternalMemoryBackup, JoInternalMemoryBackup, "Internal Memory"},
+                {g_Game.deviceCartridgeMemoryBackup, JoCartridgeMemoryBackup, "Cartridge Memory"},
+                {g_Game.deviceExternalDeviceBackup, JoExternalDeviceBackup, "External Device (Floppy)"},
+                {g_Game.deviceSatiatorBackup, SatiatorBackup, "Satiator"},
+                {g_Game.deviceModeBackup, MODEBackup, "MODE"},
+                {g_Game.deviceSerialBackup, SerialBackup, "Serial Link"},
+                {g_Game.deviceModemBackup, ModemBackup, "Modem"},
+                {g_Game.deviceRamDiskBackup, MemoryBackup, "RAM Disk"},
+            };
+
+            for(unsigned int i = 0; i < COUNTOF(batchDevices); i++)
+            {
+                if(batchDevices[i].detected == true &&
+                    batchDevices[i].backupDevice != (int)g_Game.backupDevice &&
+                    isBackupDeviceWriteable(batchDevices[i].backupDevice))
+                {
+                    addMenuOption(g_Game.menuOptions, &numMenuOptions, batchDevices[i].optionText, batchDevices[i].backupDevice);
+                }
             }
             break;
+        }
 
         default:
             sgc_core_error("%d is an invalid current state!!", g_Game.state);
@@ -573,6 +727,42 @@ unsigned int initMenuOptions(int newState)
     return numMenuOptions;
 }
 
+// fills menuOptions with the devices that can be verified, skipping excludeDevice
+// only devices that can be listed and read can be verified
+// menuOptions may be NULL to only count the devices
+unsigned int getVerifyDeviceOptions(int excludeDevice, PMENUOPTIONS menuOptions)
+{
+    unsigned int numOptions = 0;
+    const struct
+    {
+        bool detected;
+        int backupDevice;
+        char* optionText;
+    } verifyDevices[] =
+    {
+        {g_Game.deviceInternalMemoryBackup, JoInternalMemoryBackup, "Internal Memory"},
+        {g_Game.deviceCartridgeMemoryBackup, JoCartridgeMemoryBackup, "Cartridge Memory"},
+        {g_Game.deviceExternalDeviceBackup, JoExternalDeviceBackup, "External Device (Floppy)"},
+        {g_Game.deviceActionReplayBackup, ActionReplayBackup, "Action Replay (Read-Only)"},
+        {g_Game.deviceSatiatorBackup, SatiatorBackup, "Satiator"},
+        {g_Game.deviceModeBackup, MODEBackup, "MODE"},
+        {g_Game.deviceCdMemoryBackup, CdMemoryBackup, "CD File System"},
+        {g_Game.deviceRamDiskBackup, MemoryBackup, "RAM Disk"},
+    };
+
+    for(unsigned int i = 0; i < COUNTOF(verifyDevices); i++)
+    {
+        if(verifyDevices[i].detected == true &&
+            verifyDevices[i].backupDevice != excludeDevice &&
+            hasBackupDeviceCapability(verifyDevices[i].backupDevice, BACKUP_CAP_LIST | BACKUP_CAP_READ | BACKUP_CAP_BUP_HEADER))
+        {
+            addMenuOption(menuOptions, &numOptions, verifyDevices[i].optionText, verifyDevices[i].backupDevice);
+        }
+    }
+
+    return numOptions;
+}
+
 // helper function to take the cursor index and return the value
 // of the menu option
 unsigned int getMenuOptionByIndex(unsigned int index)
@@ -610,6 +800,11 @@ void main_draw(void)
         jo_printf(OPTIONS_X, OPTIONS_Y + i, g_Game.menuOptions[i].optionText);
     }
 
+    if(g_Probe.done == false)
+    {
+        jo_printf(OPTIONS_X, OPTIONS_Y + g_Game.numMenuOptions + 1, "Detecting devices...");
+    }
+
     // cursor
     jo_printf(g_Game.cursorPosX, g_Game.cursorPosY + g_Game.cursorOffset, ">>");
 
@@ -795,6 +990,12 @@ void main_input(void)
                     transitionToState(STATE_LIST_SAVES);
                     return;
                 }
+                case MAIN_OPTION_RAM_DISK:
+                {
+                    g_Game.backupDevice = MemoryBackup;
+                    transitionToState(STATE_LIST_SAVES);
+                    return;
+                }
                 case MAIN_OPTION_SERIAL:
                 {
                     g_Game.backupDevice = SerialBackup;
@@ -812,6 +1013,16 @@ void main_input(void)
                     transitionToState(STATE_FORMAT);
                     return;
                 }
+                case MAIN_OPTION_VERIFY:
+                {
+                    transitionToState(STATE_VERIFY_SELECT);
+                    return;
+                }
+                case MAIN_OPTION_STATS:
+                {
+                    transitionToState(STATE_STATS);
+                    return;
+                }
                 case MAIN_OPTION_DUMP_MEMORY:
                 {
                     g_Game.backupDevice = MemoryBackup;
@@ -866,9 +1077,64 @@ int compareSaveName (const void * a, const void * b)
     PSAVES aSave = (PSAVES)a;
     PSAVES bSave = (PSAVES)b;
 
+    // subdirectories are listed before the saves
+    if(aSave->directory != bSave->directory)
+    {
+        return aSave->directory ? -1 : 1;
+    }
+
     return strcmp(aSave->name, bSave->name);
 }
 
+// single character shown next to suspect and corrupt saves in the save list
+char getSaveStatusMarker(unsigned char status)
+{
+    switch(status)
+    {
+        case SAVE_STATUS_SUSPECT:
+            return '?';
+        case SAVE_STATUS_CORRUPT:
+            return '!';
+        default:
+            return ' ';
+    }
+}
+
+// moves the list saves cursor to index, erasing the old cursor like moveCursor()
+// SEARCH_NOT_FOUND leaves the cursor where it is
+void jumpToSave(int index)
+{
+    if(index < 0 || index >= g_Game.numSaves)
+    {
+        return;
+    }
+
+    jo_printf(g_Game.cursorPosX, g_Game.cursorPosY + (g_Game.listSavesCursorOffset % MAX_SAVES_PER_PAGE), "  ");
+    g_Game.listSavesCursorOffset = index;
+}
+
+// enters or leaves a subdirectory of the device and lists it again
+// the state stack is untouched, B walks back up the directories
+void changeListDirectory(char* directory)
+{
+    int result = 0;
+
+    result = changeSaveDirectory(g_Game.backupDevice, directory);
+    if(result != 0)
+    {
+        return;
+    }
+
+    clearScreen();
+
+    g_Game.listSavesCursorOffset = 0;
+    g_Game.numStateOptions = 0;
+    g_Game.numSaves = 0;
+    g_Game.listedSaves = false;
+    g_Game.numSelectedSaves = 0;
+    memset(g_Game.selectedSaves, 0, sizeof(g_Game.selectedSaves));
+}
+
 // draws the list saves screen
 void listSaves_draw(void)
 {
@@ -886,7 +1152,14 @@ void listSaves_draw(void)
         return;
     }
 
-    jo_printf(HEADING_X, HEADING_Y, "%s", g_Game.backupDeviceName);
+    if(getSaveDirectory(g_Game.backupDevice)[0] != '\0')
+    {
+        jo_printf(HEADING_X, HEADING_Y, "%s: %s", g_Game.backupDeviceName, getSaveDirectory(g_Game.backupDevice));
+    }
+    else
+    {
+        jo_printf(HEADING_X, HEADING_Y, "%s", g_Game.backupDeviceName);
+    }
     jo_printf(HEADING_X, HEADING_Y + 1, HEADING_UNDERSCORE);
 
     if(g_Game.listedSaves == false)
@@ -895,15 +1168,8 @@ void listSaves_draw(void)
 
         //g_Game.listSavesCursorOffset = 0;
 
-        // BUP devices
-        if(g_Game.backupDevice == JoInternalMemoryBackup ||
-            g_Game.backupDevice == JoCartridgeMemoryBackup ||
-            g_Game.backupDevice == JoExternalDeviceBackup ||
-            g_Game.backupDevice == CdMemoryBackup ||
-            g_Game.backupDevice == VCDCardBackup ||
-            g_Game.backupDevice == SatiatorBackup ||
-            g_Game.backupDevice == ActionReplayBackup ||
-            g_Game.backupDevice == MODEBackup)
+        // devices that can be browsed
+        if(hasBackupDeviceCapability(g_Game.backupDevice, BACKUP_CAP_LIST))
         {
             jo_memset(g_Saves, 0, sizeof(g_Saves));
             g_Game.listedSaves = true;
@@ -918,6 +1184,10 @@ void listSaves_draw(void)
 
                 // update the count of saves
                 g_Game.numSaves = count;
+
+                // L/R and the keyboard jump through the sorted saves
+                searchInit(&g_Search, g_Saves, count);
+                g_Game.searchPrefix[0] = '\0';
             }
             else
             {
@@ -952,7 +1222,31 @@ void listSaves_draw(void)
         // print up to MAX_SAVES_PER_PAGE saves on the screen
         for(i = (g_Game.listSavesCursorOffset / MAX_SAVES_PER_PAGE) * MAX_SAVES_PER_PAGE, j = 0; i < g_Game.numSaves && j < MAX_SAVES_PER_PAGE; i++, j++)
         {
-            jo_printf(OPTIONS_X, OPTIONS_Y + (i % MAX_SAVES_PER_PAGE) + 1, "%-11s  %-10s  %6d", g_Saves[i].name, g_Saves[i].comment, g_Saves[i].datasize);
+            if(g_Saves[i].directory)
+            {
+                jo_printf(OPTIONS_X, OPTIONS_Y + (i % MAX_SAVES_PER_PAGE) + 1, "%-11s  %-10s  %6s", g_Saves[i].name, "<DIR>", "");
+                continue;
+            }
+
+            jo_printf(OPTIONS_X, OPTIONS_Y + (i % MAX_SAVES_PER_PAGE) + 1, "%-11s  %-10s  %6d %c%c", g_Saves[i].name, g_Saves[i].comment, g_Saves[i].datasize, getSaveStatusMarker(g_Saves[i].status), g_Game.selectedSaves[i] ? '*' : ' ');
+        }
+
+        if(g_Game.numSelectedSaves > 0)
+        {
+            jo_printf(OPTIONS_X, SELECTED_Y, "Selected: %-3d  Start to copy      ", g_Game.numSelectedSaves);
+        }
+        else
+        {
+            jo_printf(OPTIONS_X, SELECTED_Y, "X to select, Y to select all       ");
+        }
+
+        if(g_Game.searchPrefix[0] != '\0')
+        {
+            jo_printf(OPTIONS_X, SELECTED_Y + 1, "Search: %-11s", g_Game.searchPrefix);
+        }
+        else
+        {
+            jo_printf(OPTIONS_X, SELECTED_Y + 1, "L/R to jump by letter  ");
         }
 
         g_Game.numStateOptions = g_Game.numSaves;
@@ -977,6 +1271,7 @@ void listSaves_draw(void)
         g_Game.saveLanguage = g_Saves[g_Game.listSavesCursorOffset].language;
         g_Game.saveDate = g_Saves[g_Game.listSavesCursorOffset].date;
         g_Game.saveFileSize = g_Saves[g_Game.listSavesCursorOffset].datasize;
+        g_Game.saveStatus = g_Saves[g_Game.listSavesCursorOffset].status;
 
         jo_printf(g_Game.cursorPosX, g_Game.cursorPosY + g_Game.listSavesCursorOffset % MAX_SAVES_PER_PAGE, ">>");
     }
@@ -1008,6 +1303,19 @@ void listSaves_input(void)
                 return;
             }
 
+            // start copies the selected saves
+            if(jo_is_pad1_key_pressed(JO_KEY_START) && g_Game.numSelectedSaves > 0)
+            {
+                transitionToState(STATE_BATCH_SELECT);
+                return;
+            }
+
+            if(g_Saves[g_Game.listSavesCursorOffset].directory)
+            {
+                changeListDirectory(g_Saves[g_Game.listSavesCursorOffset].filename);
+                return;
+            }
+
             transitionToState(STATE_DISPLAY_SAVE);
             return;
         }
@@ -1017,11 +1325,127 @@ void listSaves_input(void)
         g_Game.input.pressedStartAC = false;
     }
 
+    // X selects the save under the cursor
+    if(jo_is_pad1_key_pressed(JO_KEY_X))
+    {
+        if(g_Game.input.pressedX == false && g_Game.numSaves > 0 && g_Saves[g_Game.listSavesCursorOffset].directory == false)
+        {
+            int i = g_Game.listSavesCursorOffset;
+
+            g_Game.selectedSaves[i] = !g_Game.selectedSaves[i];
+            g_Game.numSelectedSaves += g_Game.selectedSaves[i] ? 1 : -1;
+        }
+        g_Game.input.pressedX = true;
+    }
+    else
+    {
+        g_Game.input.pressedX = false;
+    }
+
+    // Y selects all saves, or clears the selection if they are all selected
+    if(jo_is_pad1_key_pressed(JO_KEY_Y))
+    {
+        if(g_Game.input.pressedY == false && g_Game.numSaves > 0)
+        {
+            unsigned int numSaves = 0;
+            bool select = false;
+
+            // subdirectories can't be selected
+            for(int i = 0; i < g_Game.numSaves; i++)
+            {
+                numSaves += g_Saves[i].directory ? 0 : 1;
+            }
+
+            select = g_Game.numSelectedSaves != numSaves;
+
+            for(int i = 0; i < g_Game.numSaves; i++)
+            {
+                g_Game.selectedSaves[i] = select && g_Saves[i].directory == false;
+            }
+            g_Game.numSelectedSaves = select ? numSaves : 0;
+        }
+        g_Game.input.pressedY = true;
+    }
+    else
+    {
+        g_Game.input.pressedY = false;
+    }
+
+    // L/R jump to the previous/next first letter
+    if(jo_is_pad1_key_pressed(JO_KEY_L))
+    {
+        if(g_Game.input.pressedLT == false && g_Game.numSaves > 0)
+        {
+            jumpToSave(searchNextCharacter(&g_Search, g_Game.listSavesCursorOffset, -1));
+        }
+        g_Game.input.pressedLT = true;
+    }
+    else
+    {
+        g_Game.input.pressedLT = false;
+    }
+
+    if(jo_is_pad1_key_pressed(JO_KEY_R))
+    {
+        if(g_Game.input.pressedRT == false && g_Game.numSaves > 0)
+        {
+            jumpToSave(searchNextCharacter(&g_Search, g_Game.listSavesCursorOffset, 1));
+        }
+        g_Game.input.pressedRT = true;
+    }
+    else
+    {
+        g_Game.input.pressedRT = false;
+    }
+
+#ifdef JO_COMPILE_WITH_KEYBOARD_SUPPORT
+    // typing on the keyboard jumps to the first save starting with the typed prefix
+    {
+        char c = jo_keyboard_get_char();
+
+        if(c != g_Game.input.keyboardChar && g_Game.numSaves > 0)
+        {
+            unsigned int length = strlen(g_Game.searchPrefix);
+
+            if(c == '\b' || jo_keyboard_get_special_key() == JO_KEYBOARD_BACKSPACE)
+            {
+                if(length > 0)
+                {
+                    g_Game.searchPrefix[length - 1] = '\0';
+                }
+            }
+            else if(c > ' ' && c <= '~' && length < MAX_SAVE_FILENAME - 1)
+            {
+                // save names are upper case
+                if(c >= 'a' && c <= 'z')
+                {
+                    c -= 'a' - 'A';
+                }
+
+                g_Game.searchPrefix[length] = c;
+                g_Game.searchPrefix[length + 1] = '\0';
+            }
+
+            jumpToSave(searchPrefix(&g_Search, g_Game.searchPrefix));
+        }
+
+        g_Game.input.keyboardChar = c;
+    }
+#endif // JO_COMPILE_WITH_KEYBOARD_SUPPORT
+
     if(jo_is_pad1_key_pressed(JO_KEY_B))
     {
         if(g_Game.input.pressedB == false)
         {
             g_Game.input.pressedB = true;
+
+            // B leaves the subdirectory before leaving the device
+            if(getSaveDirectory(g_Game.backupDevice)[0] != '\0')
+            {
+                changeListDirectory(JO_PARENT_DIR);
+                return;
+            }
+
             transitionToState(STATE_PREVIOUS);
             return;
         }
@@ -1078,10 +1502,7 @@ void displaySave_draw(void)
         if(g_Game.state == STATE_DISPLAY_SAVE)
         {
 
-            if(g_Game.backupDevice == JoInternalMemoryBackup ||
-                g_Game.backupDevice == JoCartridgeMemoryBackup ||
-                g_Game.backupDevice == JoExternalDeviceBackup ||
-                g_Game.backupDevice == ActionReplayBackup )
+            if(hasBackupDeviceCapability(g_Game.backupDevice, BACKUP_CAP_SAVE_NAME))
             {
                 // BUGBUG: sloppy bug fix. saveFilename includes the .BUP header which internal devices don't used
                 // Jo Engine was ignoring the ".BUP" if the filename was too long
@@ -1098,6 +1519,14 @@ void displaySave_draw(void)
                 transitionToState(STATE_PREVIOUS);
                 return;
             }
+
+            // the header read from the device may be worse than what the listing reported
+            // VCD card firmware is raw data without a .BUP header
+            if(hasBackupDeviceCapability(g_Game.backupDevice, BACKUP_CAP_BUP_HEADER))
+            {
+                result = validateBupHeader(g_Game.saveBupHeader, g_Game.saveFileSize + sizeof(BUP_HEADER));
+                g_Game.saveStatus = MAX(g_Game.saveStatus, (unsigned char)result);
+            }
         }
 
         // print messages to the user so that can get an estimate of the time for longer operations
@@ -1109,13 +1538,20 @@ void displaySave_draw(void)
             return;
         }
 
-        result = getBackupDeviceName(g_Game.backupDevice, &g_Game.backupDeviceName);
-        if(result != 0)
+        if(g_Game.state == STATE_DISPLAY_SAVE)
         {
-            transitionToState(STATE_PREVIOUS);
-            return;
-        }
-
+            result = getBackupDeviceName(g_Game.backupDevice, &g_Game.backupDeviceName);
+            if(result != 0)
+            {
+                transitionToState(STATE_PREVIOUS);
+                return;
+            }
+        }
+        else
+        {
+            g_Game.backupDeviceName = "Memory";
+        }
+
         g_Game.md5Calculated = true;
     }
 
@@ -1129,6 +1565,11 @@ void displaySave_draw(void)
     jo_printf(OPTIONS_X, OPTIONS_Y + y++, "Save Name: %s        ", g_Game.saveName);
     jo_printf(OPTIONS_X, OPTIONS_Y + y++, "Comment: %s         ", g_Game.saveComment);
     jo_printf(OPTIONS_X, OPTIONS_Y + y++, "Date: %d/%d/%d %02d:%02d         ", jo_date.month, jo_date.day, jo_date.year + 1980, jo_date.time, jo_date.min);
+    if(g_Game.state == STATE_DISPLAY_SAVE)
+    {
+        jo_printf(OPTIONS_X, OPTIONS_Y + y, "Status: %s        ", getSaveStatusString(g_Game.saveStatus));
+    }
+    y++;
     y++;
 
     jo_printf(OPTIONS_X, OPTIONS_Y + y++, "Size: %d            ", g_Game.saveFileSize);
@@ -1149,6 +1590,22 @@ void displaySave_draw(void)
 
     y++;
 
+    // advance the copy started by displaySave_input()
+    if(g_Game.copyInProgress == true)
+    {
+        result = copyStep(&g_Copy);
+        if(result > 0)
+        {
+            jo_printf(OPTIONS_X, SAVES_Y + y + 1, "Copying... %3d%% %4dKB/s         ", copyProgress(&g_Copy), copyThroughput(&g_Copy) / 1024);
+            return;
+        }
+
+        result = copyEnd(&g_Copy);
+        g_Game.copyInProgress = false;
+        g_Game.operationStatus = (result == 0) ? OPERATION_SUCCESS : OPERATION_FAIL;
+        jo_printf(OPTIONS_X, SAVES_Y + y + 1, "                                  ");
+    }
+
     // done formatting
     if(g_Game.operationStatus == OPERATION_SUCCESS)
     {
@@ -1166,10 +1623,34 @@ void displaySave_draw(void)
         y++;
         jo_printf(OPTIONS_X, SAVES_Y + y++, "Failed to perform operation.     ");
     }
+    else if(g_Game.operationStatus == OPERATION_FAIL_CORRUPT)
+    {
+        y++;
+        jo_printf(OPTIONS_X, SAVES_Y + y++, "Save is corrupt, not copied.     ");
+    }
 
     return;
 }
 
+// starts copying the save to the target device
+// the copy is advanced a chunk at a time by displaySave_draw()
+int startSaveCopy(int targetDevice, char* filename, unsigned char* saveFileData, unsigned int saveFileSize)
+{
+    int result = 0;
+
+    g_Game.operationStatus = OPERATION_UNINIT;
+
+    result = copyStartFromMemory(&g_Copy, saveFileData, saveFileSize, targetDevice, filename);
+    if(result != 0)
+    {
+        g_Game.operationStatus = OPERATION_FAIL;
+        return result;
+    }
+
+    g_Game.copyInProgress = true;
+    return 0;
+}
+
 // handles input on the display saves and display memory screen
 // B returns to the main menu
 void displaySave_input(void)
@@ -1184,6 +1665,12 @@ void displaySave_input(void)
         return;
     }
 
+    // displaySave_draw() advances the copy, wait for it to finish
+    if(g_Game.copyInProgress == true)
+    {
+        return;
+    }
+
     if(g_Game.state == STATE_DISPLAY_SAVE)
     {
         saveFileData = (unsigned char*)g_Game.saveBupHeader;
@@ -1206,86 +1693,56 @@ void displaySave_input(void)
             {
                 option = getMenuOptionByIndex(g_Game.cursorOffset);
 
+                // reject corrupt saves before starting a potentially long transfer
+                if(g_Game.state == STATE_DISPLAY_SAVE && g_Game.saveStatus == SAVE_STATUS_CORRUPT)
+                {
+                    if(option != SAVE_OPTION_DELETE && option != SAVE_OPTION_BACK)
+                    {
+                        g_Game.operationStatus = OPERATION_FAIL_CORRUPT;
+                        return;
+                    }
+                }
+
                 switch(option)
                 {
                     case SAVE_OPTION_INTERNAL:
                     {
-                        result = writeSaveFile(JoInternalMemoryBackup, g_Game.saveName, saveFileData, saveFileSize);
-                        if(result != 0)
-                        {
-                            g_Game.operationStatus = OPERATION_FAIL;
-                            return;
-                        }
-                        g_Game.operationStatus = OPERATION_SUCCESS;
+                        startSaveCopy(JoInternalMemoryBackup, g_Game.saveName, saveFileData, saveFileSize);
                         return;
                     }
                     case SAVE_OPTION_CARTRIDGE:
                     {
-                        result = writeSaveFile(JoCartridgeMemoryBackup, g_Game.saveName, saveFileData, saveFileSize);
-                        if(result != 0)
-                        {
-                            g_Game.operationStatus = OPERATION_FAIL;
-                            return;
-                        }
-                        g_Game.operationStatus = OPERATION_SUCCESS;
+                        startSaveCopy(JoCartridgeMemoryBackup, g_Game.saveName, saveFileData, saveFileSize);
                         return;
                     }
                     case SAVE_OPTION_EXTERNAL:
                     {
-                        result = writeSaveFile(JoExternalDeviceBackup, g_Game.saveName, saveFileData, saveFileSize);
-                        if(result != 0)
-                        {
-                            g_Game.operationStatus = OPERATION_FAIL;
-                            return;
-                        }
-                        g_Game.operationStatus = OPERATION_SUCCESS;
+                        startSaveCopy(JoExternalDeviceBackup, g_Game.saveName, saveFileData, saveFileSize);
                         return;
                     }
                     case SAVE_OPTION_SATIATOR:
                     {
-                        result = writeSaveFile(SatiatorBackup, g_Game.saveFilename, saveFileData, saveFileSize);
-                        if(result != 0)
-                        {
-                            g_Game.operationStatus = OPERATION_FAIL;
-                            return;
-                        }
-                        g_Game.operationStatus = OPERATION_SUCCESS;
+                        startSaveCopy(SatiatorBackup, g_Game.saveFilename, saveFileData, saveFileSize);
                         return;
                     }
                     case SAVE_OPTION_MODE:
                     {
-                        jo_printf(OPTIONS_X, SAVES_Y + g_Game.numMenuOptions + 2, "Operation in progress....        ");
-                        result = writeSaveFile(MODEBackup, g_Game.saveFilename, saveFileData, saveFileSize);
-                        if (result != 0)
-                        {
-                            g_Game.operationStatus = OPERATION_FAIL;
-                            return;
-                        }
-                        g_Game.operationStatus = OPERATION_SUCCESS;
+                        startSaveCopy(MODEBackup, g_Game.saveFilename, saveFileData, saveFileSize);
                         return;
                     }
                     case SAVE_OPTION_SERIAL:
                     {
-                        jo_printf(OPTIONS_X, SAVES_Y + g_Game.numMenuOptions + 2, "Operation in progress....        ");
-                        result = writeSaveFile(SerialBackup, g_Game.saveFilename, saveFileData, saveFileSize);
-                        if (result != 0)
-                        {
-                            g_Game.operationStatus = OPERATION_FAIL;
-                            return;
-                        }
-                        g_Game.operationStatus = OPERATION_SUCCESS;
+                        startSaveCopy(SerialBackup, g_Game.saveFilename, saveFileData, saveFileSize);
                         return;
                     }
                     case SAVE_OPTION_MODEM:
                     {
-                        jo_printf(OPTIONS_X, SAVES_Y + g_Game.numMenuOptions + 2, "Operation in progress....        ");
-                        result = writeSaveFile(ModemBackup, g_Game.saveFilename, saveFileData, saveFileSize);
-                        if (result != 0)
-                        {
-                            g_Game.operationStatus = OPERATION_FAIL;
-                            return;
-                        }
-                        g_Game.operationStatus = OPERATION_SUCCESS;
+                        startSaveCopy(ModemBackup, g_Game.saveFilename, saveFileData, saveFileSize);
+                        return;
+                    }
+                    case SAVE_OPTION_RAM_DISK:
+                    {
+                        startSaveCopy(MemoryBackup, g_Game.saveFilename, saveFileData, saveFileSize);
                         return;
                     }
                     case SAVE_OPTION_WRITE_MEMORY:
@@ -1417,6 +1874,12 @@ void format_input(void)
                     transitionToState(STATE_FORMAT_VERIFY);
                     return;
                 }
+                case MAIN_OPTION_RAM_DISK:
+                {
+                    g_Game.backupDevice = MemoryBackup;
+                    transitionToState(STATE_FORMAT_VERIFY);
+                    return;
+                }
             }
         }
     }
@@ -2003,3 +2466,589 @@ void credits_input(void)
     return;
 }
 
+
+// draws the verify device select screen
+// the source device is selected first followed by the target device
+void verifySelect_draw(void)
+{
+    unsigned int y = 0;
+
+    if(g_Game.state != STATE_VERIFY_SELECT)
+    {
+        return;
+    }
+
+    // heading
+    jo_printf(HEADING_X, HEADING_Y + y++, "Verify Saves");
+    jo_printf(HEADING_X, HEADING_Y + y++, HEADING_UNDERSCORE);
+
+    if(g_Game.verifySourceDevice < 0)
+    {
+        jo_printf(OPTIONS_X, OPTIONS_Y, "Select the source device:");
+    }
+    else
+    {
+        jo_printf(OPTIONS_X, OPTIONS_Y, "Select the target device:");
+    }
+
+    // options
+    for(unsigned int i = 0; i < g_Game.numMenuOptions; i++)
+    {
+        jo_printf(OPTIONS_X, OPTIONS_Y + 1 + i, g_Game.menuOptions[i].optionText);
+    }
+
+    // cursor
+    jo_printf(g_Game.cursorPosX, g_Game.cursorPosY + g_Game.cursorOffset, ">>");
+
+    return;
+}
+
+// handles input on the verify device select screen
+void verifySelect_input(void)
+{
+    unsigned int option = 0;
+
+    if(g_Game.state != STATE_VERIFY_SELECT)
+    {
+        return;
+    }
+
+    // did the player hit start
+    if(jo_is_pad1_key_pressed(JO_KEY_START) ||
+        jo_is_pad1_key_pressed(JO_KEY_A) ||
+        jo_is_pad1_key_pressed(JO_KEY_C))
+    {
+        if(g_Game.input.pressedStartAC == false)
+        {
+            g_Game.input.pressedStartAC = true;
+
+            if(g_Game.numStateOptions == 0)
+            {
+                // nothing to verify against
+                transitionToState(STATE_PREVIOUS);
+                return;
+            }
+
+            option = getMenuOptionByIndex(g_Game.cursorOffset);
+
+            if(g_Game.verifySourceDevice < 0)
+            {
+                // source selected, rebuild the menu without it
+                g_Game.verifySourceDevice = option;
+                g_Game.cursorOffset = 0;
+                g_Game.numStateOptions = initMenuOptions(STATE_VERIFY_SELECT);
+                clearScreen();
+                return;
+            }
+
+            g_Game.verifyTargetDevice = option;
+            transitionToState(STATE_VERIFY);
+            return;
+        }
+    }
+    else
+    {
+        g_Game.input.pressedStartAC = false;
+    }
+
+    // did the player hit B
+    if(jo_is_pad1_key_pressed(JO_KEY_B))
+    {
+        if(g_Game.input.pressedB == false)
+        {
+            g_Game.input.pressedB = true;
+
+            if(g_Game.verifySourceDevice >= 0)
+            {
+                // back to selecting the source
+                g_Game.verifySourceDevice = -1;
+                g_Game.cursorOffset = 0;
+                g_Game.numStateOptions = initMenuOptions(STATE_VERIFY_SELECT);
+                clearScreen();
+                return;
+            }
+
+            transitionToState(STATE_PREVIOUS);
+            return;
+        }
+    }
+    else
+    {
+        g_Game.input.pressedB = false;
+    }
+
+    // update the cursor
+    moveCursor(&g_Game.cursorOffset, false);
+    return;
+}
+
+// draws the verify saves screen
+// verifies one save per frame so the progress is visible to the user
+void verify_draw(void)
+{
+    char* sourceDeviceName = NULL;
+    char* targetDeviceName = NULL;
+    int result = 0;
+    int i = 0;
+    int j = 0;
+
+    if(g_Game.state != STATE_VERIFY)
+    {
+        return;
+    }
+
+    // heading
+    jo_printf(HEADING_X, HEADING_Y, "Verify Saves");
+    jo_printf(HEADING_X, HEADING_Y + 1, HEADING_UNDERSCORE);
+
+    result = getBackupDeviceName(g_Game.verifySourceDevice, &sourceDeviceName);
+    result |= getBackupDeviceName(g_Game.verifyTargetDevice, &targetDeviceName);
+    if(result != 0)
+    {
+        transitionToState(STATE_PREVIOUS);
+        return;
+    }
+
+    jo_printf(OPTIONS_X, OPTIONS_Y, "Source: %s", sourceDeviceName);
+    jo_printf(OPTIONS_X, OPTIONS_Y + 1, "Target: %s", targetDeviceName);
+
+    if(g_Game.verifyStarted == false)
+    {
+        jo_printf(OPTIONS_X, OPTIONS_Y + 3, "Reading saves, please wait...");
+
+        g_Game.verifyStarted = true;
+
+        result = verifyStart(&g_Verify, g_Game.verifySourceDevice, g_Game.verifyTargetDevice, (unsigned char*)g_Game.saveBupHeader, sizeof(BUP_HEADER) + MAX_SAVE_SIZE);
+        if(result != 0)
+        {
+            sgc_core_error("Failed to list saves %d", result);
+            transitionToState(STATE_PREVIOUS);
+            return;
+        }
+    }
+
+    if(g_Verify.done == false)
+    {
+        result = verifyStep(&g_Verify);
+        if(result < 0)
+        {
+            sgc_core_error("Failed to verify saves %d", result);
+            transitionToState(STATE_PREVIOUS);
+            return;
+        }
+
+        jo_printf(OPTIONS_X, OPTIONS_Y + 3, "Verifying, checked %d of %d...   ", g_Verify.numResults, MAX(g_Verify.numSourceSaves, g_Verify.numTargetSaves));
+        return;
+    }
+
+    // diff report
+    jo_printf(OPTIONS_X, OPTIONS_Y + 3, "Identical: %-4d  Mismatched: %-4d  ", g_Verify.numIdentical, g_Verify.numMismatched);
+    jo_printf(OPTIONS_X, OPTIONS_Y + 4, "Missing:   %-4d  Errors:     %-4d  ", g_Verify.numMissing, g_Verify.numErrors);
+
+    g_Game.numStateOptions = g_Verify.numResults;
+    if(g_Game.numStateOptions == 0)
+    {
+        jo_printf(OPTIONS_X, VERIFY_RESULTS_Y, "Found 0 saves on the devices");
+        return;
+    }
+
+    jo_printf(OPTIONS_X, VERIFY_RESULTS_Y, "%-11s  %-14s", "Save Name", "Result");
+
+    // zero out the result print fields otherwise we will have stale data on the screen
+    for(i = 0; i < MAX_SAVES_PER_PAGE; i++)
+    {
+        jo_printf(OPTIONS_X, VERIFY_RESULTS_Y + i + 1, "                                      ");
+    }
+
+    // print up to MAX_SAVES_PER_PAGE results on the screen
+    for(i = (g_Game.cursorOffset / MAX_SAVES_PER_PAGE) * MAX_SAVES_PER_PAGE, j = 0; i < (int)g_Verify.numResults && j < MAX_SAVES_PER_PAGE; i++, j++)
+    {
+        jo_printf(OPTIONS_X, VERIFY_RESULTS_Y + (i % MAX_SAVES_PER_PAGE) + 1, "%-11s  %-14s", g_Verify.results[i].name, verifyStatusString(g_Verify.results[i].status));
+    }
+
+    jo_printf(g_Game.cursorPosX, g_Game.cursorPosY + g_Game.cursorOffset % MAX_SAVES_PER_PAGE, ">>");
+
+    return;
+}
+
+// handles input on the verify saves screen
+// B returns to the previous screen
+void verify_input(void)
+{
+    if(g_Game.state != STATE_VERIFY)
+    {
+        return;
+    }
+
+    if(jo_is_pad1_key_pressed(JO_KEY_B))
+    {
+        if(g_Game.input.pressedB == false)
+        {
+            g_Game.input.pressedB = true;
+            verifyEnd(&g_Verify);
+            transitionToState(STATE_PREVIOUS);
+            return;
+        }
+    }
+    else
+    {
+        g_Game.input.pressedB = false;
+    }
+
+    // update the cursor
+    moveCursor(&g_Game.cursorOffset, true);
+    return;
+}
+
+// draws the batch copy target device select screen
+void batchSelect_draw(void)
+{
+    unsigned int y = 0;
+
+    if(g_Game.state != STATE_BATCH_SELECT)
+    {
+        return;
+    }
+
+    // heading
+    jo_printf(HEADING_X, HEADING_Y + y++, "Copy Selected Saves");
+    jo_printf(HEADING_X, HEADING_Y + y++, HEADING_UNDERSCORE);
+
+    jo_printf(OPTIONS_X, OPTIONS_Y, "Copy %d saves to:", g_Game.numSelectedSaves);
+
+    // options
+    for(unsigned int i = 0; i < g_Game.numMenuOptions; i++)
+    {
+        jo_printf(OPTIONS_X, OPTIONS_Y + 1 + i, g_Game.menuOptions[i].optionText);
+    }
+
+    // cursor
+    jo_printf(g_Game.cursorPosX, g_Game.cursorPosY + g_Game.cursorOffset, ">>");
+
+    return;
+}
+
+// handles input on the batch copy target device select screen
+void batchSelect_input(void)
+{
+    if(g_Game.state != STATE_BATCH_SELECT)
+    {
+        return;
+    }
+
+    // did the player hit start
+    if(jo_is_pad1_key_pressed(JO_KEY_START) ||
+        jo_is_pad1_key_pressed(JO_KEY_A) ||
+        jo_is_pad1_key_pressed(JO_KEY_C))
+    {
+        if(g_Game.input.pressedStartAC == false)
+        {
+            g_Game.input.pressedStartAC = true;
+
+            if(g_Game.numStateOptions == 0)
+            {
+                // nowhere to copy to
+                transitionToState(STATE_PREVIOUS);
+                return;
+            }
+
+            g_Game.batchTargetDevice = getMenuOptionByIndex(g_Game.cursorOffset);
+            transitionToState(STATE_BATCH);
+            return;
+        }
+    }
+    else
+    {
+        g_Game.input.pressedStartAC = false;
+    }
+
+    // did the player hit B
+    if(jo_is_pad1_key_pressed(JO_KEY_B))
+    {
+        if(g_Game.input.pressedB == false)
+        {
+            g_Game.input.pressedB = true;
+
+            transitionToState(STATE_PREVIOUS);
+            return;
+        }
+    }
+    else
+    {
+        g_Game.input.pressedB = false;
+    }
+
+    // update the cursor
+    moveCursor(&g_Game.cursorOffset, false);
+    return;
+}
+
+// draws the batch copy screen
+// copies a frame's worth of the queue at a time so the progress is visible to the user
+void batch_draw(void)
+{
+    char* sourceDeviceName = NULL;
+    char* targetDeviceName = NULL;
+    int result = 0;
+    int i = 0;
+    int j = 0;
+
+    if(g_Game.state != STATE_BATCH)
+    {
+        return;
+    }
+
+    // heading
+    jo_printf(HEADING_X, HEADING_Y, "Copy Selected Saves");
+    jo_printf(HEADING_X, HEADING_Y + 1, HEADING_UNDERSCORE);
+
+    result = getBackupDeviceName(g_Game.backupDevice, &sourceDeviceName);
+    result |= getBackupDeviceName(g_Game.batchTargetDevice, &targetDeviceName);
+    if(result != 0)
+    {
+        transitionToState(STATE_PREVIOUS);
+        return;
+    }
+
+    jo_printf(OPTIONS_X, OPTIONS_Y, "Source: %s", sourceDeviceName);
+    jo_printf(OPTIONS_X, OPTIONS_Y + 1, "Target: %s", targetDeviceName);
+
+    if(g_Game.batchStarted == false)
+    {
+        g_Game.batchStarted = true;
+
+        // the display save buffer isn't in use, stage saves in it
+        result = batchStart(&g_Batch, (unsigned char*)g_Game.saveBupHeader, sizeof(BUP_HEADER) + MAX_SAVE_SIZE);
+        if(result != 0)
+        {
+            transitionToState(STATE_PREVIOUS);
+            return;
+        }
+
+        for(i = 0; i < g_Game.numSaves; i++)
+        {
+            if(g_Game.selectedSaves[i] == true)
+            {
+                batchAdd(&g_Batch, g_Game.backupDevice, &g_Saves[i], g_Game.batchTargetDevice);
+            }
+        }
+    }
+
+    if(g_Batch.done == false)
+    {
+        result = batchStep(&g_Batch);
+        if(result < 0)
+        {
+            sgc_core_error("Failed to copy saves %d", result);
+            transitionToState(STATE_PREVIOUS);
+            return;
+        }
+
+        if(g_Batch.copying == true)
+        {
+            jo_printf(OPTIONS_X, OPTIONS_Y + 3, "Copying %d of %d: %-11s     ", g_Batch.current + 1, g_Batch.numItems, g_Batch.items[g_Batch.current].name);
+            jo_printf(OPTIONS_X, OPTIONS_Y + 4, "%3d%% %4dKB/s                 ", copyProgress(&g_Batch.copy), copyThroughput(&g_Batch.copy) / 1024);
+        }
+        return;
+    }
+
+    // copy report
+    jo_printf(OPTIONS_X, OPTIONS_Y + 3, "Copied: %-4d Failed: %-4d Corrupt: %-4d", g_Batch.numCopied, g_Batch.numFailed, g_Batch.numSkipped);
+    jo_printf(OPTIONS_X, OPTIONS_Y + 4, "%dKB in %ds, %dKB/s                ", g_Batch.bytesCopied / 1024, g_Batch.elapsedTicks / 1000, batchThroughput(g_Batch.bytesCopied, g_Batch.elapsedTicks) / 1024);
+
+    g_Game.numStateOptions = g_Batch.numItems;
+    if(g_Game.numStateOptions == 0)
+    {
+        return;
+    }
+
+    jo_printf(OPTIONS_X, VERIFY_RESULTS_Y, "%-11s  %-8s  %6s", "Save Name", "Result", "KB/s");
+
+    // zero out the result print fields otherwise we will have stale data on the screen
+    for(i = 0; i < MAX_SAVES_PER_PAGE; i++)
+    {
+        jo_printf(OPTIONS_X, VERIFY_RESULTS_Y + i + 1, "                                      ");
+    }
+
+    // print up to MAX_SAVES_PER_PAGE results on the screen
+    for(i = (g_Game.cursorOffset / MAX_SAVES_PER_PAGE) * MAX_SAVES_PER_PAGE, j = 0; i < (int)g_Batch.numItems && j < MAX_SAVES_PER_PAGE; i++, j++)
+    {
+        PBATCH_ITEM item = &g_Batch.items[i];
+
+        jo_printf(OPTIONS_X, VERIFY_RESULTS_Y + (i % MAX_SAVES_PER_PAGE) + 1, "%-11s  %-8s  %6d", item->name, batchStatusString(item->status), batchThroughput(item->size, item->ticks) / 1024);
+    }
+
+    jo_printf(g_Game.cursorPosX, g_Game.cursorPosY + g_Game.cursorOffset % MAX_SAVES_PER_PAGE, ">>");
+
+    return;
+}
+
+// handles input on the batch copy screen
+// B returns to the previous screen once the copy is done
+void batch_input(void)
+{
+    if(g_Game.state != STATE_BATCH)
+    {
+        return;
+    }
+
+    // don't leave a save half written
+    if(g_Batch.done == false)
+    {
+        return;
+    }
+
+    if(jo_is_pad1_key_pressed(JO_KEY_B))
+    {
+        if(g_Game.input.pressedB == false)
+        {
+            g_Game.input.pressedB = true;
+            batchEnd(&g_Batch);
+            transitionToState(STATE_PREVIOUS);
+            return;
+        }
+    }
+    else
+    {
+        g_Game.input.pressedB = false;
+    }
+
+    // update the cursor
+    moveCursor(&g_Game.cursorOffset, true);
+    return;
+}
+
+// draws the transfer stats screen
+// the most recent backend operations are listed first
+void stats_draw(void)
+{
+    unsigned int totalTicks = 0;
+    unsigned int totalBytes = 0;
+    unsigned int totalSwitches = 0;
+    unsigned int totalSwitchTicks = 0;
+    unsigned int count = 0;
+    int i = 0;
+    int j = 0;
+
+    if(g_Game.state != STATE_STATS)
+    {
+        return;
+    }
+
+    // heading
+    jo_printf(HEADING_X, HEADING_Y, "Transfer Stats");
+    jo_printf(HEADING_X, HEADING_Y + 1, HEADING_UNDERSCORE);
+
+    count = statsGetCount();
+    g_Game.numStateOptions = count;
+
+    for(unsigned int k = 0; k < count; k++)
+    {
+        PSTATS_RECORD record = statsGetRecord(k);
+
+        if(record->operation != STATS_OP_LIST)
+        {
+            totalBytes += record->bytes;
+        }
+        totalTicks += record->ticks;
+        totalSwitches += record->switches;
+        totalSwitchTicks += record->switchTicks;
+    }
+
+    jo_printf(OPTIONS_X, OPTIONS_Y, "Operations: %-4d Time: %dms       ", count, totalTicks);
+    jo_printf(OPTIONS_X, OPTIONS_Y + 1, "Moved: %dKB                       ", totalBytes / 1024);
+    jo_printf(OPTIONS_X, OPTIONS_Y + 2, "Switches: %-4d Switching: %dms    ", totalSwitches, totalSwitchTicks);
+    jo_printf(OPTIONS_X, OPTIONS_Y + 3, "Start to export as STATS.CSV");
+
+    if(count == 0)
+    {
+        return;
+    }
+
+    jo_printf(OPTIONS_X, VERIFY_RESULTS_Y, "%-6s %-8s %5s %6s %2s %2s", "Op", "Device", "ms", "Bytes", "Rt", "Sw");
+
+    // zero out the result print fields otherwise we will have stale data on the screen
+    for(i = 0; i < MAX_SAVES_PER_PAGE; i++)
+    {
+        jo_printf(OPTIONS_X, VERIFY_RESULTS_Y + i + 1, "                                      ");
+    }
+
+    // print up to MAX_SAVES_PER_PAGE records on the screen
+    for(i = (g_Game.cursorOffset / MAX_SAVES_PER_PAGE) * MAX_SAVES_PER_PAGE, j = 0; i < (int)count && j < MAX_SAVES_PER_PAGE; i++, j++)
+    {
+        PSTATS_RECORD record = statsGetRecord(count - 1 - i);
+        char* deviceName = NULL;
+
+        getBackupDeviceName(record->backupDevice, &deviceName);
+
+        jo_printf(OPTIONS_X, VERIFY_RESULTS_Y + (i % MAX_SAVES_PER_PAGE) + 1, "%-6s %-8.8s %5d %6d %2d %2d%c",
+            statsOperationString(record->operation), deviceName, record->ticks, record->bytes,
+            MIN(record->retries, 99), MIN(record->switches, 99), record->result != 0 ? '!' : ' ');
+    }
+
+    jo_printf(g_Game.cursorPosX, g_Game.cursorPosY + g_Game.cursorOffset % MAX_SAVES_PER_PAGE, ">>");
+
+    return;
+}
+
+// handles input on the transfer stats screen
+// start exports the stats as a memory dump so they can be copied to a device
+void stats_input(void)
+{
+    if(g_Game.state != STATE_STATS)
+    {
+        return;
+    }
+
+    if(jo_is_pad1_key_pressed(JO_KEY_START) ||
+        jo_is_pad1_key_pressed(JO_KEY_A) ||
+        jo_is_pad1_key_pressed(JO_KEY_C))
+    {
+        if(g_Game.input.pressedStartAC == false)
+        {
+            unsigned int length = 0;
+
+            g_Game.input.pressedStartAC = true;
+
+            // snapshot the stats, copying them adds more records
+            length = statsExport(g_StatsExport, sizeof(g_StatsExport));
+            if(length == 0)
+            {
+                return;
+            }
+
+            g_Game.dumpMemoryAddress = (unsigned int)g_StatsExport;
+            g_Game.dumpMemorySize = length;
+            g_Game.saveFileSize = length;
+            g_Game.saveDate = 0;
+            strcpy(g_Game.saveFilename, "STATS.CSV");
+            strcpy(g_Game.saveName, "SGC_STATS");
+            strcpy(g_Game.saveComment, "Stats");
+
+            transitionToState(STATE_DISPLAY_MEMORY);
+            return;
+        }
+    }
+    else
+    {
+        g_Game.input.pressedStartAC = false;
+    }
+
+    if(jo_is_pad1_key_pressed(JO_KEY_B))
+    {
+        if(g_Game.input.pressedB == false)
+        {
+            g_Game.input.pressedB = true;
+            transitionToState(STATE_PREVIOUS);
+            return;
+        }
+    }
+    else
+    {
+        g_Game.input.pressedB = false;
+    }
+
+    // update the cursor
+    moveCursor(&g_Game.cursorOffset, true);
+    return;
+}
@@ -29,6 +29,7 @@
 */
 #pragma once
 #include "bup_header.h"
+#include "util.h" // MD5_HASH_SIZE
 
 // program version, keep this length to avoid having to resize strings
 #define VERSION "3.7.1"
@@ -45,6 +46,11 @@
 #define STATE_FORMAT_VERIFY      8
 #define STATE_COLLECT            9
 #define STATE_CREDITS            10
+#define STATE_VERIFY_SELECT      11
+#define STATE_VERIFY             12
+#define STATE_BATCH_SELECT       13
+#define STATE_BATCH              14
+#define STATE_STATS              15
 #define STATE_PREVIOUS          -1 // go to the previous state
 
 #define MAX_STATES              16 // how many states to record
@@ -67,6 +73,9 @@
 #define MAIN_OPTION_ACTION_REPLAY 14
 #define MAIN_OPTION_SERIAL        15
 #define MAIN_OPTION_MODEM         16
+#define MAIN_OPTION_VERIFY        17
+#define MAIN_OPTION_STATS         18
+#define MAIN_OPTION_RAM_DISK      19
 
 
 #define SAVE_OPTION_INTERNAL     0
@@ -79,6 +88,7 @@
 #define SAVE_OPTION_SERIAL       7
 #define SAVE_OPTION_MODEM        8
 #define SAVE_OPTION_BACK         9
+#define SAVE_OPTION_RAM_DISK     10
 
 #define VERIFY_YES               0
 #define VERIFY_NO                1
@@ -87,6 +97,7 @@
 #define OPERATION_SUCCESS        1
 #define OPERATION_FAIL           2
 #define OPERATION_FAIL_DELETE    3
+#define OPERATION_FAIL_CORRUPT   4
 
 // position of the heading text
 #define HEADING_X                2
@@ -101,6 +112,9 @@
 #define SAVES_X                  HEADING_X + 3
 #define SAVES_Y                  HEADING_Y + 16
 
+#define VERIFY_RESULTS_Y         OPTIONS_Y + 6
+#define SELECTED_Y               OPTIONS_Y + MAX_SAVES_PER_PAGE + 2
+
 #define CURSOR_X                 HEADING_X
 
 #define MAIN_NUM_OPTIONS             10
@@ -120,14 +134,12 @@
                                    // cd - 8.3
                                    // satiator, ode - 255? hopefully most people will keep the save filenames small
 
-#define MD5_HASH_SIZE           16
-
 // set this to 1 to skip device checks at boot. This will show the full menu
 // set to 1 to skip
 // BUGBUG: this should be a compile option,not a #define
 #define SKIP_DEVICE_CHECKS      0
 
-#define MAX_MENU_OPTIONS        20
+#define MAX_MENU_OPTIONS        32 // the main menu lists 20 with every device detected
 
 // records whether or not an input has been pressed that frame
 typedef struct _INPUTCACHE
@@ -140,6 +152,9 @@ typedef struct _INPUTCACHE
     bool pressedStartAC;
     bool pressedLT;
     bool pressedRT;
+    bool pressedX;
+    bool pressedY;
+    char keyboardChar; // last character typed on the Saturn keyboard
 } INPUTCACHE, *PINPUTCACHE;
 
 // dynamic menu options
@@ -185,6 +200,7 @@ typedef struct _GAME
     bool deviceVCDCardBackup;
     bool deviceSerialBackup;
     bool deviceModemBackup;
+    bool deviceRamDiskBackup;
 
     bool listedSaves; // set to true if we already queried the saves from the backup device
 
@@ -197,6 +213,7 @@ typedef struct _GAME
     unsigned char saveLanguage; // selected save language
     unsigned int saveDate; // selected save date;
     unsigned int saveFileSize; // selected save file size
+    unsigned char saveStatus; // selected save SAVE_STATUS_XXX
 
     PBUP_HEADER saveBupHeader; // the bup header. Immediately following is the saveFileData
     unsigned char* saveFileData; // the raw save data
@@ -204,7 +221,21 @@ typedef struct _GAME
     unsigned int dumpMemoryAddress;
     unsigned int dumpMemorySize;
 
+    // devices being compared by the verify screen, -1 if not selected yet
+    int verifySourceDevice;
+    int verifyTargetDevice;
+    bool verifyStarted; // set to true if we already listed the saves on both devices
+
+    // saves selected with X on the list saves screen, indexed like g_Saves
+    bool selectedSaves[MAX_SAVES];
+    unsigned int numSelectedSaves;
+    int batchTargetDevice; // device the selected saves are copied to
+    bool batchStarted; // set to true if we already queued the selected saves
+
+    char searchPrefix[MAX_SAVE_FILENAME]; // typed on the Saturn keyboard to find a save
+
     bool md5Calculated; // set to true if we have calculated the md5 MD5_HASH_SIZE
+    bool copyInProgress; // set to true while the display screen is copying a save
     unsigned char md5Hash[MD5_HASH_SIZE];
 
     // hack to cache controller inputs
@@ -224,9 +255,12 @@ void moveCursor(int* cursorOffset, bool savesPage);
 void moveDigitCursor(void);
 void adjustHexValue(unsigned int* value, unsigned int digit, bool add);
 void queryBackupDevices(void);
+void queryBackupDevices_update(void);
 
 // menu options helpers
+bool addMenuOption(PMENUOPTIONS menuOptions, unsigned int* numOptions, char* optionText, unsigned int option);
 unsigned int initMenuOptions(int newState);
+unsigned int getVerifyDeviceOptions(int excludeDevice, PMENUOPTIONS menuOptions);
 
 // state helper functions
 void transitionToState(int newState);
@@ -241,10 +275,13 @@ void main_input(void);
 // list saves screen
 void listSaves_draw(void);
 void listSaves_input(void);
+void changeListDirectory(char* directory);
+void jumpToSave(int index);
 
 // playing save screen
 void displaySave_draw(void);
 void displaySave_input(void);
+int startSaveCopy(int targetDevice, char* filename, unsigned char* saveFileData, unsigned int saveFileSize);
 
 // dump bios screen
 void dumpBios_draw(void);
@@ -270,6 +307,26 @@ void collect_input(void);
 void credits_draw(void);
 void credits_input(void);
 
+// verify device select screen
+void verifySelect_draw(void);
+void verifySelect_input(void);
+
+// verify saves screen
+void verify_draw(void);
+void verify_input(void);
+
+// batch copy device select screen
+void batchSelect_draw(void);
+void batchSelect_input(void);
+
+// batch copy screen
+void batch_draw(void);
+void batch_input(void);
+
+// transfer stats screen
+void stats_draw(void);
+void stats_input(void);
+
 // debug output
 void debugOutput_draw(void);
 
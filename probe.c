@@ -0,0 +1,100 @@
+// Device probing - detects the backup devices a few at a time from the frame loop
+#include "probe.h"
+
+// clears the probe list
+void probeInit(PPROBE_SCHEDULER scheduler)
+{
+    memset(scheduler, 0, sizeof(PROBE_SCHEDULER));
+}
+
+// queues a device to be probed
+// skipIfFound must be a task added earlier, devices are probed in the order they are added
+// returns the task index on success, negative on error
+int probeAdd(PPROBE_SCHEDULER scheduler, int backupDevice, bool* detected, int skipIfFound)
+{
+    PPROBE_TASK task = NULL;
+
+    if(scheduler == NULL || detected == NULL || scheduler->numTasks >= PROBE_MAX_TASKS)
+    {
+        sgc_core_error("Invalid parameters to probeAdd!!");
+        return -1;
+    }
+
+    if(skipIfFound >= (int)scheduler->numTasks)
+    {
+        sgc_core_error("Probe dependency %d must be added first!!", skipIfFound);
+        return -2;
+    }
+
+    task = &scheduler->tasks[scheduler->numTasks];
+    task->backupDevice = backupDevice;
+    task->detected = detected;
+    task->skipIfFound = skipIfFound;
+    task->status = PROBE_PENDING;
+
+    *detected = false;
+
+    return scheduler->numTasks++;
+}
+
+// probes devices until budgetTicks have passed
+// a probe can't be interrupted so a slow device can still overrun the budget
+// returns the number of devices found by this step, negative on error
+int probeStep(PPROBE_SCHEDULER scheduler, unsigned int budgetTicks)
+{
+    unsigned int frameTicks = 0;
+    unsigned int probed = 0;
+    int found = 0;
+
+    if(scheduler == NULL)
+    {
+        return -1;
+    }
+
+    frameTicks = jo_get_ticks();
+
+    while(scheduler->current < scheduler->numTasks)
+    {
+        PPROBE_TASK task = &scheduler->tasks[scheduler->current];
+        unsigned int startTicks = 0;
+
+        if(task->skipIfFound != PROBE_NO_DEPENDENCY &&
+            scheduler->tasks[task->skipIfFound].status == PROBE_FOUND)
+        {
+            task->status = PROBE_SKIPPED;
+            scheduler->current++;
+            continue;
+        }
+
+        // always probe at least one device so boot makes progress
+        if(probed > 0 && jo_get_ticks() - frameTicks >= budgetTicks)
+        {
+            break;
+        }
+
+        startTicks = jo_get_ticks();
+        *task->detected = isBackupDeviceAvailable(task->backupDevice);
+        task->ticks = jo_get_ticks() - startTicks;
+        probed++;
+
+        if(*task->detected == true)
+        {
+            task->status = PROBE_FOUND;
+            scheduler->numFound++;
+            found++;
+        }
+        else
+        {
+            task->status = PROBE_MISSING;
+        }
+
+        scheduler->current++;
+    }
+
+    if(scheduler->current >= scheduler->numTasks)
+    {
+        scheduler->done = true;
+    }
+
+    return found;
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "backends/backend.h"
+
+//
+// Device probing - detects the backup devices a few at a time from the frame loop
+//
+
+#define PROBE_MAX_TASKS         16
+#define PROBE_FRAME_TICKS       8 // ms of probing per frame, at least one probe always runs
+#define PROBE_NO_DEPENDENCY     -1
+
+// result of probing a device
+#define PROBE_PENDING           0 // not probed yet
+#define PROBE_FOUND             1 // device answered
+#define PROBE_MISSING           2 // device didn't answer
+#define PROBE_SKIPPED           3 // ruled out by another device being found
+
+// a single device to probe
+typedef struct _PROBE_TASK
+{
+    int backupDevice;
+    bool* detected; // set to true when the device is found
+    int skipIfFound; // task that rules this device out when found, or PROBE_NO_DEPENDENCY
+    unsigned char status; // PROBE_XXX
+    unsigned int ticks; // time the probe took
+} PROBE_TASK, *PPROBE_TASK;
+
+// state of the device probes. Advanced by probeStep() every frame
+typedef struct _PROBE_SCHEDULER
+{
+    PROBE_TASK tasks[PROBE_MAX_TASKS];
+    unsigned int numTasks;
+    unsigned int current; // next task to probe
+    unsigned int numFound;
+    bool done;
+} PROBE_SCHEDULER, *PPROBE_SCHEDULER;
+
+void probeInit(PPROBE_SCHEDULER scheduler);
+int probeAdd(PPROBE_SCHEDULER scheduler, int backupDevice, bool* detected, int skipIfFound);
+int probeStep(PPROBE_SCHEDULER scheduler, unsigned int budgetTicks);
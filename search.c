@@ -0,0 +1,96 @@
+// Save search - jumps to saves in a sorted listing by name
+#include "search.h"
+
+// builds the first character jump table
+// saves must already be sorted by name with the subdirectories first
+void searchInit(PSAVE_SEARCH search, PSAVES saves, unsigned int numSaves)
+{
+    search->saves = saves;
+    search->numSaves = numSaves;
+    search->firstSave = 0;
+
+    for(unsigned int i = 0; i < COUNTOF(search->firstByCharacter); i++)
+    {
+        search->firstByCharacter[i] = SEARCH_NOT_FOUND;
+    }
+
+    while(search->firstSave < numSaves && saves[search->firstSave].directory)
+    {
+        search->firstSave++;
+    }
+
+    // walk backwards so each entry ends up with the first save of the run
+    for(int i = numSaves - 1; i >= (int)search->firstSave; i--)
+    {
+        search->firstByCharacter[(unsigned char)saves[i].name[0]] = i;
+    }
+}
+
+// returns the first save starting with the next (direction 1) or previous
+// (direction -1) character that has saves, wrapping around the listing
+int searchNextCharacter(PSAVE_SEARCH search, int index, int direction)
+{
+    unsigned char current = 0;
+
+    if(search->firstSave >= search->numSaves)
+    {
+        return SEARCH_NOT_FOUND;
+    }
+
+    // from a subdirectory the search starts before the first save
+    if(index < (int)search->firstSave || index >= (int)search->numSaves)
+    {
+        return direction > 0 ? (int)search->firstSave : search->firstByCharacter[(unsigned char)search->saves[search->numSaves - 1].name[0]];
+    }
+
+    current = search->saves[index].name[0];
+
+    for(int i = 1; i < (int)COUNTOF(search->firstByCharacter); i++)
+    {
+        unsigned char c = (unsigned char)(current + i * direction);
+
+        if(search->firstByCharacter[c] != SEARCH_NOT_FOUND)
+        {
+            return search->firstByCharacter[c];
+        }
+    }
+
+    // every save starts with the same character
+    return search->firstByCharacter[current];
+}
+
+// binary searches for the first save whose name starts with prefix
+// returns SEARCH_NOT_FOUND if no save matches
+int searchPrefix(PSAVE_SEARCH search, const char* prefix)
+{
+    unsigned int low = search->firstSave;
+    unsigned int high = search->numSaves;
+    unsigned int length = strlen(prefix);
+
+    if(length == 0)
+    {
+        return SEARCH_NOT_FOUND;
+    }
+
+    // lower bound, the first name that isn't less than prefix
+    while(low < high)
+    {
+        unsigned int mid = low + (high - low) / 2;
+
+        if(strcmp(search->saves[mid].name, prefix) < 0)
+        {
+            low = mid + 1;
+        }
+        else
+        {
+            high = mid;
+        }
+    }
+
+    if(low < search->numSaves && strncmp(search->saves[low].name, prefix, length) == 0)
+    {
+        return low;
+    }
+
+    return SEARCH_NOT_FOUND;
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include "backends/backend.h"
+
+//
+// Save search - jumps to saves in a sorted listing by name
+//
+
+#define SEARCH_NOT_FOUND        -1
+
+// lookup tables for a listing sorted with compareSaveName()
+// subdirectories sort before the saves and are not searched
+typedef struct _SAVE_SEARCH
+{
+    PSAVES saves;
+    unsigned int numSaves;
+    unsigned int firstSave; // index of the first save after the subdirectories
+
+    // index of the first save whose name starts with each character
+    short firstByCharacter[256];
+} SAVE_SEARCH, *PSAVE_SEARCH;
+
+void searchInit(PSAVE_SEARCH search, PSAVES saves, unsigned int numSaves);
+int searchNextCharacter(PSAVE_SEARCH search, int index, int direction);
+int searchPrefix(PSAVE_SEARCH search, const char* prefix);
@@ -0,0 +1,289 @@
+// sgcindex - builds SATSAVES/INDEX.BIN from the .BUP files in cd/SATSAVES
+// Host tool, run by compile.sh before the ISO is built
+// Per-game subdirectories of SATSAVES get their own INDEX.BIN
+//
+// usage: sgcindex <SATSAVES directory>
+#include <ctype.h>
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include "../backends/cdindex.h"
+
+#define BUP_EXTENSION ".BUP"
+#define MAX_PATH_LEN 4096
+
+// index entry before it is serialized
+typedef struct _INDEX_FILE
+{
+    char filename[CD_INDEX_MAX_FILENAME];
+    unsigned int fileSize;
+    unsigned char bupHeader[CD_INDEX_BUP_HEADER_SIZE];
+} INDEX_FILE, *PINDEX_FILE;
+
+static int indexDirectory(const char* directory);
+static int compareFilenames(const void* a, const void* b);
+static int isFileBUPExt(const char* filename);
+static int readBUPHeader(const char* path, unsigned char* bupHeader);
+static void writeBigEndian32(unsigned char* buffer, unsigned int value);
+static int writeIndex(const char* path, PINDEX_FILE files, unsigned int numFiles);
+
+int main(int argc, char** argv)
+{
+    char path[MAX_PATH_LEN] = {0};
+    struct dirent* entry = NULL;
+    DIR* dir = NULL;
+    int result = 0;
+
+    if(argc != 2)
+    {
+        fprintf(stderr, "usage: %s <SATSAVES directory>\n", argv[0]);
+        return 1;
+    }
+
+    result = indexDirectory(argv[1]);
+    if(result != 0)
+    {
+        return 1;
+    }
+
+    dir = opendir(argv[1]);
+    if(dir == NULL)
+    {
+        fprintf(stderr, "Failed to open %s\n", argv[1]);
+        return 1;
+    }
+
+    // one level of per-game subdirectories
+    while((entry = readdir(dir)) != NULL && result == 0)
+    {
+        struct stat st = {0};
+
+        if(entry->d_name[0] == '.')
+        {
+            continue;
+        }
+
+        snprintf(path, sizeof(path), "%s/%s", argv[1], entry->d_name);
+
+        if(stat(path, &st) != 0 || !S_ISDIR(st.st_mode))
+        {
+            continue;
+        }
+
+        result = indexDirectory(path);
+    }
+
+    closedir(dir);
+
+    return result == 0 ? 0 : 1;
+}
+
+// writes INDEX.BIN for the .BUP files in the directory
+static int indexDirectory(const char* directory)
+{
+    char path[MAX_PATH_LEN] = {0};
+    PINDEX_FILE files = NULL;
+    unsigned int numFiles = 0;
+    unsigned int maxFiles = 0;
+    struct dirent* entry = NULL;
+    DIR* dir = NULL;
+    int result = 0;
+
+    dir = opendir(directory);
+    if(dir == NULL)
+    {
+        fprintf(stderr, "Failed to open %s\n", directory);
+        return -1;
+    }
+
+    while((entry = readdir(dir)) != NULL)
+    {
+        struct stat st = {0};
+        PINDEX_FILE file = NULL;
+        unsigned int len = 0;
+
+        if(!isFileBUPExt(entry->d_name))
+        {
+            continue;
+        }
+
+        len = strlen(entry->d_name);
+        if(len >= CD_INDEX_MAX_FILENAME)
+        {
+            fprintf(stderr, "Skipping %s, filename is not 8.3\n", entry->d_name);
+            continue;
+        }
+
+        snprintf(path, sizeof(path), "%s/%s", directory, entry->d_name);
+
+        if(stat(path, &st) != 0 || !S_ISREG(st.st_mode))
+        {
+            continue;
+        }
+
+        if(st.st_size < CD_INDEX_BUP_HEADER_SIZE)
+        {
+            fprintf(stderr, "Skipping %s, too small for a .BUP\n", entry->d_name);
+            continue;
+        }
+
+        if(numFiles == maxFiles)
+        {
+            maxFiles = maxFiles ? maxFiles * 2 : 256;
+            files = realloc(files, maxFiles * sizeof(INDEX_FILE));
+            if(files == NULL)
+            {
+                fprintf(stderr, "Out of memory\n");
+                closedir(dir);
+                return -1;
+            }
+        }
+
+        file = &files[numFiles];
+        memset(file, 0, sizeof(INDEX_FILE));
+
+        // ISO9660 names are upper case
+        for(unsigned int i = 0; i < len; i++)
+        {
+            file->filename[i] = toupper((unsigned char)entry->d_name[i]);
+        }
+
+        file->fileSize = (unsigned int)st.st_size;
+
+        result = readBUPHeader(path, file->bupHeader);
+        if(result != 0)
+        {
+            fprintf(stderr, "Skipping %s, failed to read the .BUP header\n", entry->d_name);
+            continue;
+        }
+
+        numFiles++;
+    }
+
+    closedir(dir);
+
+    // the Saturn binary searches the index by filename
+    qsort(files, numFiles, sizeof(INDEX_FILE), compareFilenames);
+
+    snprintf(path, sizeof(path), "%s/%s", directory, CD_INDEX_FILENAME);
+
+    result = writeIndex(path, files, numFiles);
+    free(files);
+
+    if(result != 0)
+    {
+        return -2;
+    }
+
+    printf("sgcindex: indexed %u saves in %s\n", numFiles, path);
+    return 0;
+}
+
+// sort by filename, must match the strcmp() on the Saturn
+static int compareFilenames(const void* a, const void* b)
+{
+    PINDEX_FILE aFile = (PINDEX_FILE)a;
+    PINDEX_FILE bFile = (PINDEX_FILE)b;
+
+    return strcmp(aFile->filename, bFile->filename);
+}
+
+// case insensitive, the name is upper cased on the disc
+static int isFileBUPExt(const char* filename)
+{
+    unsigned int len = strlen(filename);
+
+    if(len < sizeof(BUP_EXTENSION))
+    {
+        return 0;
+    }
+
+    return strcasecmp(&filename[len - strlen(BUP_EXTENSION)], BUP_EXTENSION) == 0;
+}
+
+// reads the first 64 bytes of the .BUP
+static int readBUPHeader(const char* path, unsigned char* bupHeader)
+{
+    FILE* fp = NULL;
+    size_t bytesRead = 0;
+
+    fp = fopen(path, "rb");
+    if(fp == NULL)
+    {
+        return -1;
+    }
+
+    bytesRead = fread(bupHeader, 1, CD_INDEX_BUP_HEADER_SIZE, fp);
+    fclose(fp);
+
+    if(bytesRead != CD_INDEX_BUP_HEADER_SIZE)
+    {
+        return -2;
+    }
+
+    return 0;
+}
+
+static void writeBigEndian32(unsigned char* buffer, unsigned int value)
+{
+    buffer[0] = (value >> 24) & 0xFF;
+    buffer[1] = (value >> 16) & 0xFF;
+    buffer[2] = (value >> 8) & 0xFF;
+    buffer[3] = value & 0xFF;
+}
+
+// serializes the index, see backends/cdindex.h for the layout
+static int writeIndex(const char* path, PINDEX_FILE files, unsigned int numFiles)
+{
+    unsigned char header[sizeof(CD_INDEX_HEADER)] = {0};
+    unsigned char entry[sizeof(CD_INDEX_ENTRY)] = {0};
+    FILE* fp = NULL;
+    int result = 0;
+
+    fp = fopen(path, "wb");
+    if(fp == NULL)
+    {
+        fprintf(stderr, "Failed to create %s\n", path);
+        return -1;
+    }
+
+    memcpy(header, CD_INDEX_MAGIC, CD_INDEX_MAGIC_LEN);
+    writeBigEndian32(&header[4], CD_INDEX_VERSION);
+    writeBigEndian32(&header[8], numFiles);
+    writeBigEndian32(&header[12], sizeof(CD_INDEX_ENTRY));
+
+    if(fwrite(header, sizeof(header), 1, fp) != 1)
+    {
+        result = -2;
+        goto exit;
+    }
+
+    for(unsigned int i = 0; i < numFiles; i++)
+    {
+        memset(entry, 0, sizeof(entry));
+        memcpy(entry, files[i].filename, CD_INDEX_MAX_FILENAME);
+        writeBigEndian32(&entry[CD_INDEX_MAX_FILENAME], files[i].fileSize);
+        // the FAD is left 0, the ISO isn't built yet
+        memcpy(&entry[CD_INDEX_MAX_FILENAME + 8], files[i].bupHeader, CD_INDEX_BUP_HEADER_SIZE);
+
+        if(fwrite(entry, sizeof(entry), 1, fp) != 1)
+        {
+            result = -3;
+            goto exit;
+        }
+    }
+
+exit:
+    fclose(fp);
+
+    if(result != 0)
+    {
+        fprintf(stderr, "Failed to write %s\n", path);
+        remove(path);
+    }
+
+    return result;
+}
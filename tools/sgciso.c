@@ -0,0 +1,922 @@
+// sgciso - builds an SGC ISO from the SGC cd directory and a directory of .BUP files
+// Host tool, replaces the mount/tar/mkisofs/dd steps of a custom ISO
+//
+// usage: sgciso -b <IP.BIN or SGC ISO> -o <output ISO> <cd directory> [save directory]
+//
+// - the first 16 sectors (boot headers) are copied from the -b file
+// - every file in the cd directory is copied to the root of the ISO
+// - every .BUP in the save directory (default <cd directory>/SATSAVES) is
+//   copied to SATSAVES with an 8.3 name that doesn't collide with any other save
+// - SATSAVES/INDEX.BIN is generated, see backends/cdindex.h
+// - the index and the saves are laid out back to back in directory order so
+//   listing and reading the saves on the Saturn is a sequential CD read
+#include <ctype.h>
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+
+#include "../backends/cdindex.h"
+
+#define SECTOR_SIZE             2048
+#define SYSTEM_AREA_SECTORS     16 // boot headers
+#define PVD_SECTOR              16
+#define TERMINATOR_SECTOR       17
+#define L_PATH_TABLE_SECTOR     18
+#define M_PATH_TABLE_SECTOR     19
+#define ROOT_DIRECTORY_SECTOR   20
+#define FAD_OFFSET              150 // GFS addresses sectors by FAD, LBA + 150
+
+#define SAVES_DIRECTORY         "SATSAVES"
+#define BUP_EXTENSION           ".BUP"
+#define VMEM_MAGIC_STRING       "Vmem"
+#define MAX_SHORT_NAME          8 // 8.3
+#define MAX_ISO_NAME            CD_INDEX_MAX_FILENAME
+#define MAX_PATH_LEN            4096
+
+#define ISO_FLAG_DIRECTORY      0x02
+
+// file or directory in one of the two ISO directories
+typedef struct _ISO_FILE
+{
+    char name[MAX_ISO_NAME]; // name on the ISO without the ";1"
+    char path[MAX_PATH_LEN]; // host path, empty for generated files
+    unsigned char* data; // contents of generated files
+    unsigned int size;
+    unsigned int lba;
+    unsigned char flags; // ISO_FLAG_XXX
+} ISO_FILE, *PISO_FILE;
+
+typedef struct _ISO_DIRECTORY
+{
+    PISO_FILE files;
+    unsigned int numFiles;
+    unsigned int maxFiles;
+    unsigned int lba;
+    unsigned int size; // size of the directory records, multiple of the sector size
+} ISO_DIRECTORY, *PISO_DIRECTORY;
+
+static PISO_FILE addFile(PISO_DIRECTORY dir, const char* name);
+static PISO_FILE findFile(PISO_DIRECTORY dir, const char* name);
+static int compareFiles(const void* a, const void* b);
+static int listRootFiles(PISO_DIRECTORY root, const char* cdDirectory);
+static int listSaveFiles(PISO_DIRECTORY saves, const char* saveDirectory);
+static int makeShortName(PISO_DIRECTORY saves, const char* filename, char* shortName);
+static int buildIndex(PISO_DIRECTORY saves);
+static void fillIndexFads(PISO_DIRECTORY saves);
+static int readFileHeader(const char* path, unsigned char* buffer, unsigned int size);
+static unsigned int recordSize(const char* name, unsigned char flags);
+static unsigned int directorySize(PISO_DIRECTORY dir);
+static unsigned int sectorCount(unsigned int size);
+static void layoutFiles(PISO_DIRECTORY dir, unsigned int* lba, int generated);
+static void writeLittleEndian16(unsigned char* buffer, unsigned int value);
+static void writeBigEndian16(unsigned char* buffer, unsigned int value);
+static void writeLittleEndian32(unsigned char* buffer, unsigned int value);
+static void writeBigEndian32(unsigned char* buffer, unsigned int value);
+static void writeBoth16(unsigned char* buffer, unsigned int value);
+static void writeBoth32(unsigned char* buffer, unsigned int value);
+static void writeString(unsigned char* buffer, const char* string, unsigned int size);
+static unsigned int writeRecord(unsigned char* buffer, const char* name, unsigned int nameLen, unsigned int lba, unsigned int size, unsigned char flags);
+static int writeSystemArea(FILE* fp, const char* bootFile);
+static int writeVolumeDescriptors(FILE* fp, PISO_DIRECTORY root, unsigned int totalSectors);
+static int writePathTables(FILE* fp, PISO_DIRECTORY root, PISO_DIRECTORY saves);
+static int writeDirectory(FILE* fp, PISO_DIRECTORY dir, PISO_DIRECTORY parent);
+static int writeFiles(FILE* fp, PISO_DIRECTORY dir, int generated);
+static int writeSectors(FILE* fp, const unsigned char* data, unsigned int size);
+
+static struct tm g_BuildTime = {0};
+
+int main(int argc, char** argv)
+{
+    ISO_DIRECTORY root = {0};
+    ISO_DIRECTORY saves = {0};
+    PISO_FILE savesEntry = NULL;
+    char defaultSaveDirectory[MAX_PATH_LEN] = {0};
+    const char* bootFile = NULL;
+    const char* outputFile = NULL;
+    const char* cdDirectory = NULL;
+    const char* saveDirectory = NULL;
+    unsigned int lba = 0;
+    time_t now = 0;
+    FILE* fp = NULL;
+    int result = 0;
+
+    for(int i = 1; i < argc; i++)
+    {
+        if(strcmp(argv[i], "-b") == 0 && i + 1 < argc)
+        {
+            bootFile = argv[++i];
+        }
+        else if(strcmp(argv[i], "-o") == 0 && i + 1 < argc)
+        {
+            outputFile = argv[++i];
+        }
+        else if(cdDirectory == NULL)
+        {
+            cdDirectory = argv[i];
+        }
+        else if(saveDirectory == NULL)
+        {
+            saveDirectory = argv[i];
+        }
+        else
+        {
+            cdDirectory = NULL;
+            break;
+        }
+    }
+
+    if(bootFile == NULL || outputFile == NULL || cdDirectory == NULL)
+    {
+        fprintf(stderr, "usage: %s -b <IP.BIN or SGC ISO> -o <output ISO> <cd directory> [save directory]\n", argv[0]);
+        return 1;
+    }
+
+    if(saveDirectory == NULL)
+    {
+        snprintf(defaultSaveDirectory, sizeof(defaultSaveDirectory), "%s/%s", cdDirectory, SAVES_DIRECTORY);
+        saveDirectory = defaultSaveDirectory;
+    }
+
+    now = time(NULL);
+    g_BuildTime = *gmtime(&now);
+
+    result = listRootFiles(&root, cdDirectory);
+    if(result != 0)
+    {
+        return 1;
+    }
+
+    result = listSaveFiles(&saves, saveDirectory);
+    if(result != 0)
+    {
+        return 1;
+    }
+
+    // directory order is the order GFS assigns file ids and the order SGC lists the saves
+    qsort(saves.files, saves.numFiles, sizeof(ISO_FILE), compareFiles);
+
+    result = buildIndex(&saves);
+    if(result != 0)
+    {
+        return 1;
+    }
+
+    savesEntry = addFile(&root, SAVES_DIRECTORY);
+    if(savesEntry == NULL)
+    {
+        return 1;
+    }
+    savesEntry->flags = ISO_FLAG_DIRECTORY;
+
+    // 0.BIN must remain the first file in the root directory
+    qsort(root.files, root.numFiles, sizeof(ISO_FILE), compareFiles);
+    qsort(saves.files, saves.numFiles, sizeof(ISO_FILE), compareFiles);
+
+    // directories, then the root files, then the index followed by the saves
+    root.lba = ROOT_DIRECTORY_SECTOR;
+    root.size = directorySize(&root);
+    saves.lba = root.lba + sectorCount(root.size);
+    saves.size = directorySize(&saves);
+
+    savesEntry = findFile(&root, SAVES_DIRECTORY);
+    savesEntry->lba = saves.lba;
+    savesEntry->size = saves.size;
+
+    lba = saves.lba + sectorCount(saves.size);
+    layoutFiles(&root, &lba, 0);
+    layoutFiles(&saves, &lba, 1);
+    layoutFiles(&saves, &lba, 0);
+    fillIndexFads(&saves);
+
+    fp = fopen(outputFile, "wb");
+    if(fp == NULL)
+    {
+        fprintf(stderr, "Failed to create %s\n", outputFile);
+        return 1;
+    }
+
+    result = writeSystemArea(fp, bootFile);
+    if(result == 0)
+    {
+        result = writeVolumeDescriptors(fp, &root, lba);
+    }
+    if(result == 0)
+    {
+        result = writePathTables(fp, &root, &saves);
+    }
+    if(result == 0)
+    {
+        result = writeDirectory(fp, &root, &root);
+    }
+    if(result == 0)
+    {
+        result = writeDirectory(fp, &saves, &root);
+    }
+    if(result == 0)
+    {
+        result = writeFiles(fp, &root, 0);
+    }
+    if(result == 0)
+    {
+        result = writeFiles(fp, &saves, 1);
+    }
+    if(result == 0)
+    {
+        result = writeFiles(fp, &saves, 0);
+    }
+
+    fclose(fp);
+
+    if(result != 0)
+    {
+        fprintf(stderr, "Failed to write %s (%d)\n", outputFile, result);
+        remove(outputFile);
+        return 1;
+    }
+
+    printf("sgciso: wrote %u saves, %u sectors to %s\n", saves.numFiles - 1, lba, outputFile);
+    return 0;
+}
+
+// appends an empty entry to the directory
+static PISO_FILE addFile(PISO_DIRECTORY dir, const char* name)
+{
+    PISO_FILE file = NULL;
+
+    if(dir->numFiles == dir->maxFiles)
+    {
+        dir->maxFiles = dir->maxFiles ? dir->maxFiles * 2 : 256;
+        dir->files = realloc(dir->files, dir->maxFiles * sizeof(ISO_FILE));
+        if(dir->files == NULL)
+        {
+            fprintf(stderr, "Out of memory\n");
+            return NULL;
+        }
+    }
+
+    file = &dir->files[dir->numFiles];
+    memset(file, 0, sizeof(ISO_FILE));
+    strncpy(file->name, name, MAX_ISO_NAME - 1);
+    dir->numFiles++;
+
+    return file;
+}
+
+static PISO_FILE findFile(PISO_DIRECTORY dir, const char* name)
+{
+    for(unsigned int i = 0; i < dir->numFiles; i++)
+    {
+        if(strcmp(dir->files[i].name, name) == 0)
+        {
+            return &dir->files[i];
+        }
+    }
+
+    return NULL;
+}
+
+// ISO9660 directories are sorted by name
+static int compareFiles(const void* a, const void* b)
+{
+    PISO_FILE aFile = (PISO_FILE)a;
+    PISO_FILE bFile = (PISO_FILE)b;
+
+    return strcmp(aFile->name, bFile->name);
+}
+
+// adds every regular file in the cd directory, e.g. 0.BIN and ABS.TXT
+static int listRootFiles(PISO_DIRECTORY root, const char* cdDirectory)
+{
+    struct dirent* entry = NULL;
+    DIR* dir = NULL;
+
+    dir = opendir(cdDirectory);
+    if(dir == NULL)
+    {
+        fprintf(stderr, "Failed to open %s\n", cdDirectory);
+        return -1;
+    }
+
+    while((entry = readdir(dir)) != NULL)
+    {
+        char path[MAX_PATH_LEN] = {0};
+        struct stat st = {0};
+        PISO_FILE file = NULL;
+
+        snprintf(path, sizeof(path), "%s/%s", cdDirectory, entry->d_name);
+
+        if(stat(path, &st) != 0 || !S_ISREG(st.st_mode))
+        {
+            // SATSAVES is generated from the save directory
+            continue;
+        }
+
+        if(strlen(entry->d_name) >= MAX_ISO_NAME)
+        {
+            fprintf(stderr, "Skipping %s, filename is too long\n", entry->d_name);
+            continue;
+        }
+
+        file = addFile(root, entry->d_name);
+        if(file == NULL)
+        {
+            closedir(dir);
+            return -2;
+        }
+
+        for(unsigned int i = 0; file->name[i]; i++)
+        {
+            file->name[i] = toupper((unsigned char)file->name[i]);
+        }
+
+        memcpy(file->path, path, MAX_PATH_LEN);
+        file->size = (unsigned int)st.st_size;
+    }
+
+    closedir(dir);
+
+    if(findFile(root, "0.BIN") == NULL)
+    {
+        fprintf(stderr, "Warning: %s has no 0.BIN, the ISO will not boot\n", cdDirectory);
+    }
+
+    return 0;
+}
+
+// adds every .BUP in the save directory with a unique 8.3 name
+static int listSaveFiles(PISO_DIRECTORY saves, const char* saveDirectory)
+{
+    struct dirent** entries = NULL;
+    int numEntries = 0;
+    int result = 0;
+
+    // sorted so the 8.3 names are the same from build to build
+    numEntries = scandir(saveDirectory, &entries, NULL, alphasort);
+    if(numEntries < 0)
+    {
+        fprintf(stderr, "Failed to open %s\n", saveDirectory);
+        return -1;
+    }
+
+    for(int i = 0; i < numEntries; i++)
+    {
+        char path[MAX_PATH_LEN] = {0};
+        char shortName[MAX_ISO_NAME] = {0};
+        unsigned char magic[sizeof(VMEM_MAGIC_STRING) - 1] = {0};
+        const char* name = entries[i]->d_name;
+        struct stat st = {0};
+        PISO_FILE file = NULL;
+        unsigned int len = strlen(name);
+
+        if(result != 0)
+        {
+            free(entries[i]);
+            continue;
+        }
+
+        snprintf(path, sizeof(path), "%s/%s", saveDirectory, name);
+
+        if(len < sizeof(BUP_EXTENSION) ||
+           strcasecmp(&name[len - strlen(BUP_EXTENSION)], BUP_EXTENSION) != 0 ||
+           stat(path, &st) != 0 || !S_ISREG(st.st_mode))
+        {
+            free(entries[i]);
+            continue;
+        }
+
+        if(st.st_size < CD_INDEX_BUP_HEADER_SIZE ||
+           readFileHeader(path, magic, sizeof(magic)) != 0 ||
+           memcmp(magic, VMEM_MAGIC_STRING, sizeof(magic)) != 0)
+        {
+            fprintf(stderr, "Skipping %s, not a .BUP save\n", name);
+            free(entries[i]);
+            continue;
+        }
+
+        result = makeShortName(saves, name, shortName);
+        if(result == 0)
+        {
+            file = addFile(saves, shortName);
+            if(file == NULL)
+            {
+                result = -2;
+            }
+        }
+
+        if(file != NULL)
+        {
+            memcpy(file->path, path, MAX_PATH_LEN);
+            file->size = (unsigned int)st.st_size;
+
+            if(strcmp(shortName, name) != 0)
+            {
+                printf("%s -> %s\n", name, shortName);
+            }
+        }
+
+        free(entries[i]);
+    }
+
+    free(entries);
+    return result;
+}
+
+// converts the filename to a unique upper case 8.3 .BUP name
+// truncated names that collide get a numeric suffix, e.g. GRANDIA_.BUP, GRANDIA1.BUP
+static int makeShortName(PISO_DIRECTORY saves, const char* filename, char* shortName)
+{
+    char base[MAX_SHORT_NAME + 1] = {0};
+    unsigned int baseLen = 0;
+    unsigned int len = strlen(filename) - strlen(BUP_EXTENSION);
+
+    // ISO9660 d-characters only
+    for(unsigned int i = 0; i < len && baseLen < MAX_SHORT_NAME; i++)
+    {
+        unsigned char c = toupper((unsigned char)filename[i]);
+
+        if(!isalnum(c))
+        {
+            c = '_';
+        }
+
+        base[baseLen++] = c;
+    }
+
+    snprintf(shortName, MAX_ISO_NAME, "%s%s", base, BUP_EXTENSION);
+
+    for(unsigned int suffix = 1; findFile(saves, shortName) != NULL; suffix++)
+    {
+        char number[MAX_SHORT_NAME + 1] = {0};
+        unsigned int numberLen = 0;
+
+        numberLen = snprintf(number, sizeof(number), "%u", suffix);
+        if(numberLen >= MAX_SHORT_NAME)
+        {
+            fprintf(stderr, "Failed to find a unique name for %s\n", filename);
+            return -1;
+        }
+
+        snprintf(shortName, MAX_ISO_NAME, "%.*s%s%s", (int)(baseLen < MAX_SHORT_NAME - numberLen ? baseLen : MAX_SHORT_NAME - numberLen), base, number, BUP_EXTENSION);
+    }
+
+    return 0;
+}
+
+// generates INDEX.BIN from the sorted saves
+static int buildIndex(PISO_DIRECTORY saves)
+{
+    unsigned int numSaves = saves->numFiles;
+    unsigned int size = sizeof(CD_INDEX_HEADER) + numSaves * sizeof(CD_INDEX_ENTRY);
+    unsigned char* index = NULL;
+    unsigned char* entry = NULL;
+    PISO_FILE file = NULL;
+
+    index = calloc(1, size);
+    if(index == NULL)
+    {
+        fprintf(stderr, "Out of memory\n");
+        return -1;
+    }
+
+    memcpy(index, CD_INDEX_MAGIC, CD_INDEX_MAGIC_LEN);
+    writeBigEndian32(index + 4, CD_INDEX_VERSION);
+    writeBigEndian32(index + 8, numSaves);
+    writeBigEndian32(index + 12, sizeof(CD_INDEX_ENTRY));
+
+    entry = index + sizeof(CD_INDEX_HEADER);
+
+    for(unsigned int i = 0; i < numSaves; i++)
+    {
+        memcpy(entry, saves->files[i].name, CD_INDEX_MAX_FILENAME);
+        writeBigEndian32(entry + CD_INDEX_MAX_FILENAME, saves->files[i].size);
+
+        if(readFileHeader(saves->files[i].path, entry + CD_INDEX_MAX_FILENAME + 8, CD_INDEX_BUP_HEADER_SIZE) != 0)
+        {
+            fprintf(stderr, "Failed to read %s\n", saves->files[i].path);
+            free(index);
+            return -2;
+        }
+
+        entry += sizeof(CD_INDEX_ENTRY);
+    }
+
+    file = addFile(saves, CD_INDEX_FILENAME);
+    if(file == NULL)
+    {
+        free(index);
+        return -3;
+    }
+
+    file->data = index;
+    file->size = size;
+
+    return 0;
+}
+
+// stores where each save landed in the index once the files are laid out
+static void fillIndexFads(PISO_DIRECTORY saves)
+{
+    PISO_FILE indexFile = findFile(saves, CD_INDEX_FILENAME);
+    unsigned char* entry = indexFile->data + sizeof(CD_INDEX_HEADER);
+
+    for(unsigned int i = 0; i < saves->numFiles; i++)
+    {
+        PISO_FILE file = &saves->files[i];
+
+        if(file == indexFile)
+        {
+            continue;
+        }
+
+        // the entries are in the same order as the saves
+        writeBigEndian32(entry + CD_INDEX_MAX_FILENAME + 4, file->lba + FAD_OFFSET);
+        entry += sizeof(CD_INDEX_ENTRY);
+    }
+}
+
+static int readFileHeader(const char* path, unsigned char* buffer, unsigned int size)
+{
+    FILE* fp = NULL;
+    size_t bytesRead = 0;
+
+    fp = fopen(path, "rb");
+    if(fp == NULL)
+    {
+        return -1;
+    }
+
+    bytesRead = fread(buffer, 1, size, fp);
+    fclose(fp);
+
+    if(bytesRead != size)
+    {
+        return -2;
+    }
+
+    return 0;
+}
+
+// size of a directory record, files get a ";1" version suffix
+static unsigned int recordSize(const char* name, unsigned char flags)
+{
+    unsigned int nameLen = strlen(name);
+
+    if(!(flags & ISO_FLAG_DIRECTORY))
+    {
+        nameLen += 2;
+    }
+
+    // padded to an even length
+    return 33 + nameLen + ((nameLen & 1) ? 0 : 1);
+}
+
+// size of the directory extent, records may not cross a sector boundary
+static unsigned int directorySize(PISO_DIRECTORY dir)
+{
+    unsigned int size = 34 * 2; // "." and ".."
+
+    for(unsigned int i = 0; i < dir->numFiles; i++)
+    {
+        unsigned int length = recordSize(dir->files[i].name, dir->files[i].flags);
+
+        if((size % SECTOR_SIZE) + length > SECTOR_SIZE)
+        {
+            size = sectorCount(size) * SECTOR_SIZE;
+        }
+
+        size += length;
+    }
+
+    return sectorCount(size) * SECTOR_SIZE;
+}
+
+static unsigned int sectorCount(unsigned int size)
+{
+    return (size + SECTOR_SIZE - 1) / SECTOR_SIZE;
+}
+
+// assigns consecutive sectors to the generated files or to the regular files
+static void layoutFiles(PISO_DIRECTORY dir, unsigned int* lba, int generated)
+{
+    for(unsigned int i = 0; i < dir->numFiles; i++)
+    {
+        PISO_FILE file = &dir->files[i];
+
+        if((file->flags & ISO_FLAG_DIRECTORY) || (file->data != NULL) != generated)
+        {
+            continue;
+        }
+
+        file->lba = *lba;
+        *lba += sectorCount(file->size);
+    }
+}
+
+static void writeLittleEndian16(unsigned char* buffer, unsigned int value)
+{
+    buffer[0] = value & 0xFF;
+    buffer[1] = (value >> 8) & 0xFF;
+}
+
+static void writeBigEndian16(unsigned char* buffer, unsigned int value)
+{
+    buffer[0] = (value >> 8) & 0xFF;
+    buffer[1] = value & 0xFF;
+}
+
+static void writeLittleEndian32(unsigned char* buffer, unsigned int value)
+{
+    buffer[0] = value & 0xFF;
+    buffer[1] = (value >> 8) & 0xFF;
+    buffer[2] = (value >> 16) & 0xFF;
+    buffer[3] = (value >> 24) & 0xFF;
+}
+
+static void writeBigEndian32(unsigned char* buffer, unsigned int value)
+{
+    buffer[0] = (value >> 24) & 0xFF;
+    buffer[1] = (value >> 16) & 0xFF;
+    buffer[2] = (value >> 8) & 0xFF;
+    buffer[3] = value & 0xFF;
+}
+
+// ISO9660 both-byte order, little-endian followed by big-endian
+static void writeBoth16(unsigned char* buffer, unsigned int value)
+{
+    writeLittleEndian16(buffer, value);
+    writeBigEndian16(buffer + 2, value);
+}
+
+static void writeBoth32(unsigned char* buffer, unsigned int value)
+{
+    writeLittleEndian32(buffer, value);
+    writeBigEndian32(buffer + 4, value);
+}
+
+// space padded string field
+static void writeString(unsigned char* buffer, const char* string, unsigned int size)
+{
+    unsigned int len = strlen(string);
+
+    memset(buffer, ' ', size);
+    memcpy(buffer, string, len < size ? len : size);
+}
+
+// writes a directory record and returns its size
+static unsigned int writeRecord(unsigned char* buffer, const char* name, unsigned int nameLen, unsigned int lba, unsigned int size, unsigned char flags)
+{
+    unsigned int length = 33 + nameLen + ((nameLen & 1) ? 0 : 1);
+
+    memset(buffer, 0, length);
+    buffer[0] = length;
+    writeBoth32(buffer + 2, lba);
+    writeBoth32(buffer + 10, size);
+    buffer[18] = g_BuildTime.tm_year;
+    buffer[19] = g_BuildTime.tm_mon + 1;
+    buffer[20] = g_BuildTime.tm_mday;
+    buffer[21] = g_BuildTime.tm_hour;
+    buffer[22] = g_BuildTime.tm_min;
+    buffer[23] = g_BuildTime.tm_sec;
+    buffer[25] = flags;
+    writeBoth16(buffer + 28, 1); // volume sequence number
+    buffer[32] = nameLen;
+    memcpy(buffer + 33, name, nameLen);
+
+    return length;
+}
+
+// copies the boot headers from an IP.BIN or an existing SGC ISO
+static int writeSystemArea(FILE* fp, const char* bootFile)
+{
+    unsigned char systemArea[SYSTEM_AREA_SECTORS * SECTOR_SIZE] = {0};
+    FILE* boot = NULL;
+    size_t bytesRead = 0;
+
+    boot = fopen(bootFile, "rb");
+    if(boot == NULL)
+    {
+        fprintf(stderr, "Failed to open %s\n", bootFile);
+        return -1;
+    }
+
+    bytesRead = fread(systemArea, 1, sizeof(systemArea), boot);
+    fclose(boot);
+
+    if(bytesRead < 16 || memcmp(systemArea, "SEGA SEGASATURN ", 16) != 0)
+    {
+        fprintf(stderr, "%s doesn't start with Saturn boot headers\n", bootFile);
+        return -2;
+    }
+
+    return writeSectors(fp, systemArea, sizeof(systemArea));
+}
+
+// primary volume descriptor and the set terminator
+static int writeVolumeDescriptors(FILE* fp, PISO_DIRECTORY root, unsigned int totalSectors)
+{
+    unsigned char sector[SECTOR_SIZE] = {0};
+    char date[17] = {0};
+    int result = 0;
+
+    sector[0] = 1;
+    memcpy(sector + 1, "CD001", 5);
+    sector[6] = 1;
+    writeString(sector + 8, "SEGA SATURN", 32);
+    writeString(sector + 40, "SGC", 32);
+    writeBoth32(sector + 80, totalSectors);
+    writeBoth16(sector + 120, 1); // volume set size
+    writeBoth16(sector + 124, 1); // volume sequence number
+    writeBoth16(sector + 128, SECTOR_SIZE);
+    writeBoth32(sector + 132, 10 + 8 + strlen(SAVES_DIRECTORY)); // path table size
+    writeLittleEndian32(sector + 140, L_PATH_TABLE_SECTOR);
+    writeBigEndian32(sector + 148, M_PATH_TABLE_SECTOR);
+    writeRecord(sector + 156, "\0", 1, root->lba, root->size, ISO_FLAG_DIRECTORY);
+    writeString(sector + 190, "SGC", 128);
+    writeString(sector + 318, "SEGA ENTERPRISES, LTD.", 128);
+    writeString(sector + 446, "SEGA ENTERPRISES, LTD.", 128);
+    writeString(sector + 574, "SGC", 128);
+    writeString(sector + 702, findFile(root, "CPY.TXT") ? "CPY.TXT" : "", 37);
+    writeString(sector + 739, findFile(root, "ABS.TXT") ? "ABS.TXT" : "", 37);
+    writeString(sector + 776, findFile(root, "BIB.TXT") ? "BIB.TXT" : "", 37);
+
+    strftime(date, sizeof(date), "%Y%m%d%H%M%S00", &g_BuildTime);
+    memcpy(sector + 813, date, 16); // creation
+    memcpy(sector + 830, date, 16); // modification
+    memset(sector + 847, '0', 16); // expiration
+    memset(sector + 864, '0', 16); // effective
+    sector[881] = 1; // file structure version
+
+    result = writeSectors(fp, sector, SECTOR_SIZE);
+    if(result != 0)
+    {
+        return result;
+    }
+
+    memset(sector, 0, SECTOR_SIZE);
+    sector[0] = 255;
+    memcpy(sector + 1, "CD001", 5);
+    sector[6] = 1;
+
+    return writeSectors(fp, sector, SECTOR_SIZE);
+}
+
+// little-endian and big-endian path tables, each with the root and SATSAVES
+static int writePathTables(FILE* fp, PISO_DIRECTORY root, PISO_DIRECTORY saves)
+{
+    unsigned char sector[SECTOR_SIZE] = {0};
+    unsigned int nameLen = strlen(SAVES_DIRECTORY);
+    int result = 0;
+
+    for(int bigEndian = 0; bigEndian <= 1; bigEndian++)
+    {
+        void (*write16)(unsigned char*, unsigned int) = bigEndian ? writeBigEndian16 : writeLittleEndian16;
+        void (*write32)(unsigned char*, unsigned int) = bigEndian ? writeBigEndian32 : writeLittleEndian32;
+
+        memset(sector, 0, SECTOR_SIZE);
+
+        // root
+        sector[0] = 1;
+        write32(sector + 2, root->lba);
+        write16(sector + 6, 1);
+
+        // SATSAVES, parent is directory 1 (root)
+        sector[10] = nameLen;
+        write32(sector + 12, saves->lba);
+        write16(sector + 16, 1);
+        memcpy(sector + 18, SAVES_DIRECTORY, nameLen);
+
+        result = writeSectors(fp, sector, SECTOR_SIZE);
+        if(result != 0)
+        {
+            return result;
+        }
+    }
+
+    return 0;
+}
+
+// writes the directory records, see directorySize()
+static int writeDirectory(FILE* fp, PISO_DIRECTORY dir, PISO_DIRECTORY parent)
+{
+    unsigned char* buffer = NULL;
+    unsigned int offset = 0;
+    int result = 0;
+
+    buffer = calloc(1, dir->size);
+    if(buffer == NULL)
+    {
+        fprintf(stderr, "Out of memory\n");
+        return -1;
+    }
+
+    offset += writeRecord(buffer + offset, "\0", 1, dir->lba, dir->size, ISO_FLAG_DIRECTORY);
+    offset += writeRecord(buffer + offset, "\1", 1, parent->lba, parent->size, ISO_FLAG_DIRECTORY);
+
+    for(unsigned int i = 0; i < dir->numFiles; i++)
+    {
+        PISO_FILE file = &dir->files[i];
+        char name[MAX_ISO_NAME + 2] = {0};
+        unsigned int nameLen = 0;
+
+        if(file->flags & ISO_FLAG_DIRECTORY)
+        {
+            nameLen = snprintf(name, sizeof(name), "%s", file->name);
+        }
+        else
+        {
+            nameLen = snprintf(name, sizeof(name), "%s;1", file->name);
+        }
+
+        if((offset % SECTOR_SIZE) + recordSize(file->name, file->flags) > SECTOR_SIZE)
+        {
+            offset = sectorCount(offset) * SECTOR_SIZE;
+        }
+
+        offset += writeRecord(buffer + offset, name, nameLen, file->lba, file->size, file->flags);
+    }
+
+    result = writeSectors(fp, buffer, dir->size);
+    free(buffer);
+
+    return result;
+}
+
+// writes the file contents in the order layoutFiles() assigned sectors
+static int writeFiles(FILE* fp, PISO_DIRECTORY dir, int generated)
+{
+    unsigned char* buffer = NULL;
+    int result = 0;
+
+    for(unsigned int i = 0; i < dir->numFiles && result == 0; i++)
+    {
+        PISO_FILE file = &dir->files[i];
+        FILE* input = NULL;
+
+        if((file->flags & ISO_FLAG_DIRECTORY) || (file->data != NULL) != generated)
+        {
+            continue;
+        }
+
+        if(ftell(fp) != (long)file->lba * SECTOR_SIZE)
+        {
+            fprintf(stderr, "Layout error at %s\n", file->name);
+            result = -1;
+            break;
+        }
+
+        if(file->data != NULL)
+        {
+            result = writeSectors(fp, file->data, file->size);
+            continue;
+        }
+
+        buffer = malloc(file->size ? file->size : 1);
+        if(buffer == NULL)
+        {
+            fprintf(stderr, "Out of memory\n");
+            return -2;
+        }
+
+        input = fopen(file->path, "rb");
+        if(input == NULL || fread(buffer, 1, file->size, input) != file->size)
+        {
+            fprintf(stderr, "Failed to read %s\n", file->path);
+            result = -3;
+        }
+        else
+        {
+            result = writeSectors(fp, buffer, file->size);
+        }
+
+        if(input != NULL)
+        {
+            fclose(input);
+        }
+
+        free(buffer);
+    }
+
+    return result;
+}
+
+// writes the data padded to a whole number of sectors
+static int writeSectors(FILE* fp, const unsigned char* data, unsigned int size)
+{
+    static const unsigned char padding[SECTOR_SIZE] = {0};
+    unsigned int remainder = size % SECTOR_SIZE;
+
+    if(size && fwrite(data, size, 1, fp) != 1)
+    {
+        return -1;
+    }
+
+    if(remainder && fwrite(padding, SECTOR_SIZE - remainder, 1, fp) != 1)
+    {
+        return -2;
+    }
+
+    return 0;
+}
@@ -0,0 +1,153 @@
+// sgcpack - packs a .BUP into a packed .BUP or unpacks one, see bup_pack.h
+// Host tool. SGC unpacks packed saves when reading them from any device, so
+// packed saves take less room on the Satiator, MODE or a custom CD
+//
+// usage: sgcpack [-d] <input .BUP> <output .BUP>
+//
+// Built from the same bup_pack.c as SGC with the host shims of the simulator:
+// make -C tools/sgcsim sgcpack
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../bup_pack.h"
+
+#define MAX_BUP_SIZE (64 + 512 * 1024)
+
+static unsigned char* readFile(const char* path, unsigned int* size);
+static int writeFile(const char* path, const unsigned char* data, unsigned int size);
+
+int main(int argc, char** argv)
+{
+    unsigned char* input = NULL;
+    unsigned char* output = NULL;
+    BUP_VIEW view = {0};
+    unsigned int inputSize = 0;
+    unsigned int outputSize = 0;
+    unsigned int goodChunks = 0;
+    int unpack = 0;
+    int result = 0;
+
+    if(argc == 4 && strcmp(argv[1], "-d") == 0)
+    {
+        unpack = 1;
+        argv++;
+    }
+    else if(argc != 3)
+    {
+        fprintf(stderr, "usage: %s [-d] <input .BUP> <output .BUP>\n", argv[0]);
+        return 1;
+    }
+
+    input = readFile(argv[1], &inputSize);
+    if(input == NULL)
+    {
+        return 1;
+    }
+
+    output = calloc(1, MAX_BUP_SIZE);
+    if(output == NULL)
+    {
+        fprintf(stderr, "Failed to allocate output buffer\n");
+        free(input);
+        return 1;
+    }
+
+    if(unpack)
+    {
+        result = bup_unpack(input, inputSize, output, MAX_BUP_SIZE, &goodChunks);
+        if(result != 0)
+        {
+            fprintf(stderr, "%s: bad packed save at chunk %u (%d)\n", argv[1], goodChunks, result);
+            goto exit;
+        }
+
+        bup_view_init(&view, output, BUP_HEADER_SIZE);
+        outputSize = BUP_HEADER_SIZE + bup_view_datasize(&view);
+    }
+    else
+    {
+        result = bup_pack(input, inputSize, output, MAX_BUP_SIZE, &outputSize);
+        if(result == 1)
+        {
+            fprintf(stderr, "%s doesn't get smaller, keep it as is\n", argv[1]);
+            goto exit;
+        }
+        else if(result != 0)
+        {
+            fprintf(stderr, "%s isn't a plain .BUP (%d)\n", argv[1], result);
+            goto exit;
+        }
+    }
+
+    result = writeFile(argv[2], output, outputSize);
+    if(result == 0)
+    {
+        printf("%s: %u -> %u bytes\n", argv[2], inputSize, outputSize);
+    }
+
+exit:
+    free(input);
+    free(output);
+
+    return result == 0 ? 0 : 1;
+}
+
+// reads the whole file plus 2 zero bytes, RLE01 may look ahead past the end
+static unsigned char* readFile(const char* path, unsigned int* size)
+{
+    unsigned char* data = NULL;
+    FILE* file = NULL;
+    long length = 0;
+
+    file = fopen(path, "rb");
+    if(file == NULL)
+    {
+        fprintf(stderr, "Failed to open %s\n", path);
+        return NULL;
+    }
+
+    fseek(file, 0, SEEK_END);
+    length = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    if(length < BUP_HEADER_SIZE || length > MAX_BUP_SIZE)
+    {
+        fprintf(stderr, "%s is not a .BUP\n", path);
+        fclose(file);
+        return NULL;
+    }
+
+    data = calloc(1, length + 2);
+    if(data == NULL || fread(data, 1, length, file) != (size_t)length)
+    {
+        fprintf(stderr, "Failed to read %s\n", path);
+        free(data);
+        fclose(file);
+        return NULL;
+    }
+
+    fclose(file);
+
+    *size = (unsigned int)length;
+    return data;
+}
+
+static int writeFile(const char* path, const unsigned char* data, unsigned int size)
+{
+    FILE* file = NULL;
+
+    file = fopen(path, "wb");
+    if(file == NULL || fwrite(data, 1, size, file) != size)
+    {
+        fprintf(stderr, "Failed to write %s\n", path);
+        if(file != NULL)
+        {
+            fclose(file);
+        }
+        return -1;
+    }
+
+    fclose(file);
+    return 0;
+}
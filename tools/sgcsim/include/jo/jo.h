@@ -0,0 +1,192 @@
+/*
+ * jo.h - host stand-in for the parts of Jo Engine and SGL that SGC uses
+ *
+ * The functions are implemented by the simulators in tools/sgcsim.
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef unsigned char Uint8;
+typedef signed char Sint8;
+typedef unsigned short Uint16;
+typedef signed short Sint16;
+typedef unsigned int Uint32;
+typedef signed int Sint32;
+typedef int Bool;
+
+#define JO_NULL                 ((void*)0)
+#define JO_PARENT_DIR           ".."
+#define JO_ZERO(x)              x = 0
+#define JO_COLOR_Black          0
+#define JO_COLOR_Blue           1
+#define JO_COLOR_INDEX_Red      2
+
+#ifndef MIN
+#define MIN(a, b)               ((a) < (b) ? (a) : (b))
+#endif
+#ifndef MAX
+#define MAX(a, b)               ((a) > (b) ? (a) : (b))
+#endif
+
+// core
+void jo_core_init(int color);
+// SGC is built with the Jo Engine printf module
+#define JO_COMPILE_WITH_PRINTF_SUPPORT
+void jo_printf(int x, int y, const char* format, ...);
+void jo_printf_with_color(int x, int y, int color, const char* format, ...);
+void jo_set_printf_color_index(int index);
+void jo_clear_screen(void);
+void jo_vdp2_clear_bitmap_nbg1(int color);
+unsigned int jo_get_ticks(void);
+void slSynch(void);
+
+// memory
+void* jo_malloc(unsigned int size);
+void jo_free(void* p);
+void jo_memset(void* dst, int value, unsigned int size);
+int jo_memory_usage_percent(void);
+
+// input
+enum
+{
+    JO_KEY_UP, JO_KEY_DOWN, JO_KEY_LEFT, JO_KEY_RIGHT,
+    JO_KEY_A, JO_KEY_B, JO_KEY_C, JO_KEY_X, JO_KEY_Y, JO_KEY_Z,
+    JO_KEY_L, JO_KEY_R, JO_KEY_START
+};
+void jo_input_update(void);
+void jo_wait_vblank_out(void);
+void jo_wait_vblank_in(void);
+bool jo_is_pad1_available(void);
+bool jo_is_pad1_key_pressed(int key);
+bool jo_is_pad1_key_down(int key);
+
+// lists
+#define JO_LIST_DATA_SIZE       32
+
+typedef union
+{
+    char ch_arr[JO_LIST_DATA_SIZE];
+    void* ptr;
+} jo_list_data;
+
+typedef struct __jo_node
+{
+    jo_list_data data;
+    struct __jo_node* next;
+} jo_node;
+
+typedef struct
+{
+    int count;
+    jo_node* first;
+    jo_node* last;
+} jo_list;
+
+void jo_list_init(jo_list* list);
+jo_node* jo_list_add(jo_list* list, jo_list_data data);
+jo_node* jo_list_at(jo_list* list, int index);
+void jo_list_free_and_clear(jo_list* list);
+
+// backup memory
+typedef enum
+{
+    JoInternalMemoryBackup = 0,
+    JoCartridgeMemoryBackup = 1,
+    JoExternalDeviceBackup = 2
+} jo_backup_device;
+
+typedef struct
+{
+    jo_backup_device backup_device;
+    char* fname;
+    char* comment;
+    void* contents;
+    unsigned int content_size;
+    unsigned char language_num;
+    unsigned int save_timestamp;
+} jo_backup;
+
+bool jo_backup_mount(jo_backup_device device);
+bool jo_backup_unmount(jo_backup_device device);
+bool jo_backup_read_device(jo_backup_device device, jo_list* filenames);
+bool jo_backup_get_file_info(jo_backup_device device, const char* fname, char* comment, unsigned char* language, unsigned int* date, unsigned int* numBytes, unsigned int* numBlocks);
+unsigned int jo_backup_get_free_block_count(jo_backup_device device);
+void* jo_backup_load_file_contents(jo_backup_device device, const char* fname, unsigned int* length);
+bool jo_backup_save(jo_backup* backup);
+bool jo_backup_delete_file(jo_backup_device device, const char* fname);
+bool jo_backup_format_device(jo_backup_device device);
+
+// file system
+typedef void* GfsHn;
+
+typedef struct
+{
+    Sint32 fad;
+    Sint32 size;
+    Uint8 unit;
+    Uint8 gap;
+    Uint8 fn;
+    Uint8 atr;
+} GfsFinfo;
+
+#define GFS_FNAME_LEN           12
+
+typedef struct
+{
+    GfsFinfo dirrec;
+    Sint8 fname[GFS_FNAME_LEN];
+} GfsDirId;
+
+typedef struct
+{
+    Sint32 fid;
+    GfsFinfo finfo;
+    Sint8 fname[GFS_FNAME_LEN];
+} GfsDirName;
+
+typedef struct
+{
+    Sint32 type;
+    Sint32 ndir;
+    union
+    {
+        GfsDirId* dir_i;
+        GfsDirName* dir_n;
+    } dir;
+} GfsDirTbl;
+
+#define GFS_DIR_ID              0
+#define GFS_DIR_NAME            2
+#define GFS_DIRTBL_TYPE(tbl)    ((tbl)->type)
+#define GFS_DIRTBL_NDIR(tbl)    ((tbl)->ndir)
+#define GFS_DIRTBL_DIRID(tbl)   ((tbl)->dir.dir_i)
+#define GFS_DIRTBL_DIRNAME(tbl) ((tbl)->dir.dir_n)
+#define GFS_WORK_SIZE(open_max) (256 + (open_max) * 256)
+
+#define GFS_ATR_DIR             0x80 // directory record attribute
+#define GFS_ERR_OK              0
+#define GFS_ERR_FID             (-4)
+
+typedef struct
+{
+    int id;
+    int size;
+    int read;
+    GfsHn handle;
+} jo_file;
+
+Sint32 GFS_Init(Sint32 open_max, void* work, GfsDirTbl* dirtbl);
+GfsHn GFS_Open(Sint32 fid);
+void GFS_Close(GfsHn gfs);
+Sint32 GFS_NameToId(Sint8* name);
+const char* GFS_IdToName(Sint32 fid);
+Sint32 GFS_GetFileInfo(GfsHn gfs, Sint32* fid, Sint32* fn, Sint32* fsize, Sint32* atr);
+Sint32 GFS_GetDirInfo(Sint32 fid, GfsDirId* dirrec);
+Sint32 GFS_Fread(GfsHn gfs, Sint32 nsct, void* buf, Sint32 bsize);
+
+bool jo_fs_cd(const char* sub_dir);
+bool jo_fs_open(jo_file* file, const char* filename);
+int jo_fs_read_next_bytes(jo_file* file, char* buffer, unsigned int nbytes);
+void jo_fs_close(jo_file* file);
@@ -0,0 +1,24 @@
+// host stand-in for the NetLink modem driver
+#pragma once
+
+#include <stdbool.h>
+
+typedef struct
+{
+    int base;
+} saturn_uart16550_t;
+
+enum
+{
+    MODEM_OK = 0,
+    MODEM_CONNECT,
+    MODEM_ERROR,
+};
+
+bool modem_is_present(void);
+bool modem_get_uart(saturn_uart16550_t* uart);
+int modem_probe(saturn_uart16550_t* uart);
+int modem_init(saturn_uart16550_t* uart);
+int modem_dial(saturn_uart16550_t* uart, const char* number, unsigned int timeout);
+void modem_flush_input(saturn_uart16550_t* uart);
+int modem_send_bytes(saturn_uart16550_t* uart, const unsigned char* data, unsigned int size);
@@ -0,0 +1,5 @@
+// host stand-in for the Jo Engine serial port driver
+#pragma once
+
+int jo_serial_async_init(void);
+int jo_serial_send_byte(unsigned char data);
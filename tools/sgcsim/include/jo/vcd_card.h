@@ -0,0 +1,5 @@
+// host stand-in for the Jo Engine Video CD card driver
+#pragma once
+
+int jo_vcd_card_is_present(void);
+int jo_vcd_card_get_vcd_card_rom(int sector, int numSectors, unsigned char* buffer, unsigned int size);
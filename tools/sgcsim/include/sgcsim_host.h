@@ -0,0 +1,33 @@
+/*
+ * sgcsim_host.h - force included into every file of the host build
+ *
+ * SGC declares a few libc functions itself with the SH2's 32-bit size_t
+ * (md5/md5.h, main.h, bup_header.c). Those prototypes conflict with the
+ * host's libc, so the calls are routed to 32-bit wrappers in sim_core.c.
+ */
+#pragma once
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define memcpy  sgcsim_memcpy
+#define memset  sgcsim_memset
+#define memcmp  sgcsim_memcmp
+#define strncpy sgcsim_strncpy
+
+void* sgcsim_memcpy(void* dest, const void* src, unsigned int n);
+void* sgcsim_memset(void* s, int c, unsigned int n);
+int sgcsim_memcmp(const void* s1, const void* s2, unsigned int n);
+char* sgcsim_strncpy(char* dest, const char* src, unsigned int n);
+
+// cartridge memory the RAM disk and Action Replay backends probe, see sim_cart.c
+extern unsigned char g_SimCartId;
+extern unsigned short g_SimCartEnable;
+extern unsigned char g_SimCartRam[];
+extern unsigned char g_SimCartridge[];
+
+#define RAMDISK_CART_ID_ADDRESS     (&g_SimCartId)
+#define RAMDISK_CART_ENABLE         (&g_SimCartEnable)
+#define RAMDISK_CART_RAM            (g_SimCartRam)
+#define CARTRIDGE_MEMORY            (g_SimCartridge)
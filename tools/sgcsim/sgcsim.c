@@ -0,0 +1,1483 @@
+// sgcsim - runs the SGC backends against simulated devices on the host
+// The backends, copy engine, batch copy and verify are compiled unchanged
+// and driven through backend.c like main.c does. See sim.h
+//
+// usage: sgcsim [-v] [-m <heap bytes>] [-d <device>:<key>=<value>]... [scenario]...
+//
+// Options apply to every scenario, e.g. "-d satiator:maxread=300" or
+// "-d cd:rate=150". Exits non-zero if a check failed or a simulator caught a
+// backend breaking the hardware's rules.
+#include <stdarg.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <jo/jo.h>
+#include "../../backends/backend.h"
+#include "../../backends/cdindex.h"
+#include "../../backends/dircache.h"
+#include "../../backends/ramdisk.h"
+#include "../../backends/session.h"
+#include "../../backends/stats.h"
+#include "../../backends/satiator/satiator.h"
+#include "../../copy.h"
+#include "../../batch.h"
+#include "../../bup_pack.h"
+#include "../../verify.h"
+#include "sim.h"
+
+#define SGCSIM_MAX_OPTIONS      32
+#define SGCSIM_BUFFER_SIZE      (sizeof(BUP_HEADER) + MAX_SAVE_SIZE)
+
+typedef struct _SCENARIO
+{
+    const char* name;
+    const char* description;
+    void (*run)(void);
+} SCENARIO;
+
+// a save the scenarios write and expect to read back
+typedef struct _TEST_SAVE
+{
+    const char* filename; // .BUP filename, 8.3 so it also works on the CD
+    const char* name; // save name in the .BUP header
+    unsigned int datasize;
+} TEST_SAVE;
+
+static void scenarioBackup(void);
+static void scenarioSatiator(void);
+static void scenarioSatiatorFaults(void);
+static void scenarioSatiatorSync(void);
+static void scenarioMode(void);
+static void scenarioCd(void);
+static void scenarioRamdisk(void);
+static void scenarioCopy(void);
+static void scenarioBatch(void);
+static void scenarioPacked(void);
+static void scenarioLink(void);
+static void scenarioDate(void);
+
+static const SCENARIO g_Scenarios[] =
+{
+    {"backup", "internal and cartridge memory list/read/write/delete/format", scenarioBackup},
+    {"satiator", "Satiator list/read/write/delete, streams and per-game folders", scenarioSatiator},
+    {"satiator-faults", "Satiator writes that fail part way keep the old save", scenarioSatiatorFaults},
+    {"satiator-sync", "Satiator writes sync once per save, timed against syncing every chunk", scenarioSatiatorSync},
+    {"mode", "MODE list/read/write/delete and streams", scenarioMode},
+    {"cd", "CD listing with and without INDEX.BIN, folders and streams", scenarioCd},
+    {"ramdisk", "RAM disk list/read/write/delete and streams", scenarioRamdisk},
+    {"copy", "copy engine between every pair of file devices", scenarioCopy},
+    {"batch", "batch copy from several devices followed by a verify", scenarioBatch},
+    {"packed", "saves packed by tools/sgcpack read back plain from every file device", scenarioPacked},
+    {"link", "serial and modem transfers arrive intact", scenarioLink},
+    {"date", "bup_getdate() matches the loop it replaced for every day", scenarioDate},
+};
+
+// .BUP files written by the scenarios, sizes exercise partial chunks and sectors
+static const TEST_SAVE g_Saves[] =
+{
+    {"TINY.BUP", "TINY", 1},
+    {"SECTOR.BUP", "SECTOR", 2048 - sizeof(BUP_HEADER)},
+    {"ODD.BUP", "ODD_SIZE", 12345},
+    {"LARGE.BUP", "LARGE_SAVE", 200 * 1024 + 7},
+};
+
+static const char* g_Options[SGCSIM_MAX_OPTIONS];
+static unsigned int g_NumOptions = 0;
+static unsigned int g_HeapLimit = 0;
+static char g_WorkDir[SIM_MAX_PATH] = {0};
+
+static unsigned int g_Checks = 0;
+static unsigned int g_Failures = 0;
+
+static unsigned char* g_Expected = NULL;
+static unsigned char* g_Buffer = NULL; // main.c's save buffer, taken from the simulated heap
+static unsigned char* g_StreamBuffer = NULL; // lent to streams of devices that can't stream
+static SAVES g_Listing[MAX_SAVES];
+
+#define CHECK(condition, ...) check((condition), __LINE__, __VA_ARGS__)
+
+static void check(bool passed, int line, const char* format, ...)
+{
+    va_list args;
+
+    g_Checks++;
+
+    if(passed)
+    {
+        return;
+    }
+
+    g_Failures++;
+
+    printf("    FAIL line %d: ", line);
+    va_start(args, format);
+    vprintf(format, args);
+    va_end(args);
+    printf("\n");
+
+    if(simLastError()[0] != '\0')
+    {
+        printf("      last error: %s\n", simLastError());
+    }
+}
+
+static const char* deviceName(int backupDevice)
+{
+    char* name = NULL;
+
+    getBackupDeviceName(backupDevice, &name);
+    return name;
+}
+
+//
+// test data
+//
+
+// builds a .BUP with a valid header and data derived from the save name
+// returns the size of the .BUP
+static unsigned int makeSave(const TEST_SAVE* save, unsigned char* buffer)
+{
+    unsigned int seed = 0;
+
+    memset(buffer, 0, sizeof(BUP_HEADER));
+    memcpy(buffer + BUP_OFFSET_MAGIC, VMEM_MAGIC_STRING, VMEM_MAGIC_STRING_LEN);
+    strncpy((char*)buffer + BUP_OFFSET_NAME, save->name, JO_BACKUP_MAX_FILENAME_LENGTH - 1);
+    strncpy((char*)buffer + BUP_OFFSET_COMMENT, "sgcsim", JO_BACKUP_MAX_COMMENT_LENGTH);
+    buffer[BUP_OFFSET_LANGUAGE] = backup_english;
+
+    // 2025-06-15 12:30
+    bup_set_date(buffer, 23674350);
+    bup_set_datasize(buffer, save->datasize);
+    bup_set_blocksize(buffer, (save->datasize + 63) / 64);
+
+    for(const char* c = save->name; *c; c++)
+    {
+        seed = seed * 31 + *c;
+    }
+
+    for(unsigned int i = 0; i < save->datasize; i++)
+    {
+        seed = seed * 1103515245 + 12345;
+        buffer[sizeof(BUP_HEADER) + i] = seed >> 16;
+    }
+
+    return sizeof(BUP_HEADER) + save->datasize;
+}
+
+// the BIOS devices store the data without the .BUP header and only keep
+// the date to the minute, so the .BUP read back differs in the header
+static unsigned int compareSize(int backupDevice)
+{
+    return hasBackupDeviceCapability(backupDevice, BACKUP_CAP_SAVE_NAME) ? 0 : sizeof(BUP_HEADER);
+}
+
+static bool sameSave(int backupDevice, const unsigned char* a, const unsigned char* b, unsigned int size)
+{
+    unsigned int start = sizeof(BUP_HEADER) - compareSize(backupDevice);
+
+    if(memcmp(a + BUP_OFFSET_NAME, b + BUP_OFFSET_NAME, JO_BACKUP_MAX_FILENAME_LENGTH) != 0)
+    {
+        return false;
+    }
+
+    if(bup_view_init(&(BUP_VIEW){0}, b, size) != 0)
+    {
+        return false;
+    }
+
+    for(unsigned int i = start; i < size; i++)
+    {
+        // the block count is in the units of the device the save came from
+        if(i == BUP_OFFSET_BLOCKSIZE || i == BUP_OFFSET_BLOCKSIZE + 1)
+        {
+            continue;
+        }
+
+        if(a[i] != b[i])
+        {
+            simLog("first difference at offset %u: %02x instead of %02x", i, b[i], a[i]);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// the name a device addresses a save by, see batchAdd()
+static char* saveAddress(int backupDevice, const TEST_SAVE* save)
+{
+    return (char*)(hasBackupDeviceCapability(backupDevice, BACKUP_CAP_SAVE_NAME) ? save->name : save->filename);
+}
+
+static PSAVES findListed(unsigned int count, const char* name)
+{
+    for(unsigned int i = 0; i < count; i++)
+    {
+        if(strcmp(g_Listing[i].name, name) == 0)
+        {
+            return &g_Listing[i];
+        }
+    }
+
+    return NULL;
+}
+
+static int list(int backupDevice)
+{
+    memset(g_Listing, 0, sizeof(g_Listing));
+    return listSaveFiles(backupDevice, g_Listing, MAX_SAVES);
+}
+
+//
+// host directories behind the file devices
+//
+
+static void makeDirectory(const char* format, ...)
+{
+    char path[SIM_MAX_PATH] = {0};
+    va_list args;
+
+    va_start(args, format);
+    vsnprintf(path, sizeof(path), format, args);
+    va_end(args);
+
+    mkdir(path, 0755);
+}
+
+static void writeHostFile(const char* path, const unsigned char* data, unsigned int size)
+{
+    FILE* file = fopen(path, "wb");
+
+    if(file == NULL)
+    {
+        fprintf(stderr, "Failed to create %s\n", path);
+        exit(2);
+    }
+
+    fwrite(data, 1, size, file);
+    fclose(file);
+}
+
+static bool hostFileExists(const char* format, ...)
+{
+    char path[SIM_MAX_PATH] = {0};
+    struct stat st = {0};
+    va_list args;
+
+    va_start(args, format);
+    vsnprintf(path, sizeof(path), format, args);
+    va_end(args);
+
+    return stat(path, &st) == 0;
+}
+
+static void setRoot(int device, const char* name)
+{
+    char path[SIM_MAX_PATH * 2] = {0};
+
+    simPath(path, sizeof(path), "%s/%s", g_WorkDir, name);
+    simSetRoot(device, path);
+}
+
+// empties the device directories so every scenario starts from blank media
+static void resetWorld(void)
+{
+    char command[SIM_MAX_PATH + 32] = {0};
+
+    snprintf(command, sizeof(command), "rm -rf '%s'/*", g_WorkDir);
+    if(system(command) != 0)
+    {
+        fprintf(stderr, "Failed to clean %s\n", g_WorkDir);
+        exit(2);
+    }
+
+    makeDirectory("%s/satiator", g_WorkDir);
+    makeDirectory("%s/mode", g_WorkDir);
+    makeDirectory("%s/mode/" SAVES_DIRECTORY, g_WorkDir);
+    makeDirectory("%s/cd", g_WorkDir);
+    makeDirectory("%s/cd/" SAVES_DIRECTORY, g_WorkDir);
+
+    simReset();
+    simBackupReset();
+    simLinkReset();
+
+    for(unsigned int i = 0; i < g_NumOptions; i++)
+    {
+        simConfigure(g_Options[i]);
+    }
+
+    if(g_HeapLimit != 0)
+    {
+        simSetHeapLimit(g_HeapLimit);
+    }
+
+    // jo_main() allocates the save buffer at boot and keeps it
+    g_Buffer = jo_malloc(SGCSIM_BUFFER_SIZE);
+    if(g_Buffer == NULL)
+    {
+        fprintf(stderr, "The heap has no room for the save buffer\n");
+        exit(2);
+    }
+
+    // the backends keep their state between scenarios like they do between menus
+    sessionAcquire(SESSION_NONE);
+    for(int i = 0; i <= ModemBackup; i++)
+    {
+        if(hasBackupDeviceCapability(i, BACKUP_CAP_DIRECTORIES) && getSaveDirectory(i)[0] != '\0')
+        {
+            changeSaveDirectory(i, "..");
+        }
+
+        dirCacheInvalidate(i);
+    }
+
+    simHeapResetPeak();
+}
+
+// the CD backend reads INDEX.BIN natively, which is big-endian on the Saturn
+// the host is little-endian so the index is written in host order here
+// instead of running tools/sgcindex
+static void writeCdIndex(const char* directory, const TEST_SAVE* saves, unsigned int numSaves)
+{
+    char path[SIM_MAX_PATH] = {0};
+    unsigned int size = sizeof(CD_INDEX_HEADER) + numSaves * sizeof(CD_INDEX_ENTRY);
+    unsigned char* index = calloc(1, size);
+    PCD_INDEX_HEADER header = (PCD_INDEX_HEADER)index;
+    PCD_INDEX_ENTRY entries = (PCD_INDEX_ENTRY)(index + sizeof(CD_INDEX_HEADER));
+
+    memcpy(header->magic, CD_INDEX_MAGIC, CD_INDEX_MAGIC_LEN);
+    header->version = CD_INDEX_VERSION;
+    header->numEntries = numSaves;
+    header->entrySize = sizeof(CD_INDEX_ENTRY);
+
+    // sorted by filename like the directory table
+    for(unsigned int i = 0; i < numSaves; i++)
+    {
+        unsigned int slot = 0;
+
+        for(unsigned int j = 0; j < numSaves; j++)
+        {
+            if(strcmp(saves[j].filename, saves[i].filename) < 0)
+            {
+                slot++;
+            }
+        }
+
+        strncpy(entries[slot].filename, saves[i].filename, CD_INDEX_MAX_FILENAME - 1);
+        entries[slot].fileSize = makeSave(&saves[i], g_Expected);
+        memcpy(entries[slot].bupHeader, g_Expected, CD_INDEX_BUP_HEADER_SIZE);
+    }
+
+    simPath(path, sizeof(path), "%s/%s", directory, CD_INDEX_FILENAME);
+    writeHostFile(path, index, size);
+    free(index);
+}
+
+// sets the FAD of a save in INDEX.BIN, the index is written with every FAD unknown
+static void setCdIndexFad(const char* directory, const char* filename, unsigned int fad)
+{
+    char path[SIM_MAX_PATH] = {0};
+    CD_INDEX_HEADER header = {0};
+    CD_INDEX_ENTRY entry = {0};
+    FILE* file = NULL;
+
+    simPath(path, sizeof(path), "%s/%s", directory, CD_INDEX_FILENAME);
+    file = fopen(path, "r+b");
+    if(file == NULL || fread(&header, sizeof(header), 1, file) != 1)
+    {
+        fprintf(stderr, "Failed to open %s\n", path);
+        exit(2);
+    }
+
+    for(unsigned int i = 0; i < header.numEntries && fread(&entry, sizeof(entry), 1, file) == 1; i++)
+    {
+        if(strcmp(entry.filename, filename) == 0)
+        {
+            entry.fad = fad;
+            fseek(file, -(long)sizeof(entry), SEEK_CUR);
+            fwrite(&entry, sizeof(entry), 1, file);
+            break;
+        }
+    }
+
+    fclose(file);
+}
+
+// puts the test saves on the CD, optionally in a folder of SATSAVES
+static void writeCdSaves(const char* folder, const TEST_SAVE* saves, unsigned int numSaves, bool index)
+{
+    char directory[SIM_MAX_PATH] = {0};
+    char path[SIM_MAX_PATH * 2] = {0};
+
+    simPath(directory, sizeof(directory), "%s/cd/%s%s%s", g_WorkDir, SAVES_DIRECTORY, folder ? "/" : "", folder ? folder : "");
+    mkdir(directory, 0755);
+
+    for(unsigned int i = 0; i < numSaves; i++)
+    {
+        unsigned int size = makeSave(&saves[i], g_Expected);
+
+        simPath(path, sizeof(path), "%s/%s", directory, saves[i].filename);
+        writeHostFile(path, g_Expected, size);
+    }
+
+    if(index)
+    {
+        writeCdIndex(directory, saves, numSaves);
+    }
+}
+
+//
+// checks shared by the scenarios
+//
+
+// writes every test save that fits, lists them and reads them back
+static void roundTrip(int backupDevice, unsigned int numSaves)
+{
+    int count = 0;
+    int result = 0;
+
+    for(unsigned int i = 0; i < numSaves; i++)
+    {
+        unsigned int size = makeSave(&g_Saves[i], g_Expected);
+
+        result = writeSaveFile(backupDevice, saveAddress(backupDevice, &g_Saves[i]), g_Expected, size);
+        CHECK(result == 0, "%s: write %s failed (%d)", deviceName(backupDevice), g_Saves[i].filename, result);
+    }
+
+    count = list(backupDevice);
+    CHECK(count == (int)numSaves, "%s: listed %d saves, expected %u", deviceName(backupDevice), count, numSaves);
+
+    for(unsigned int i = 0; i < numSaves; i++)
+    {
+        unsigned int size = makeSave(&g_Saves[i], g_Expected);
+        PSAVES save = findListed(count > 0 ? count : 0, g_Saves[i].name);
+
+        CHECK(save != NULL, "%s: %s missing from the listing", deviceName(backupDevice), g_Saves[i].name);
+        if(save == NULL)
+        {
+            continue;
+        }
+
+        CHECK(save->datasize == g_Saves[i].datasize && save->status == SAVE_STATUS_VALID,
+            "%s: %s listed with %u bytes, status %d", deviceName(backupDevice), save->name, save->datasize, save->status);
+
+        memset(g_Buffer, 0, size);
+        result = readSaveFile(backupDevice, saveAddress(backupDevice, &g_Saves[i]), g_Buffer, size);
+        CHECK(result == 0 && sameSave(backupDevice, g_Expected, g_Buffer, size),
+            "%s: %s read back wrong (%d)", deviceName(backupDevice), g_Saves[i].filename, result);
+    }
+}
+
+// reads a save through the stream interface in uneven chunks
+static void streamRead(int backupDevice, const TEST_SAVE* save, unsigned int chunkSize)
+{
+    BACKUP_STREAM stream = {0};
+    unsigned int size = makeSave(save, g_Expected);
+    unsigned int offset = 0;
+    int result = 0;
+
+    memset(g_Buffer, 0, size);
+
+    result = openSaveStream(&stream, backupDevice, saveAddress(backupDevice, save), STREAM_MODE_READ, size, g_StreamBuffer, SGCSIM_BUFFER_SIZE);
+    CHECK(result == 0, "%s: open %s for reading failed (%d)", deviceName(backupDevice), save->filename, result);
+    if(result != 0)
+    {
+        return;
+    }
+
+    while(offset < size)
+    {
+        result = readSaveStream(&stream, g_Buffer + offset, MIN(chunkSize, size - offset));
+        if(result <= 0)
+        {
+            break;
+        }
+
+        offset += result;
+    }
+
+    closeSaveStream(&stream);
+
+    CHECK(offset == size && sameSave(backupDevice, g_Expected, g_Buffer, size),
+        "%s: streamed %u of %u bytes of %s, data %s", deviceName(backupDevice), offset, size, save->filename,
+        sameSave(backupDevice, g_Expected, g_Buffer, size) ? "matches" : "differs");
+}
+
+// writes a save through the stream interface in uneven chunks
+static void streamWrite(int backupDevice, const TEST_SAVE* save, unsigned int chunkSize)
+{
+    BACKUP_STREAM stream = {0};
+    unsigned int size = makeSave(save, g_Expected);
+    unsigned int offset = 0;
+    int result = 0;
+
+    result = openSaveStream(&stream, backupDevice, saveAddress(backupDevice, save), STREAM_MODE_WRITE, size, g_StreamBuffer, SGCSIM_BUFFER_SIZE);
+    CHECK(result == 0, "%s: open %s for writing failed (%d)", deviceName(backupDevice), save->filename, result);
+    if(result != 0)
+    {
+        return;
+    }
+
+    while(offset < size)
+    {
+        result = writeSaveStream(&stream, g_Expected + offset, MIN(chunkSize, size - offset));
+        if(result <= 0)
+        {
+            break;
+        }
+
+        offset += result;
+    }
+
+    result = closeSaveStream(&stream);
+    CHECK(offset == size && result == 0, "%s: streamed %u of %u bytes of %s (%d)", deviceName(backupDevice), offset, size, save->filename, result);
+
+    memset(g_Buffer, 0, size);
+    result = readSaveFile(backupDevice, saveAddress(backupDevice, save), g_Buffer, size);
+    CHECK(result == 0 && sameSave(backupDevice, g_Expected, g_Buffer, size), "%s: streamed %s read back wrong (%d)", deviceName(backupDevice), save->filename, result);
+}
+
+static void deleteAndList(int backupDevice, const TEST_SAVE* save, unsigned int expected)
+{
+    int result = deleteSaveFile(backupDevice, saveAddress(backupDevice, save));
+    int count = 0;
+
+    CHECK(result == 0, "%s: delete %s failed (%d)", deviceName(backupDevice), save->filename, result);
+
+    count = list(backupDevice);
+    CHECK(count == (int)expected && findListed(count, save->name) == NULL,
+        "%s: listed %d saves after deleting %s, expected %u", deviceName(backupDevice), count, save->name, expected);
+}
+
+// copies a save with the copy engine a frame at a time like main.c
+// the save buffer is lent to the copy like the batch does
+static void copySave(int sourceDevice, const TEST_SAVE* save, int targetDevice)
+{
+    COPY_ENGINE engine = {0};
+    unsigned int size = makeSave(save, g_Expected);
+    unsigned int frames = 0;
+    int result = 0;
+
+    result = copyStart(&engine, sourceDevice, saveAddress(sourceDevice, save), targetDevice, saveAddress(targetDevice, save), size,
+        g_Buffer, SGCSIM_BUFFER_SIZE);
+    CHECK(result == 0, "copy %s from %s to %s failed to start (%d)", save->filename, deviceName(sourceDevice), deviceName(targetDevice), result);
+    if(result != 0)
+    {
+        return;
+    }
+
+    do
+    {
+        result = copyStep(&engine);
+        slSynch();
+        frames++;
+    } while(result == 1);
+
+    result = copyEnd(&engine);
+    CHECK(result == 0, "copy %s from %s to %s failed (%d)", save->filename, deviceName(sourceDevice), deviceName(targetDevice), result);
+
+    if(g_SimVerbose || result == 0)
+    {
+        printf("    %-10s %-18s -> %-18s %4u frames %7u bytes/s\n", save->filename, deviceName(sourceDevice), deviceName(targetDevice),
+            frames, copyThroughput(&engine));
+    }
+
+    memset(g_Buffer, 0, size);
+    result = readSaveFile(targetDevice, saveAddress(targetDevice, save), g_Buffer, size);
+    CHECK(result == 0 && sameSave(targetDevice, g_Expected, g_Buffer, size), "%s: copied %s read back wrong (%d)", deviceName(targetDevice), save->filename, result);
+}
+
+//
+// scenarios
+//
+
+static void scenarioBackup(void)
+{
+    unsigned int size = 0;
+    int result = 0;
+
+    CHECK(isBackupDeviceAvailable(JoInternalMemoryBackup), "internal memory not available");
+    CHECK(isBackupDeviceAvailable(JoExternalDeviceBackup) == false, "external device found without a floppy drive");
+
+    // 32KB of internal memory fits the small saves only
+    roundTrip(JoInternalMemoryBackup, 3);
+    deleteAndList(JoInternalMemoryBackup, &g_Saves[0], 2);
+
+    size = makeSave(&g_Saves[3], g_Expected);
+    result = writeSaveFile(JoInternalMemoryBackup, (char*)g_Saves[3].name, g_Expected, size);
+    CHECK(result != 0, "internal memory accepted a save larger than the device");
+
+    result = formatDevice(JoInternalMemoryBackup);
+    CHECK(result == 0 && list(JoInternalMemoryBackup) == 0, "internal memory not empty after formatting (%d)", result);
+
+    roundTrip(JoCartridgeMemoryBackup, COUNTOF(g_Saves));
+    streamRead(JoCartridgeMemoryBackup, &g_Saves[2], 1000);
+    streamWrite(JoCartridgeMemoryBackup, &g_Saves[2], 3000);
+}
+
+static void scenarioSatiator(void)
+{
+    char command[SIM_MAX_PATH + 32] = {0};
+    char path[SIM_MAX_PATH * 2] = {0};
+    PSAVES save = NULL;
+    unsigned int size = 0;
+    unsigned int bytesRead = 0;
+    unsigned int errors = 0;
+    int count = 0;
+
+    CHECK(isBackupDeviceAvailable(SatiatorBackup), "Satiator not available");
+    CHECK(hostFileExists("%s/satiator/" SAVES_DIRECTORY, g_WorkDir), "/" SAVES_DIRECTORY " wasn't created");
+
+    roundTrip(SatiatorBackup, COUNTOF(g_Saves));
+
+    // replacing a save goes through the temporary file and the backup rename
+    streamWrite(SatiatorBackup, &g_Saves[2], 1000);
+    CHECK(hostFileExists("%s/satiator/" SAVES_DIRECTORY "/ODD.BUP~", g_WorkDir) == false, "backup of the replaced save left behind");
+
+    streamRead(SatiatorBackup, &g_Saves[3], 5000);
+    streamRead(SatiatorBackup, &g_Saves[1], 100);
+    deleteAndList(SatiatorBackup, &g_Saves[0], COUNTOF(g_Saves) - 1);
+
+    // per-game folders
+    makeDirectory("%s/satiator/" SAVES_DIRECTORY "/GAME", g_WorkDir);
+    dirCacheInvalidate(SatiatorBackup);
+
+    count = list(SatiatorBackup);
+    CHECK(count == COUNTOF(g_Saves) && g_Listing[0].directory, "GAME folder not listed first (%d entries)", count);
+
+    CHECK(changeSaveDirectory(SatiatorBackup, "GAME") == 0, "failed to enter GAME");
+    roundTrip(SatiatorBackup, 2);
+    CHECK(hostFileExists("%s/satiator/" SAVES_DIRECTORY "/GAME/TINY.BUP", g_WorkDir), "save not written to the GAME folder");
+    CHECK(changeSaveDirectory(SatiatorBackup, "..") == 0, "failed to leave GAME");
+
+    count = list(SatiatorBackup);
+    CHECK(count == COUNTOF(g_Saves) && findListed(count, "TINY") == NULL, "GAME saves listed in SATSAVES (%d entries)", count);
+
+    // listing again only walks the folder, the headers are cached by directory entry
+    bytesRead = g_SimDevices[SIM_SATIATOR].bytesRead;
+    count = list(SatiatorBackup);
+    CHECK(count == COUNTOF(g_Saves) && g_SimDevices[SIM_SATIATOR].bytesRead == bytesRead,
+        "listing again read %u bytes of headers", g_SimDevices[SIM_SATIATOR].bytesRead - bytesRead);
+
+    // a save changed on a PC shows up without leaving the folder
+    size = makeSave(&g_Saves[2], g_Expected);
+    memcpy(g_Expected + BUP_OFFSET_COMMENT, "from a PC", 9);
+    simPath(path, sizeof(path), "%s/satiator/" SAVES_DIRECTORY "/%s", g_WorkDir, g_Saves[2].filename);
+    writeHostFile(path, g_Expected, size);
+
+    count = list(SatiatorBackup);
+    save = findListed(count, g_Saves[2].name);
+    CHECK(save != NULL && strcmp(save->comment, "from a PC") == 0, "save changed on a PC listed with comment '%s'", save ? save->comment : "");
+
+    // a fresh SD card doesn't have the GAME folder SGC was in
+    CHECK(changeSaveDirectory(SatiatorBackup, "GAME") == 0 && list(SatiatorBackup) == 2, "failed to enter GAME again");
+    sessionRelease();
+    snprintf(command, sizeof(command), "rm -rf '%s/satiator/" SAVES_DIRECTORY "'", g_WorkDir);
+    CHECK(system(command) == 0, "failed to swap the SD card");
+
+    count = list(SatiatorBackup);
+    CHECK(count == 0 && getSaveDirectory(SatiatorBackup)[0] == '\0', "new SD card listed %d entries in folder '%s'",
+        count, getSaveDirectory(SatiatorBackup));
+
+    // leaving Satiator mode hands the CD back
+    errors = simErrors();
+    CHECK(isBackupDeviceAvailable(CdMemoryBackup) && list(CdMemoryBackup) == 0 && simErrors() == errors, "CD unusable after the Satiator");
+}
+
+static void scenarioSatiatorFaults(void)
+{
+    char path[SIM_MAX_PATH * 2] = {0};
+    unsigned int violations = 0;
+    unsigned int size = 0;
+    int result = 0;
+
+    roundTrip(SatiatorBackup, 3);
+
+    // a write failing part way must leave the old save alone
+    size = makeSave(&g_Saves[2], g_Expected);
+    g_Expected[sizeof(BUP_HEADER)] ^= 0xFF;
+    simConfigure("satiator:fail=write:3");
+    result = writeSaveFile(SatiatorBackup, (char*)g_Saves[2].filename, g_Expected, size);
+    CHECK(result != 0, "write with a failing s_write() succeeded");
+    CHECK(hostFileExists("%s/satiator/" SAVES_DIRECTORY "/SGCWRITE.TMP", g_WorkDir) == false, "temporary file left behind");
+
+    makeSave(&g_Saves[2], g_Expected);
+    result = readSaveFile(SatiatorBackup, (char*)g_Saves[2].filename, g_Buffer, size);
+    CHECK(result == 0 && sameSave(SatiatorBackup, g_Expected, g_Buffer, size), "old save damaged by a failed write (%d)", result);
+
+    // failing to move the new save into place restores the old one
+    g_Expected[sizeof(BUP_HEADER)] ^= 0xFF;
+    simConfigure("satiator:fail=rename:2");
+    result = writeSaveFile(SatiatorBackup, (char*)g_Saves[2].filename, g_Expected, size);
+    CHECK(result != 0, "write with a failing s_rename() succeeded");
+
+    makeSave(&g_Saves[2], g_Expected);
+    result = readSaveFile(SatiatorBackup, (char*)g_Saves[2].filename, g_Buffer, size);
+    CHECK(result == 0 && sameSave(SatiatorBackup, g_Expected, g_Buffer, size), "old save lost by a failed rename (%d)", result);
+
+    // short reads
+    simConfigure("satiator:fail=none:0");
+    simConfigure("satiator:maxread=301");
+    streamRead(SatiatorBackup, &g_Saves[2], 4096);
+    streamRead(SatiatorBackup, &g_Saves[1], 777);
+
+    size = makeSave(&g_Saves[2], g_Expected);
+    result = readSaveFile(SatiatorBackup, (char*)g_Saves[2].filename, g_Buffer, size);
+    CHECK(result == 0 && sameSave(SatiatorBackup, g_Expected, g_Buffer, size), "short reads corrupted the save (%d)", result);
+
+    // an empty .BUP fails its header read but must still be closed
+    simPath(path, sizeof(path), "%s/satiator/" SAVES_DIRECTORY "/EMPTY.BUP", g_WorkDir);
+    writeHostFile(path, g_Expected, 0);
+    dirCacheInvalidate(SatiatorBackup);
+
+    violations = g_SimDevices[SIM_SATIATOR].violations;
+    list(SatiatorBackup);
+    sessionRelease();
+    CHECK(g_SimDevices[SIM_SATIATOR].violations == violations, "listing an empty .BUP left it open");
+}
+
+// writes the save like satiatorWriteSaveFile() did before syncing once per
+// save: s_sync() after every S_MAXBUF chunk
+static unsigned long long writeSyncingChunks(const unsigned char* data, unsigned int size)
+{
+    unsigned long long start = simMicros();
+    int fd = 0;
+
+    sessionAcquire(SESSION_SATIATOR);
+
+    fd = s_open("SYNCTEST.BUP", FA_WRITE | FA_CREATE_ALWAYS);
+    CHECK(fd >= 0, "s_open() failed (%d)", fd);
+    if(fd < 0)
+    {
+        return 0;
+    }
+
+    for(unsigned int offset = 0; offset < size; offset += S_MAXBUF)
+    {
+        s_write(fd, data + offset, MIN(size - offset, S_MAXBUF));
+        s_sync(fd);
+    }
+
+    s_close(fd);
+    start = simMicros() - start;
+    s_unlink("SYNCTEST.BUP");
+
+    return start;
+}
+
+static void scenarioSatiatorSync(void)
+{
+    const TEST_SAVE* save = &g_Saves[3];
+    unsigned int size = makeSave(save, g_Expected);
+    unsigned int chunks = (size + S_MAXBUF - 1) / S_MAXBUF;
+    unsigned long long once = 0;
+    unsigned long long everyChunk = 0;
+    unsigned int syncs = 0;
+    int result = 0;
+
+    // the first write also enters the Satiator's API mode
+    roundTrip(SatiatorBackup, 1);
+
+    syncs = g_SimDevices[SIM_SATIATOR].syncs;
+    once = simMicros();
+    result = writeSaveFile(SatiatorBackup, (char*)save->filename, g_Expected, size);
+    once = simMicros() - once;
+    syncs = g_SimDevices[SIM_SATIATOR].syncs - syncs;
+    CHECK(result == 0 && syncs == 1, "writing %s synced %u times (%d)", save->filename, syncs, result);
+
+    syncs = g_SimDevices[SIM_SATIATOR].syncs;
+    streamWrite(SatiatorBackup, save, S_MAXBUF);
+    syncs = g_SimDevices[SIM_SATIATOR].syncs - syncs;
+    CHECK(syncs == 1, "streaming %s synced %u times", save->filename, syncs);
+
+    everyChunk = writeSyncingChunks(g_Expected, size);
+
+    // only as good as the guessed sync cost, see "-d satiator:sync=<us>"
+    printf("    %u bytes in %u chunks, %u us per sync: synced once %llu ms, synced per chunk %llu ms\n", size, chunks,
+        g_SimDevices[SIM_SATIATOR].syncUs, once / 1000, everyChunk / 1000);
+}
+
+static void scenarioMode(void)
+{
+    CHECK(isBackupDeviceAvailable(MODEBackup), "MODE not available");
+
+    roundTrip(MODEBackup, COUNTOF(g_Saves));
+    streamRead(MODEBackup, &g_Saves[3], 5000);
+    streamRead(MODEBackup, &g_Saves[2], 100);
+    streamWrite(MODEBackup, &g_Saves[2], 3000);
+    deleteAndList(MODEBackup, &g_Saves[1], COUNTOF(g_Saves) - 1);
+}
+
+static void scenarioCd(void)
+{
+    static const TEST_SAVE replaced = {"ODD.BUP", "ODD_SIZE", 777};
+    static const TEST_SAVE sameSize[] =
+    {
+        {"TINY.BUP", "TINY", 1},
+        {"SECTOR.BUP", "SECTOR", 2048 - sizeof(BUP_HEADER)},
+        {"ODD.BUP", "STALE", 12345},
+        {"LARGE.BUP", "LARGE_SAVE", 200 * 1024 + 7},
+    };
+    char directory[SIM_MAX_PATH] = {0};
+    char path[SIM_MAX_PATH * 2] = {0};
+    PSAVES save = NULL;
+    unsigned int errors = 0;
+    unsigned int bytesRead = 0;
+    unsigned int size = 0;
+    int count = 0;
+    int result = 0;
+
+    simPath(directory, sizeof(directory), "%s/cd/" SAVES_DIRECTORY, g_WorkDir);
+    writeCdSaves(NULL, g_Saves, COUNTOF(g_Saves), false);
+    writeCdSaves("GAME", g_Saves, 2, true);
+
+    count = list(CdMemoryBackup);
+    CHECK(count == COUNTOF(g_Saves) + 1 && g_Listing[0].directory, "CD listed %d entries", count);
+
+    for(unsigned int i = 0; i < COUNTOF(g_Saves); i++)
+    {
+        size = makeSave(&g_Saves[i], g_Expected);
+        result = readSaveFile(CdMemoryBackup, (char*)g_Saves[i].filename, g_Buffer, size);
+        CHECK(result == 0 && sameSave(CdMemoryBackup, g_Expected, g_Buffer, size), "CD %s read back wrong (%d)", g_Saves[i].filename, result);
+    }
+
+    streamRead(CdMemoryBackup, &g_Saves[3], 8192);
+    streamRead(CdMemoryBackup, &g_Saves[2], 1000);
+
+    // with an index the listing doesn't open any save
+    writeCdSaves(NULL, g_Saves, COUNTOF(g_Saves), true);
+    dirCacheInvalidate(CdMemoryBackup);
+
+    bytesRead = g_SimDevices[SIM_CD].bytesRead;
+    count = list(CdMemoryBackup);
+    CHECK(count == COUNTOF(g_Saves) + 1, "CD listed %d entries with the index", count);
+    CHECK(g_SimDevices[SIM_CD].bytesRead - bytesRead < 2 * 2048, "indexed listing read %u bytes", g_SimDevices[SIM_CD].bytesRead - bytesRead);
+
+    CHECK(changeSaveDirectory(CdMemoryBackup, "GAME") == 0, "failed to enter GAME");
+    count = list(CdMemoryBackup);
+    CHECK(count == 2, "GAME listed %d saves", count);
+    streamRead(CdMemoryBackup, &g_Saves[1], 2048);
+    CHECK(changeSaveDirectory(CdMemoryBackup, "..") == 0, "failed to leave GAME");
+
+    CHECK(deleteSaveFile(CdMemoryBackup, (char*)g_Saves[0].filename) != 0, "deleted a save from the CD");
+
+    // a save replaced by one of a different size after the index was built
+    // releasing the CD has GFS read the changed directory table again
+    writeCdSaves(NULL, &replaced, 1, false);
+    sessionRelease();
+    dirCacheInvalidate(CdMemoryBackup);
+
+    count = list(CdMemoryBackup);
+    save = findListed(count > 0 ? count : 0, replaced.name);
+    CHECK(count == COUNTOF(g_Saves) + 1 && save != NULL && save->datasize == replaced.datasize,
+        "replaced %s listed with %u bytes from the stale index", replaced.filename, save ? save->datasize : 0);
+
+    // one of the same size is only caught by its FAD, which sgciso records
+    writeCdSaves(NULL, g_Saves, COUNTOF(g_Saves), false);
+    writeCdIndex(directory, sameSize, COUNTOF(sameSize));
+    sessionRelease();
+    dirCacheInvalidate(CdMemoryBackup);
+
+    count = list(CdMemoryBackup);
+    CHECK(findListed(count > 0 ? count : 0, sameSize[2].name) != NULL, "index without FADs not used");
+
+    setCdIndexFad(directory, sameSize[2].filename, 1);
+    dirCacheInvalidate(CdMemoryBackup);
+
+    count = list(CdMemoryBackup);
+    CHECK(count == COUNTOF(g_Saves) + 1 && findListed(count, g_Saves[2].name) != NULL && findListed(count, sameSize[2].name) == NULL,
+        "%s at another FAD listed from the stale index", g_Saves[2].filename);
+
+    // folders are found by their directory flag, not by their name
+    makeDirectory("%s/V1.0", directory);
+    simPath(path, sizeof(path), "%s/README", directory);
+    writeHostFile(path, g_Expected, 1);
+    makeDirectory("%s/GAME/SUB", directory);
+    sessionRelease();
+    dirCacheInvalidate(CdMemoryBackup);
+
+    count = list(CdMemoryBackup);
+    save = findListed(count > 0 ? count : 0, "V1.0");
+    CHECK(save != NULL && save->directory && findListed(count, "README") == NULL, "CD folders listed wrong (%d entries)", count);
+
+    // nothing below the per-game folders, the user is told why
+    errors = simErrors();
+    CHECK(changeSaveDirectory(CdMemoryBackup, "GAME") == 0, "failed to enter GAME");
+    count = list(CdMemoryBackup);
+    CHECK(count == 2 && simErrors() > errors, "GAME listed %d entries with a folder inside", count);
+    CHECK(changeSaveDirectory(CdMemoryBackup, "..") == 0, "failed to leave GAME");
+}
+
+static void scenarioRamdisk(void)
+{
+    CHECK(isBackupDeviceAvailable(MemoryBackup), "RAM disk not available");
+
+    roundTrip(MemoryBackup, COUNTOF(g_Saves));
+    streamRead(MemoryBackup, &g_Saves[3], 5000);
+    streamWrite(MemoryBackup, &g_Saves[2], 1000);
+    deleteAndList(MemoryBackup, &g_Saves[3], COUNTOF(g_Saves) - 1);
+
+    CHECK(formatDevice(MemoryBackup) == 0 && list(MemoryBackup) == 0, "RAM disk not empty after formatting");
+}
+
+static void scenarioCopy(void)
+{
+    static const int devices[] = {JoCartridgeMemoryBackup, SatiatorBackup, MODEBackup, MemoryBackup};
+    static const TEST_SAVE maxSave = {"MAX.BUP", "MAX_SIZE", MAX_SAVE_SIZE - sizeof(BUP_HEADER)};
+    const TEST_SAVE* save = &g_Saves[3];
+    unsigned int size = 0;
+    int result = 0;
+
+    writeCdSaves(NULL, g_Saves, COUNTOF(g_Saves), true);
+
+    // from the CD to every writeable device, then round the devices in turn
+    for(unsigned int i = 0; i < COUNTOF(devices); i++)
+    {
+        copySave(CdMemoryBackup, save, devices[i]);
+    }
+
+    for(unsigned int i = 0; i < COUNTOF(devices); i++)
+    {
+        for(unsigned int j = 0; j < COUNTOF(devices); j++)
+        {
+            if(i != j)
+            {
+                deleteSaveFile(devices[j], saveAddress(devices[j], save));
+                copySave(devices[i], save, devices[j]);
+            }
+        }
+    }
+
+    copySave(CdMemoryBackup, &g_Saves[2], JoInternalMemoryBackup);
+    copySave(JoInternalMemoryBackup, &g_Saves[2], SatiatorBackup);
+
+    // the Satiator and MODE share the CD block so the whole save goes through
+    // the save buffer, there is no room on the heap for a second one
+    size = makeSave(&maxSave, g_Expected);
+    result = writeSaveFile(SatiatorBackup, saveAddress(SatiatorBackup, &maxSave), g_Expected, size);
+    CHECK(result == 0, "%s: write %s failed (%d)", deviceName(SatiatorBackup), maxSave.filename, result);
+
+    copySave(SatiatorBackup, &maxSave, MODEBackup);
+    deleteSaveFile(SatiatorBackup, saveAddress(SatiatorBackup, &maxSave));
+    copySave(MODEBackup, &maxSave, SatiatorBackup);
+}
+
+// verifies every save of the two devices
+static int runVerify(PVERIFY_SESSION verify, int sourceDevice, int targetDevice)
+{
+    int result = 0;
+
+    result = verifyStart(verify, sourceDevice, targetDevice, g_Buffer, SGCSIM_BUFFER_SIZE);
+    CHECK(result == 0, "verifyStart failed (%d)", result);
+    if(result != 0)
+    {
+        return result;
+    }
+
+    while(verifyStep(verify) == 1)
+    {
+        slSynch();
+    }
+
+    return 0;
+}
+
+static void scenarioBatch(void)
+{
+    BATCH_SESSION batch = {0};
+    VERIFY_SESSION verify = {0};
+    unsigned int frames = 0;
+    unsigned int switches = 0;
+    unsigned int size = 0;
+    int count = 0;
+    int result = 0;
+
+    writeCdSaves(NULL, g_Saves, COUNTOF(g_Saves), true);
+    roundTrip(MODEBackup, 2);
+
+    result = batchStart(&batch, g_Buffer, SGCSIM_BUFFER_SIZE);
+    CHECK(result == 0, "batchStart failed (%d)", result);
+    if(result != 0)
+    {
+        return;
+    }
+
+    // interleaved on purpose, the batch groups the reads by device
+    count = list(CdMemoryBackup);
+    for(int i = 0; i < count; i++)
+    {
+        if(g_Listing[i].directory == false)
+        {
+            batchAdd(&batch, CdMemoryBackup, &g_Listing[i], SatiatorBackup);
+        }
+    }
+
+    count = list(MODEBackup);
+    for(int i = 0; i < count; i++)
+    {
+        batchAdd(&batch, MODEBackup, &g_Listing[i], JoCartridgeMemoryBackup);
+    }
+
+    switches = sessionGetSwitchCount();
+
+    do
+    {
+        result = batchStep(&batch);
+        slSynch();
+        frames++;
+    } while(result == 1);
+
+    CHECK(result == 0 && batch.numCopied == COUNTOF(g_Saves) + 2 && batch.numFailed == 0,
+        "batch copied %u, failed %u (%d)", batch.numCopied, batch.numFailed, result);
+    printf("    batch of %u saves: %u frames, %u bytes/s, %u CD block switches\n", batch.numItems, frames,
+        batchThroughput(batch.bytesCopied, batch.elapsedTicks), sessionGetSwitchCount() - switches);
+    batchEnd(&batch);
+
+    // the CD and the Satiator now hold the same saves
+    if(runVerify(&verify, CdMemoryBackup, SatiatorBackup) != 0)
+    {
+        return;
+    }
+
+    CHECK(verify.numIdentical == COUNTOF(g_Saves) && verify.numMismatched == 0 && verify.numMissing == 0 && verify.numErrors == 0,
+        "verify: %u identical, %u mismatched, %u missing, %u errors", verify.numIdentical, verify.numMismatched, verify.numMissing, verify.numErrors);
+    verifyEnd(&verify);
+
+    // a save that fails to close is an error, not identical
+    simConfigure("satiator:fail=close:1");
+    if(runVerify(&verify, CdMemoryBackup, SatiatorBackup) == 0)
+    {
+        CHECK(verify.numIdentical == COUNTOF(g_Saves) - 1 && verify.numErrors == 1 && verify.results[0].status == VERIFY_READ_ERROR,
+            "verify with a failed close: %u identical, %u errors, first %s", verify.numIdentical, verify.numErrors, verifyStatusString(verify.results[0].status));
+        verifyEnd(&verify);
+    }
+    simConfigure("satiator:fail=none:0");
+
+    // a second file with the same save name can't be paired
+    size = makeSave(&g_Saves[2], g_Expected);
+    result = writeSaveFile(SatiatorBackup, "COPY.BUP", g_Expected, size);
+    CHECK(result == 0, "%s: write COPY.BUP failed (%d)", deviceName(SatiatorBackup), result);
+
+    if(runVerify(&verify, CdMemoryBackup, SatiatorBackup) == 0)
+    {
+        unsigned int duplicates = 0;
+
+        for(unsigned int i = 0; i < verify.numResults; i++)
+        {
+            if(verify.results[i].status == VERIFY_DUPLICATE && strcmp(verify.results[i].name, g_Saves[2].name) == 0)
+            {
+                duplicates++;
+            }
+        }
+
+        CHECK(duplicates == 1 && verify.numIdentical == COUNTOF(g_Saves) - 1 && verify.numErrors == 1 && verify.numResults == COUNTOF(g_Saves),
+            "verify with a duplicate name: %u duplicates, %u identical, %u errors, %u results", duplicates, verify.numIdentical, verify.numErrors, verify.numResults);
+        verifyEnd(&verify);
+    }
+
+    deleteSaveFile(SatiatorBackup, "COPY.BUP");
+}
+
+// bytes of the newest stats record of the operation, -1 if there is none
+static int lastStatsBytes(unsigned char operation)
+{
+    for(unsigned int i = statsGetCount(); i > 0; i--)
+    {
+        PSTATS_RECORD record = statsGetRecord(i - 1);
+
+        if(record->operation == operation)
+        {
+            return (int)record->bytes;
+        }
+    }
+
+    return -1;
+}
+
+// reads the packed save whole and through a stream, both must be unpacked
+static void readPacked(int backupDevice, const TEST_SAVE* save, const unsigned char* expected, unsigned int size, unsigned int packedSize)
+{
+    BACKUP_STREAM stream = {0};
+    unsigned int offset = 0;
+    int count = 0;
+    int result = 0;
+
+    count = list(backupDevice);
+    CHECK(count == 1 && g_Listing[0].datasize == save->datasize && g_Listing[0].status == SAVE_STATUS_VALID,
+        "%s: packed %s listed with %u bytes, status %d", deviceName(backupDevice), save->filename, g_Listing[0].datasize, g_Listing[0].status);
+
+    // unpacked a chunk at a time, without a second buffer from the heap
+    memset(g_Buffer, 0, size);
+    simHeapResetPeak();
+    result = readSaveFile(backupDevice, (char*)save->filename, g_Buffer, size);
+    CHECK(result == 0 && memcmp(expected, g_Buffer, size) == 0, "%s: packed %s read back wrong (%d)", deviceName(backupDevice), save->filename, result);
+    CHECK(simHeapPeak() == simHeapUsed(), "%s: unpacking %s took %u bytes of heap", deviceName(backupDevice), save->filename, simHeapPeak() - simHeapUsed());
+    CHECK(lastStatsBytes(STATS_OP_READ) == (int)packedSize, "%s: read of packed %s counted %d bytes, not %u",
+        deviceName(backupDevice), save->filename, lastStatsBytes(STATS_OP_READ), packedSize);
+
+    memset(g_Buffer, 0, size);
+    result = openSaveStream(&stream, backupDevice, (char*)save->filename, STREAM_MODE_READ, size, g_StreamBuffer, SGCSIM_BUFFER_SIZE);
+    CHECK(result == 0, "%s: open packed %s for reading failed (%d)", deviceName(backupDevice), save->filename, result);
+    if(result != 0)
+    {
+        return;
+    }
+
+    while(offset < size)
+    {
+        result = readSaveStream(&stream, g_Buffer + offset, MIN(3000, size - offset));
+        if(result <= 0)
+        {
+            break;
+        }
+
+        offset += result;
+    }
+
+    closeSaveStream(&stream);
+    CHECK(offset == size && memcmp(expected, g_Buffer, size) == 0, "%s: streamed %u of %u bytes of packed %s",
+        deviceName(backupDevice), offset, size, save->filename);
+}
+
+static void scenarioPacked(void)
+{
+    static const int devices[] = {SatiatorBackup, MODEBackup, CdMemoryBackup};
+    static const char* roots[] = {"satiator", "mode", "cd"};
+    const TEST_SAVE* save = &g_Saves[3];
+    unsigned char* packed = calloc(1, SGCSIM_BUFFER_SIZE);
+    char path[SIM_MAX_PATH * 2] = {0};
+    BACKUP_STREAM stream = {0};
+    unsigned int packedSize = 0;
+    unsigned int offset = 0;
+    unsigned int size = 0;
+    unsigned int errors = 0;
+    int result = 0;
+
+    // a save that compresses like most do, data followed by zeroes
+    // the random data at the end is stored as is, it unpacks bigger than it is packed
+    size = makeSave(save, g_Expected);
+    memset(g_Expected + sizeof(BUP_HEADER) + 4096, 0, size - sizeof(BUP_HEADER) - 2 * 4096);
+
+    result = bup_pack(g_Expected, size, packed, SGCSIM_BUFFER_SIZE, &packedSize);
+    CHECK(result == 0 && packedSize < size / 10, "packing %s failed (%d), %u of %u bytes", save->filename, result, packedSize, size);
+    if(result != 0)
+    {
+        free(packed);
+        return;
+    }
+
+    makeDirectory("%s/satiator/" SAVES_DIRECTORY, g_WorkDir);
+    for(unsigned int i = 0; i < COUNTOF(devices); i++)
+    {
+        simPath(path, sizeof(path), "%s/%s/" SAVES_DIRECTORY "/%s", g_WorkDir, roots[i], save->filename);
+        writeHostFile(path, packed, packedSize);
+
+        CHECK(isBackupDeviceAvailable(devices[i]), "%s not available", deviceName(devices[i]));
+        readPacked(devices[i], save, g_Expected, size, packedSize);
+    }
+
+    // a damaged chunk fails the read instead of returning bad data
+    packed[packedSize / 2] ^= 0x55;
+    simPath(path, sizeof(path), "%s/mode/" SAVES_DIRECTORY "/%s", g_WorkDir, save->filename);
+    writeHostFile(path, packed, packedSize);
+
+    errors = simErrors();
+    result = readSaveFile(MODEBackup, (char*)save->filename, g_Buffer, size);
+    CHECK(result != 0 && simErrors() > errors, "MODE: damaged packed %s read without an error (%d)", save->filename, result);
+
+    errors = simErrors();
+    result = openSaveStream(&stream, MODEBackup, (char*)save->filename, STREAM_MODE_READ, size, g_StreamBuffer, SGCSIM_BUFFER_SIZE);
+    while(result >= 0 && offset < size)
+    {
+        result = readSaveStream(&stream, g_Buffer + offset, size - offset);
+        offset += MAX(result, 0);
+    }
+    closeSaveStream(&stream);
+    CHECK(result < 0 && offset < size && simErrors() > errors, "MODE: damaged packed %s streamed without an error (%d)", save->filename, result);
+
+    // a read that fails moved nothing
+    result = readSaveFile(MODEBackup, "NOSAVE.BUP", g_Buffer, size);
+    CHECK(result != 0 && lastStatsBytes(STATS_OP_READ) == 0, "MODE: failed read counted %d bytes (%d)", lastStatsBytes(STATS_OP_READ), result);
+
+    free(packed);
+}
+
+static void scenarioLink(void)
+{
+    static const int devices[] = {SerialBackup, ModemBackup};
+    static const int simDevices[] = {SIM_SERIAL, SIM_MODEM};
+
+    for(unsigned int i = 0; i < COUNTOF(devices); i++)
+    {
+        const unsigned char* data = NULL;
+        unsigned int captured = 0;
+        unsigned int size = makeSave(&g_Saves[2], g_Expected);
+        int result = 0;
+
+        simLinkReset();
+
+        result = writeSaveFile(devices[i], (char*)g_Saves[2].filename, g_Expected, size);
+        CHECK(result == 0, "%s: send failed (%d)", deviceName(devices[i]), result);
+
+        // the PC receives the .BUP as is
+        data = simLinkData(simDevices[i], &captured);
+        CHECK(captured == size && memcmp(data, g_Expected, size) == 0, "%s: received %u of %u bytes", deviceName(devices[i]), captured, size);
+    }
+}
+
+// bup_getdate() as it was before the month tables, the reference for scenarioDate()
+static void loopGetdate(unsigned int date, jo_backup_date *tb)
+{
+    unsigned long div;
+
+    tb->min = (unsigned char)(date % 60);
+    tb->time = (unsigned char)((date % (60*24)) / 60);
+
+    div = date / (60*24);
+
+    if (div > 0xAB71)
+    {
+        tb->week = (unsigned char)((div + 1) % 7);
+    }
+    else
+    {
+        tb->week = (unsigned char)((div + 2) % 7);
+    }
+
+    unsigned long year_base   = div / ((365*4) + 1);
+    year_base = year_base * 4;
+    unsigned long days_remain = div % ((365*4) + 1);
+    const char days_count[12] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+
+    unsigned char month = 0;
+    int i;
+    for(i=0; i<(4*12); i++)
+    {
+        unsigned char days_per_month = days_count[i % 12];
+        if(i == 1)
+        {
+            days_per_month++;
+        }
+
+        if(days_remain < days_per_month)
+        {
+            break;
+        }
+
+        days_remain -= days_per_month;
+        month++;
+
+        if((i % 12) == 11)
+        {
+            month = 0;
+            year_base++;
+        }
+    }
+
+    tb->month = month + 1;
+    tb->day   = days_remain + 1;
+    tb->year  = year_base;
+}
+
+static unsigned long long hostNanos(void)
+{
+    struct timespec now = {0};
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (unsigned long long)now.tv_sec * 1000000000ULL + now.tv_nsec;
+}
+
+// times getdate over every day of the date range on the host, returns ns per call
+static unsigned int timeGetdate(void (*getdate)(unsigned int, jo_backup_date*))
+{
+    volatile unsigned int sink = 0;
+    jo_backup_date tb = {0};
+    unsigned long long start = hostNanos();
+    unsigned int calls = 0;
+
+    for(unsigned long long date = 0; date <= 0xFFFFFFFFULL; date += 60 * 24)
+    {
+        getdate((unsigned int)date, &tb);
+        sink += tb.day;
+        calls++;
+    }
+
+    return (unsigned int)((hostNanos() - start) / calls);
+}
+
+// the date logic only depends on the day, hours and minutes are a plain
+// remainder, so one date per day covers every path. The minute walks
+// through the day to exercise those too
+static void scenarioDate(void)
+{
+    unsigned int mismatches = 0;
+
+    for(unsigned long long day = 0; day * 60 * 24 <= 0xFFFFFFFFULL; day++)
+    {
+        unsigned int date = (unsigned int)MIN(day * 60 * 24 + day % (60 * 24), 0xFFFFFFFFULL);
+        jo_backup_date expected = {0};
+        jo_backup_date actual = {0};
+
+        loopGetdate(date, &expected);
+        bup_getdate(date, &actual);
+
+        if(memcmp(&expected, &actual, sizeof(jo_backup_date)) != 0)
+        {
+            if(mismatches++ < 3)
+            {
+                printf("    %08X: %u/%u/%u %u:%u %u, loop gives %u/%u/%u %u:%u %u\n", date,
+                    actual.year, actual.month, actual.day, actual.time, actual.min, actual.week,
+                    expected.year, expected.month, expected.day, expected.time, expected.min, expected.week);
+            }
+        }
+    }
+
+    CHECK(mismatches == 0, "bup_getdate() differs from the loop for %u days", mismatches);
+
+    // host numbers, only the ratio says anything about the SH2
+    printf("    host: loop %u ns, tables %u ns per call\n", timeGetdate(loopGetdate), timeGetdate(bup_getdate));
+}
+
+//
+// driver
+//
+
+static void usage(const char* program)
+{
+    fprintf(stderr, "usage: %s [-v] [-m <heap bytes>] [-d <device>:<key>=<value>]... [scenario]...\n\n", program);
+    fprintf(stderr, "devices: ");
+    for(int i = 0; i < SIM_NUM_DEVICES; i++)
+    {
+        fprintf(stderr, "%s ", g_SimDevices[i].name);
+    }
+    fprintf(stderr, "\nkeys: present=0|1 latency=<us> rate=<bytes/ms> maxread=<bytes> sync=<us> fail=<op>:<nth call>\n");
+    fprintf(stderr, "operations: internal, cartridge and external read|write, satiator read|write|sync|rename|unlink,\n");
+    fprintf(stderr, "            cd open|read, mode open|read|write, serial busy, modem dial|send\n\nscenarios:\n");
+    for(unsigned int i = 0; i < COUNTOF(g_Scenarios); i++)
+    {
+        fprintf(stderr, "  %-16s %s\n", g_Scenarios[i].name, g_Scenarios[i].description);
+    }
+}
+
+static bool runScenario(const SCENARIO* scenario)
+{
+    unsigned int failures = g_Failures;
+    unsigned int violations = 0;
+    unsigned long long start = 0;
+
+    printf("%s\n", scenario->name);
+
+    resetWorld();
+    start = simMicros();
+
+    scenario->run();
+
+    sessionAcquire(SESSION_NONE);
+
+    jo_free(g_Buffer);
+    g_Buffer = NULL;
+
+    for(int i = 0; i < SIM_NUM_DEVICES; i++)
+    {
+        if(g_SimDevices[i].violations != 0)
+        {
+            printf("    %s: %u rule violations\n", g_SimDevices[i].name, g_SimDevices[i].violations);
+            violations += g_SimDevices[i].violations;
+        }
+    }
+
+    g_Failures += violations;
+
+    printf("  %s in %llu ms simulated, peak heap %u bytes\n", g_Failures == failures ? "passed" : "FAILED",
+        (simMicros() - start) / 1000, simHeapPeak());
+
+    return g_Failures == failures;
+}
+
+int main(int argc, char** argv)
+{
+    unsigned int passed = 0;
+    unsigned int ran = 0;
+    int option = 0;
+
+    simReset();
+
+    while((option = getopt(argc, argv, "vm:d:h")) != -1)
+    {
+        switch(option)
+        {
+            case 'v':
+                g_SimVerbose = true;
+                break;
+
+            case 'm':
+                g_HeapLimit = strtoul(optarg, NULL, 0);
+                break;
+
+            case 'd':
+                if(simConfigure(optarg) != 0 || g_NumOptions == SGCSIM_MAX_OPTIONS)
+                {
+                    fprintf(stderr, "Invalid device option %s\n", optarg);
+                    usage(argv[0]);
+                    return 2;
+                }
+                g_Options[g_NumOptions++] = optarg;
+                break;
+
+            default:
+                usage(argv[0]);
+                return 2;
+        }
+    }
+
+    snprintf(g_WorkDir, sizeof(g_WorkDir), "/tmp/sgcsim.XXXXXX");
+    if(mkdtemp(g_WorkDir) == NULL)
+    {
+        fprintf(stderr, "Failed to create a work directory\n");
+        return 2;
+    }
+
+    setRoot(SIM_SATIATOR, "satiator");
+    setRoot(SIM_MODE, "mode");
+    setRoot(SIM_CD, "cd");
+
+    // the RAM disk lives in a 4MB cartridge instead of the Jo heap
+    g_SimCartId = RAMDISK_CART_ID_4MB;
+
+    // kept outside the simulated heap, they only exist in the harness
+    g_Expected = malloc(SGCSIM_BUFFER_SIZE);
+    g_StreamBuffer = malloc(SGCSIM_BUFFER_SIZE);
+
+    for(unsigned int i = 0; i < COUNTOF(g_Scenarios); i++)
+    {
+        bool selected = optind == argc;
+
+        for(int j = optind; j < argc; j++)
+        {
+            selected |= strcmp(argv[j], g_Scenarios[i].name) == 0;
+        }
+
+        if(selected)
+        {
+            ran++;
+            passed += runScenario(&g_Scenarios[i]);
+        }
+    }
+
+    printf("%u of %u scenarios passed, %u checks, %u failures\n", passed, ran, g_Checks, g_Failures);
+
+    {
+        char command[SIM_MAX_PATH + 32] = {0};
+
+        snprintf(command, sizeof(command), "rm -rf '%s'", g_WorkDir);
+        if(system(command) != 0)
+        {
+            fprintf(stderr, "Failed to remove %s\n", g_WorkDir);
+        }
+    }
+
+    free(g_Expected);
+    free(g_StreamBuffer);
+
+    return (ran != 0 && passed == ran) ? 0 : 1;
+}
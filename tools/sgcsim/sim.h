@@ -0,0 +1,91 @@
+/*
+ * sim.h - host simulators for the devices SGC talks to
+ *
+ * The backends are compiled unchanged for the host and linked against
+ * simulated Jo Engine, GFS, Satiator, MODE and link APIs. Each simulated
+ * device keeps its files in memory or in a directory on the host, charges
+ * simulated time for every command and transfer, and can inject faults.
+ *
+ * The simulators also check the rules the real hardware enforces, e.g. GFS
+ * is only usable while the CD block is in CD-ROM mode and MODE only
+ * transfers whole sectors. Breaking one is counted as a violation.
+ */
+#pragma once
+
+#include <stdbool.h>
+
+#define SIM_MAX_PATH            512
+
+// simulated devices
+#define SIM_INTERNAL            0
+#define SIM_CARTRIDGE           1
+#define SIM_EXTERNAL            2
+#define SIM_SATIATOR            3
+#define SIM_CD                  4
+#define SIM_MODE                5
+#define SIM_SERIAL              6
+#define SIM_MODEM               7
+#define SIM_NUM_DEVICES         8
+
+// who owns the CD block
+#define SIM_CDBLOCK_CDROM       0
+#define SIM_CDBLOCK_SATIATOR    1
+#define SIM_CDBLOCK_MODE        2
+
+// timing and fault model of a device
+// faults are injected on the failAt'th call of failOp, counting from 1
+typedef struct _SIM_DEVICE
+{
+    const char* name;
+    bool present;
+    unsigned int latencyUs; // charged per command
+    unsigned int bytesPerMs; // transfer rate, 0 is instant
+    unsigned int maxRead; // largest read returned in one call, 0 for no limit
+    unsigned int syncUs; // charged per sync of written data, i.e. flushing to the card
+    char failOp[16];
+    unsigned int failAt;
+
+    // counters
+    unsigned int commands;
+    unsigned int bytesRead;
+    unsigned int bytesWritten;
+    unsigned int violations;
+    unsigned int faults;
+    unsigned int syncs;
+    unsigned int opCount; // calls of failOp so far
+} SIM_DEVICE, *PSIM_DEVICE;
+
+extern SIM_DEVICE g_SimDevices[SIM_NUM_DEVICES];
+extern int g_SimCdBlock;
+extern bool g_SimGfsValid;
+extern bool g_SimVerbose;
+
+// sim_core.c
+void simReset(void);
+int simConfigure(const char* option);
+void simCharge(int device, unsigned int bytes);
+void simTransfer(int device, unsigned int bytes);
+bool simFault(int device, const char* op);
+void simViolation(int device, const char* format, ...);
+void simLog(const char* format, ...);
+unsigned long long simMicros(void);
+void simAdvance(unsigned int us);
+unsigned int simErrors(void);
+const char* simLastError(void);
+unsigned int simHeapUsed(void);
+unsigned int simHeapPeak(void);
+void simHeapResetPeak(void);
+void simSetHeapLimit(unsigned int limit);
+
+// directories backing the file based devices
+void simSetRoot(int device, const char* path);
+void simPath(char* path, unsigned int size, const char* format, ...) __attribute__((format(printf, 3, 4)));
+const char* simRoot(int device);
+
+// sim_backup.c
+void simBackupReset(void);
+unsigned int simBackupCount(int device);
+
+// sim_link.c
+void simLinkReset(void);
+const unsigned char* simLinkData(int device, unsigned int* size);
@@ -0,0 +1,282 @@
+/*
+ * sim_backup.c - the BIOS backup devices behind jo_backup_xxx()
+ *
+ * Saves are kept in memory. Space is accounted in blocks like the BIOS does
+ * so a full device refuses saves.
+ */
+#include <jo/jo.h>
+#include "sim.h"
+
+#define SIM_BACKUP_MAX_SAVES    255
+#define SIM_BACKUP_NAME         12
+#define SIM_BACKUP_COMMENT      11
+
+typedef struct _SIM_SAVE
+{
+    char name[SIM_BACKUP_NAME];
+    char comment[SIM_BACKUP_COMMENT];
+    unsigned char language;
+    unsigned int date;
+    unsigned char* data;
+    unsigned int size;
+} SIM_SAVE, *PSIM_SAVE;
+
+typedef struct _SIM_BACKUP
+{
+    unsigned int blockSize;
+    unsigned int numBlocks;
+    SIM_SAVE saves[SIM_BACKUP_MAX_SAVES];
+    unsigned int numSaves;
+} SIM_BACKUP, *PSIM_BACKUP;
+
+// internal memory is 32KB, a 4Mbit cartridge 512KB and the floppy 1.44MB
+static SIM_BACKUP g_Backups[3] =
+{
+    {64, 512, {{{0}}}, 0},
+    {512, 1024, {{{0}}}, 0},
+    {1024, 1440, {{{0}}}, 0},
+};
+
+static PSIM_BACKUP getBackup(jo_backup_device device)
+{
+    if((unsigned int)device > JoExternalDeviceBackup || g_SimDevices[device].present == false)
+    {
+        return NULL;
+    }
+
+    return &g_Backups[device];
+}
+
+static PSIM_SAVE findSave(PSIM_BACKUP backup, const char* fname)
+{
+    for(unsigned int i = 0; i < backup->numSaves; i++)
+    {
+        if(strncmp(backup->saves[i].name, fname, SIM_BACKUP_NAME - 1) == 0)
+        {
+            return &backup->saves[i];
+        }
+    }
+
+    return NULL;
+}
+
+// the BIOS stores 34 bytes of directory entry with the data and each block
+// starts with a 4 byte header
+static unsigned int saveBlocks(PSIM_BACKUP backup, unsigned int size)
+{
+    return (size + 34 + backup->blockSize - 5) / (backup->blockSize - 4);
+}
+
+static unsigned int usedBlocks(PSIM_BACKUP backup)
+{
+    unsigned int blocks = 0;
+
+    for(unsigned int i = 0; i < backup->numSaves; i++)
+    {
+        blocks += saveBlocks(backup, backup->saves[i].size);
+    }
+
+    return blocks;
+}
+
+static void deleteSave(PSIM_BACKUP backup, PSIM_SAVE save)
+{
+    free(save->data);
+    *save = backup->saves[--backup->numSaves];
+}
+
+// empties every device
+void simBackupReset(void)
+{
+    for(unsigned int i = 0; i < sizeof(g_Backups) / sizeof(g_Backups[0]); i++)
+    {
+        while(g_Backups[i].numSaves != 0)
+        {
+            deleteSave(&g_Backups[i], &g_Backups[i].saves[0]);
+        }
+    }
+}
+
+unsigned int simBackupCount(int device)
+{
+    return g_Backups[device].numSaves;
+}
+
+bool jo_backup_mount(jo_backup_device device)
+{
+    if(getBackup(device) == NULL)
+    {
+        return false;
+    }
+
+    simCharge(device, 0);
+    return true;
+}
+
+bool jo_backup_unmount(jo_backup_device device)
+{
+    return getBackup(device) != NULL;
+}
+
+bool jo_backup_read_device(jo_backup_device device, jo_list* filenames)
+{
+    PSIM_BACKUP backup = getBackup(device);
+
+    if(backup == NULL)
+    {
+        return false;
+    }
+
+    simCharge(device, backup->numSaves * 34);
+
+    for(unsigned int i = 0; i < backup->numSaves; i++)
+    {
+        jo_list_data data = {{0}};
+
+        strncpy(data.ch_arr, backup->saves[i].name, SIM_BACKUP_NAME - 1);
+        jo_list_add(filenames, data);
+    }
+
+    return true;
+}
+
+bool jo_backup_get_file_info(jo_backup_device device, const char* fname, char* comment, unsigned char* language, unsigned int* date, unsigned int* numBytes, unsigned int* numBlocks)
+{
+    PSIM_BACKUP backup = getBackup(device);
+    PSIM_SAVE save = NULL;
+
+    if(backup == NULL || (save = findSave(backup, fname)) == NULL)
+    {
+        return false;
+    }
+
+    simCharge(device, 34);
+
+    memcpy(comment, save->comment, SIM_BACKUP_COMMENT);
+    *language = save->language;
+    *date = save->date;
+    *numBytes = save->size;
+    *numBlocks = saveBlocks(backup, save->size);
+    return true;
+}
+
+unsigned int jo_backup_get_free_block_count(jo_backup_device device)
+{
+    PSIM_BACKUP backup = getBackup(device);
+
+    if(backup == NULL)
+    {
+        return 0;
+    }
+
+    return backup->numBlocks - usedBlocks(backup);
+}
+
+void* jo_backup_load_file_contents(jo_backup_device device, const char* fname, unsigned int* length)
+{
+    PSIM_BACKUP backup = getBackup(device);
+    PSIM_SAVE save = NULL;
+    unsigned char* contents = NULL;
+
+    if(backup == NULL || (save = findSave(backup, fname)) == NULL || simFault(device, "read"))
+    {
+        return NULL;
+    }
+
+    // Jo Engine allocates the buffer from its heap
+    contents = jo_malloc(save->size);
+    if(contents == NULL)
+    {
+        return NULL;
+    }
+
+    simCharge(device, save->size);
+    g_SimDevices[device].bytesRead += save->size;
+
+    memcpy(contents, save->data, save->size);
+    *length = save->size;
+    return contents;
+}
+
+bool jo_backup_save(jo_backup* file)
+{
+    PSIM_BACKUP backup = getBackup(file->backup_device);
+    PSIM_SAVE save = NULL;
+    unsigned int freeBlocks = 0;
+
+    if(backup == NULL || simFault(file->backup_device, "write"))
+    {
+        return false;
+    }
+
+    // the BIOS replaces an existing save of the same name
+    save = findSave(backup, file->fname);
+    freeBlocks = backup->numBlocks - usedBlocks(backup);
+    if(save != NULL)
+    {
+        freeBlocks += saveBlocks(backup, save->size);
+    }
+
+    if(saveBlocks(backup, file->content_size) > freeBlocks ||
+        (save == NULL && backup->numSaves == SIM_BACKUP_MAX_SAVES))
+    {
+        simLog("%s: out of space", g_SimDevices[file->backup_device].name);
+        return false;
+    }
+
+    if(save == NULL)
+    {
+        save = &backup->saves[backup->numSaves++];
+    }
+    else
+    {
+        free(save->data);
+    }
+
+    memset(save, 0, sizeof(SIM_SAVE));
+    strncpy(save->name, file->fname, SIM_BACKUP_NAME - 1);
+    strncpy(save->comment, file->comment, SIM_BACKUP_COMMENT - 1);
+    save->language = file->language_num;
+    save->date = file->save_timestamp;
+    save->size = file->content_size;
+    save->data = malloc(file->content_size + 1);
+    memcpy(save->data, file->contents, file->content_size);
+
+    simCharge(file->backup_device, file->content_size);
+    g_SimDevices[file->backup_device].bytesWritten += file->content_size;
+    return true;
+}
+
+bool jo_backup_delete_file(jo_backup_device device, const char* fname)
+{
+    PSIM_BACKUP backup = getBackup(device);
+    PSIM_SAVE save = NULL;
+
+    if(backup == NULL || (save = findSave(backup, fname)) == NULL)
+    {
+        return false;
+    }
+
+    simCharge(device, 0);
+    deleteSave(backup, save);
+    return true;
+}
+
+bool jo_backup_format_device(jo_backup_device device)
+{
+    PSIM_BACKUP backup = getBackup(device);
+
+    if(backup == NULL)
+    {
+        return false;
+    }
+
+    simCharge(device, 0);
+
+    while(backup->numSaves != 0)
+    {
+        deleteSave(backup, &backup->saves[0]);
+    }
+
+    return true;
+}
@@ -0,0 +1,16 @@
+/*
+ * sim_cart.c - cartridge slot memory
+ *
+ * Without a RAM cartridge id the RAM disk uses the Jo heap. The Action
+ * Replay area is blank so the Action Replay isn't detected.
+ */
+#include <jo/jo.h>
+#include "sim.h"
+
+#define SIM_CART_RAM_SIZE       (4 * 1024 * 1024)
+#define SIM_CARTRIDGE_SIZE      (512 * 1024)
+
+unsigned char g_SimCartId = 0xFF;
+unsigned short g_SimCartEnable = 0;
+unsigned char g_SimCartRam[SIM_CART_RAM_SIZE] = {0};
+unsigned char g_SimCartridge[SIM_CARTRIDGE_SIZE] = {0};
@@ -0,0 +1,518 @@
+/*
+ * sim_core.c - simulated clock, heap, screen and pad
+ */
+#include <stdarg.h>
+#include <jo/jo.h>
+#include "sim.h"
+
+#undef memcpy
+#undef memset
+#undef memcmp
+#undef strncpy
+
+#define SIM_FRAME_US            16683 // NTSC frame
+#define SIM_MAX_REPORTED        3 // violations printed per device without -v
+#define SIM_DEFAULT_HEAP        (1024 * 1024) // LWRAM zone SGC adds to the Jo heap
+
+SIM_DEVICE g_SimDevices[SIM_NUM_DEVICES] = {0};
+int g_SimCdBlock = SIM_CDBLOCK_CDROM;
+bool g_SimGfsValid = true;
+bool g_SimVerbose = false;
+
+static char g_SimRoots[SIM_NUM_DEVICES][SIM_MAX_PATH] = {0};
+static unsigned long long g_SimMicros = 0;
+static unsigned int g_SimErrors = 0;
+static char g_SimErrorFunction[128] = {0};
+static char g_SimLastError[256] = {0};
+
+// every allocation is prefixed with its size so the heap use can be tracked
+typedef struct _SIM_ALLOCATION
+{
+    unsigned int size;
+    unsigned int pad[3];
+} SIM_ALLOCATION;
+
+static unsigned int g_SimHeapLimit = SIM_DEFAULT_HEAP;
+static unsigned int g_SimHeapUsed = 0;
+static unsigned int g_SimHeapPeak = 0;
+
+// default timing of each device, rough figures for the real hardware
+// e.g. the CD is a 2x drive with a 150ms seek and serial runs at 115200 baud
+// a Satiator sync writes the last data sector, the FAT and the directory
+// entry to the SD card, guessed at 4ms. It hasn't been measured
+static const SIM_DEVICE g_SimDefaults[SIM_NUM_DEVICES] =
+{
+    {"internal",  true,  200,  200, 0, 0, "", 0},
+    {"cartridge", true,  200,  200, 0, 0, "", 0},
+    {"external",  false, 20000, 30, 0, 0, "", 0},
+    {"satiator",  true,  1500, 600, 0, 4000, "", 0},
+    {"cd",        true,  150000, 300, 0, 0, "", 0},
+    {"mode",      true,  1000, 900, 0, 0, "", 0},
+    {"serial",    true,  0,    11, 0, 0, "", 0},
+    {"modem",     true,  0,    3, 0, 0, "", 0},
+};
+
+// puts every device back to its default state, keeping the root directories
+void simReset(void)
+{
+    memcpy(g_SimDevices, g_SimDefaults, sizeof(g_SimDevices));
+    g_SimCdBlock = SIM_CDBLOCK_CDROM;
+    g_SimGfsValid = true;
+    g_SimErrors = 0;
+    g_SimLastError[0] = '\0';
+}
+
+// applies a "device:key=value" option
+// keys are present, latency (us), rate (bytes/ms), maxread and fail=op:count
+int simConfigure(const char* option)
+{
+    char name[32] = {0};
+    char key[32] = {0};
+    char value[64] = {0};
+    PSIM_DEVICE device = NULL;
+
+    if(sscanf(option, "%31[^:]:%31[^=]=%63s", name, key, value) != 3)
+    {
+        return -1;
+    }
+
+    for(int i = 0; i < SIM_NUM_DEVICES; i++)
+    {
+        if(strcmp(g_SimDevices[i].name, name) == 0)
+        {
+            device = &g_SimDevices[i];
+        }
+    }
+
+    if(device == NULL)
+    {
+        return -2;
+    }
+
+    if(strcmp(key, "present") == 0)
+    {
+        device->present = atoi(value) != 0;
+    }
+    else if(strcmp(key, "latency") == 0)
+    {
+        device->latencyUs = strtoul(value, NULL, 0);
+    }
+    else if(strcmp(key, "rate") == 0)
+    {
+        device->bytesPerMs = strtoul(value, NULL, 0);
+    }
+    else if(strcmp(key, "maxread") == 0)
+    {
+        device->maxRead = strtoul(value, NULL, 0);
+    }
+    else if(strcmp(key, "sync") == 0)
+    {
+        device->syncUs = strtoul(value, NULL, 0);
+    }
+    else if(strcmp(key, "fail") == 0)
+    {
+        char* count = strchr(value, ':');
+
+        device->failAt = count ? strtoul(count + 1, NULL, 0) : 1;
+        if(count)
+        {
+            *count = '\0';
+        }
+
+        snprintf(device->failOp, sizeof(device->failOp), "%.15s", value);
+        device->opCount = 0;
+    }
+    else
+    {
+        return -3;
+    }
+
+    return 0;
+}
+
+// charges a command plus the transfer of bytes to the clock
+void simCharge(int device, unsigned int bytes)
+{
+    PSIM_DEVICE d = &g_SimDevices[device];
+
+    d->commands++;
+    g_SimMicros += d->latencyUs;
+
+    if(d->bytesPerMs != 0)
+    {
+        g_SimMicros += (unsigned long long)bytes * 1000 / d->bytesPerMs;
+    }
+}
+
+// charges a transfer that continues an earlier command
+void simTransfer(int device, unsigned int bytes)
+{
+    PSIM_DEVICE d = &g_SimDevices[device];
+
+    if(d->bytesPerMs != 0)
+    {
+        g_SimMicros += (unsigned long long)bytes * 1000 / d->bytesPerMs;
+    }
+}
+
+// returns true if this call of op should fail
+bool simFault(int device, const char* op)
+{
+    PSIM_DEVICE d = &g_SimDevices[device];
+
+    if(d->failAt == 0 || strcmp(d->failOp, op) != 0)
+    {
+        return false;
+    }
+
+    d->opCount++;
+    if(d->opCount != d->failAt)
+    {
+        return false;
+    }
+
+    d->faults++;
+    simLog("%s: injected %s failure", d->name, op);
+    return true;
+}
+
+// records a call the real hardware wouldn't accept
+void simViolation(int device, const char* format, ...)
+{
+    va_list args;
+
+    g_SimDevices[device].violations++;
+
+    // the same mistake tends to repeat for every chunk
+    if(g_SimVerbose == false && g_SimDevices[device].violations > SIM_MAX_REPORTED)
+    {
+        return;
+    }
+
+    fprintf(stderr, "  violation: %s: ", g_SimDevices[device].name);
+    va_start(args, format);
+    vfprintf(stderr, format, args);
+    va_end(args);
+    fprintf(stderr, "\n");
+}
+
+void simLog(const char* format, ...)
+{
+    va_list args;
+
+    if(g_SimVerbose == false)
+    {
+        return;
+    }
+
+    fprintf(stderr, "    ");
+    va_start(args, format);
+    vfprintf(stderr, format, args);
+    va_end(args);
+    fprintf(stderr, "\n");
+}
+
+unsigned long long simMicros(void)
+{
+    return g_SimMicros;
+}
+
+void simAdvance(unsigned int us)
+{
+    g_SimMicros += us;
+}
+
+// number of sgc_core_error() messages since the last reset
+unsigned int simErrors(void)
+{
+    return g_SimErrors;
+}
+
+const char* simLastError(void)
+{
+    return g_SimLastError;
+}
+
+unsigned int simHeapUsed(void)
+{
+    return g_SimHeapUsed;
+}
+
+unsigned int simHeapPeak(void)
+{
+    return g_SimHeapPeak;
+}
+
+void simHeapResetPeak(void)
+{
+    g_SimHeapPeak = g_SimHeapUsed;
+}
+
+void simSetHeapLimit(unsigned int limit)
+{
+    g_SimHeapLimit = limit;
+}
+
+void simSetRoot(int device, const char* path)
+{
+    simPath(g_SimRoots[device], SIM_MAX_PATH, "%s", path);
+}
+
+// formats a host path, a path that doesn't fit would point the simulator
+// at the wrong file so it stops the run
+void simPath(char* path, unsigned int size, const char* format, ...)
+{
+    va_list args;
+    int length = 0;
+
+    va_start(args, format);
+    length = vsnprintf(path, size, format, args);
+    va_end(args);
+
+    if(length < 0 || (unsigned int)length >= size)
+    {
+        fprintf(stderr, "Host path too long: %s\n", path);
+        exit(2);
+    }
+}
+
+const char* simRoot(int device)
+{
+    return g_SimRoots[device];
+}
+
+//
+// libc functions SGC declares with a 32-bit size, see sgcsim_host.h
+//
+void* sgcsim_memcpy(void* dest, const void* src, unsigned int n)
+{
+    return memcpy(dest, src, n);
+}
+
+void* sgcsim_memset(void* s, int c, unsigned int n)
+{
+    return memset(s, c, n);
+}
+
+int sgcsim_memcmp(const void* s1, const void* s2, unsigned int n)
+{
+    return memcmp(s1, s2, n);
+}
+
+char* sgcsim_strncpy(char* dest, const char* src, unsigned int n)
+{
+    return strncpy(dest, src, n);
+}
+
+//
+// Jo Engine core
+//
+void jo_core_init(int color)
+{
+    (void)color;
+}
+
+void jo_printf(int x, int y, const char* format, ...)
+{
+    (void)x;
+    (void)y;
+    (void)format;
+}
+
+// __sgc_core_error() prints the function on line 21 and the message on line 23
+void jo_printf_with_color(int x, int y, int color, const char* format, ...)
+{
+    char text[256] = {0};
+    va_list args;
+
+    (void)x;
+
+    if(color != JO_COLOR_INDEX_Red)
+    {
+        return;
+    }
+
+    va_start(args, format);
+    vsnprintf(text, sizeof(text), format, args);
+    va_end(args);
+
+    if(y == 21)
+    {
+        snprintf(g_SimErrorFunction, sizeof(g_SimErrorFunction), "%.127s", text);
+        return;
+    }
+
+    g_SimErrors++;
+    snprintf(g_SimLastError, sizeof(g_SimLastError), "%.127s %.127s", g_SimErrorFunction, text);
+    simLog("sgc error: %s", g_SimLastError);
+}
+
+void jo_set_printf_color_index(int index)
+{
+    (void)index;
+}
+
+void jo_clear_screen(void)
+{
+}
+
+void jo_vdp2_clear_bitmap_nbg1(int color)
+{
+    (void)color;
+}
+
+unsigned int jo_get_ticks(void)
+{
+    return (unsigned int)(g_SimMicros / 1000);
+}
+
+void slSynch(void)
+{
+    g_SimMicros += SIM_FRAME_US;
+}
+
+//
+// Jo Engine heap
+//
+void* jo_malloc(unsigned int size)
+{
+    SIM_ALLOCATION* allocation = NULL;
+
+    if(g_SimHeapUsed + size > g_SimHeapLimit)
+    {
+        simLog("jo_malloc(%u) failed, %u of %u bytes in use", size, g_SimHeapUsed, g_SimHeapLimit);
+        return NULL;
+    }
+
+    allocation = malloc(sizeof(SIM_ALLOCATION) + size);
+    if(allocation == NULL)
+    {
+        return NULL;
+    }
+
+    allocation->size = size;
+    g_SimHeapUsed += size;
+    g_SimHeapPeak = g_SimHeapUsed > g_SimHeapPeak ? g_SimHeapUsed : g_SimHeapPeak;
+
+    // fresh allocations are garbage, like on the Saturn
+    memset(allocation + 1, 0xA5, size);
+    return allocation + 1;
+}
+
+void jo_free(void* p)
+{
+    SIM_ALLOCATION* allocation = NULL;
+
+    if(p == NULL)
+    {
+        return;
+    }
+
+    allocation = (SIM_ALLOCATION*)p - 1;
+    g_SimHeapUsed -= allocation->size;
+    free(allocation);
+}
+
+void jo_memset(void* dst, int value, unsigned int size)
+{
+    memset(dst, value, size);
+}
+
+int jo_memory_usage_percent(void)
+{
+    return (int)((unsigned long long)g_SimHeapUsed * 100 / g_SimHeapLimit);
+}
+
+//
+// pad, START is always down so error screens don't wait
+//
+void jo_input_update(void)
+{
+}
+
+void jo_wait_vblank_out(void)
+{
+}
+
+void jo_wait_vblank_in(void)
+{
+    g_SimMicros += SIM_FRAME_US;
+}
+
+bool jo_is_pad1_available(void)
+{
+    return true;
+}
+
+bool jo_is_pad1_key_pressed(int key)
+{
+    return key == JO_KEY_START;
+}
+
+bool jo_is_pad1_key_down(int key)
+{
+    return key == JO_KEY_START;
+}
+
+//
+// Jo Engine lists
+//
+void jo_list_init(jo_list* list)
+{
+    list->count = 0;
+    list->first = NULL;
+    list->last = NULL;
+}
+
+jo_node* jo_list_add(jo_list* list, jo_list_data data)
+{
+    jo_node* node = jo_malloc(sizeof(jo_node));
+
+    if(node == NULL)
+    {
+        return NULL;
+    }
+
+    node->data = data;
+    node->next = NULL;
+
+    if(list->last != NULL)
+    {
+        list->last->next = node;
+    }
+    else
+    {
+        list->first = node;
+    }
+
+    list->last = node;
+    list->count++;
+    return node;
+}
+
+jo_node* jo_list_at(jo_list* list, int index)
+{
+    jo_node* node = list->first;
+
+    for(int i = 0; node != NULL && i < index; i++)
+    {
+        node = node->next;
+    }
+
+    return node;
+}
+
+void jo_list_free_and_clear(jo_list* list)
+{
+    jo_node* node = list->first;
+
+    while(node != NULL)
+    {
+        jo_node* next = node->next;
+
+        jo_free(node);
+        node = next;
+    }
+
+    jo_list_init(list);
+}
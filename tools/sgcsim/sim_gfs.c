@@ -0,0 +1,426 @@
+/*
+ * sim_gfs.c - GFS and the Jo Engine file system over a directory on the host
+ *
+ * simRoot(SIM_CD) is the root of the ISO. Like GFS, files are addressed by
+ * their id in the current directory: 0 and 1 are . and .., the entries
+ * follow sorted by name as ISO9660 stores them.
+ */
+#include <dirent.h>
+#include <sys/stat.h>
+#include <jo/jo.h>
+#include "sim.h"
+
+#define SIM_GFS_MAX_ENTRIES     1024
+#define SIM_GFS_SECTOR_SIZE     2048
+#define SIM_GFS_FIRST_FAD       1000
+
+typedef struct _SIM_GFS_ENTRY
+{
+    char name[32];
+    Sint32 fad;
+    Sint32 size;
+    bool directory;
+} SIM_GFS_ENTRY;
+
+typedef struct _SIM_GFS_FILE
+{
+    FILE* file;
+    Sint32 fid;
+    Sint32 size;
+} SIM_GFS_FILE;
+
+static char g_Cwd[SIM_MAX_PATH] = {0}; // relative to the ISO root, empty for the root
+static SIM_GFS_ENTRY g_Entries[SIM_GFS_MAX_ENTRIES];
+static Sint32 g_NumEntries = 0;
+static bool g_Loaded = false;
+
+// GFS only works while the CD block is in CD-ROM mode, and after the CD
+// block was used for something else only once it was initialized again
+static bool checkGfs(const char* function)
+{
+    if(g_SimCdBlock != SIM_CDBLOCK_CDROM)
+    {
+        simViolation(SIM_CD, "%s() while the CD block is in %s mode", function,
+            g_SimCdBlock == SIM_CDBLOCK_SATIATOR ? "Satiator" : "MODE");
+        return false;
+    }
+
+    if(g_SimGfsValid == false)
+    {
+        simViolation(SIM_CD, "%s() before GFS was initialized again", function);
+        return false;
+    }
+
+    return true;
+}
+
+static int compareEntries(const void* a, const void* b)
+{
+    return strcmp(((const SIM_GFS_ENTRY*)a)->name, ((const SIM_GFS_ENTRY*)b)->name);
+}
+
+// reads the directory table of the current directory
+static bool loadDirectory(void)
+{
+    char path[SIM_MAX_PATH] = {0};
+    struct dirent* entry = NULL;
+    DIR* dir = NULL;
+    Sint32 fad = SIM_GFS_FIRST_FAD;
+
+    simPath(path, sizeof(path), "%s/%s", simRoot(SIM_CD), g_Cwd);
+
+    dir = opendir(path);
+    if(dir == NULL)
+    {
+        return false;
+    }
+
+    memset(g_Entries, 0, sizeof(g_Entries));
+    strcpy(g_Entries[0].name, ".");
+    strcpy(g_Entries[1].name, "..");
+    g_Entries[0].directory = g_Entries[1].directory = true;
+    g_NumEntries = 2;
+
+    while((entry = readdir(dir)) != NULL && g_NumEntries < SIM_GFS_MAX_ENTRIES)
+    {
+        char entryPath[SIM_MAX_PATH * 2] = {0};
+        struct stat hostStat = {0};
+        SIM_GFS_ENTRY* e = &g_Entries[g_NumEntries];
+
+        if(entry->d_name[0] == '.')
+        {
+            continue;
+        }
+
+        simPath(entryPath, sizeof(entryPath), "%s/%s", path, entry->d_name);
+        if(stat(entryPath, &hostStat) != 0)
+        {
+            continue;
+        }
+
+        snprintf(e->name, sizeof(e->name), "%.31s", entry->d_name);
+        e->directory = S_ISDIR(hostStat.st_mode);
+        e->size = e->directory ? SIM_GFS_SECTOR_SIZE : (Sint32)hostStat.st_size;
+        g_NumEntries++;
+    }
+
+    closedir(dir);
+
+    qsort(g_Entries + 2, g_NumEntries - 2, sizeof(SIM_GFS_ENTRY), compareEntries);
+
+    // files are laid out back to back in directory order
+    for(Sint32 i = 2; i < g_NumEntries; i++)
+    {
+        g_Entries[i].fad = fad;
+        fad += (g_Entries[i].size + SIM_GFS_SECTOR_SIZE - 1) / SIM_GFS_SECTOR_SIZE;
+    }
+
+    simCharge(SIM_CD, SIM_GFS_SECTOR_SIZE);
+    g_Loaded = true;
+    return true;
+}
+
+static SIM_GFS_ENTRY* getEntry(Sint32 fid)
+{
+    if(g_Loaded == false)
+    {
+        loadDirectory();
+    }
+
+    if(fid < 2 || fid >= g_NumEntries)
+    {
+        return NULL;
+    }
+
+    return &g_Entries[fid];
+}
+
+// mounts the root directory of the ISO, returns the number of entries
+// including . and .. which is how many fit in the caller's table
+Sint32 GFS_Init(Sint32 open_max, void* work, GfsDirTbl* dirtbl)
+{
+    if(g_SimCdBlock != SIM_CDBLOCK_CDROM)
+    {
+        simViolation(SIM_CD, "GFS_Init() while the CD block isn't in CD-ROM mode");
+        return -1;
+    }
+
+    if(open_max <= 0 || work == NULL || dirtbl == NULL || GFS_DIRTBL_TYPE(dirtbl) != GFS_DIR_NAME)
+    {
+        simViolation(SIM_CD, "GFS_Init() with a bad work area or directory table");
+        return -1;
+    }
+
+    g_SimGfsValid = true;
+    g_Cwd[0] = '\0';
+    if(loadDirectory() == false)
+    {
+        return -1;
+    }
+
+    if(g_NumEntries > GFS_DIRTBL_NDIR(dirtbl))
+    {
+        simViolation(SIM_CD, "GFS_Init() table holds %d of %d root entries",
+            (int)GFS_DIRTBL_NDIR(dirtbl), (int)g_NumEntries);
+        return GFS_DIRTBL_NDIR(dirtbl);
+    }
+
+    return g_NumEntries;
+}
+
+Sint32 GFS_NameToId(Sint8* name)
+{
+    if(checkGfs("GFS_NameToId") == false)
+    {
+        return -1;
+    }
+
+    if(g_Loaded == false)
+    {
+        loadDirectory();
+    }
+
+    for(Sint32 i = 2; i < g_NumEntries; i++)
+    {
+        if(strcmp(g_Entries[i].name, (const char*)name) == 0)
+        {
+            return i;
+        }
+    }
+
+    return GFS_ERR_FID;
+}
+
+const char* GFS_IdToName(Sint32 fid)
+{
+    SIM_GFS_ENTRY* entry = NULL;
+
+    if(checkGfs("GFS_IdToName") == false || (entry = getEntry(fid)) == NULL)
+    {
+        return NULL;
+    }
+
+    return entry->name;
+}
+
+Sint32 GFS_GetDirInfo(Sint32 fid, GfsDirId* dirrec)
+{
+    SIM_GFS_ENTRY* entry = NULL;
+
+    if(checkGfs("GFS_GetDirInfo") == false || (entry = getEntry(fid)) == NULL)
+    {
+        return GFS_ERR_FID;
+    }
+
+    memset(dirrec, 0, sizeof(GfsDirId));
+    dirrec->dirrec.fad = entry->fad;
+    dirrec->dirrec.size = entry->size;
+    dirrec->dirrec.atr = entry->directory ? GFS_ATR_DIR : 0;
+    strncpy((char*)dirrec->fname, entry->name, GFS_FNAME_LEN);
+
+    return GFS_ERR_OK;
+}
+
+GfsHn GFS_Open(Sint32 fid)
+{
+    char path[SIM_MAX_PATH * 2] = {0};
+    SIM_GFS_ENTRY* entry = NULL;
+    SIM_GFS_FILE* gfs = NULL;
+
+    if(checkGfs("GFS_Open") == false || (entry = getEntry(fid)) == NULL || entry->directory)
+    {
+        return NULL;
+    }
+
+    if(simFault(SIM_CD, "open"))
+    {
+        return NULL;
+    }
+
+    simPath(path, sizeof(path), "%s/%s/%s", simRoot(SIM_CD), g_Cwd, entry->name);
+
+    gfs = calloc(1, sizeof(SIM_GFS_FILE));
+    gfs->file = fopen(path, "rb");
+    gfs->fid = fid;
+    gfs->size = entry->size;
+
+    if(gfs->file == NULL)
+    {
+        free(gfs);
+        return NULL;
+    }
+
+    // the drive seeks to the file
+    simCharge(SIM_CD, 0);
+    return gfs;
+}
+
+void GFS_Close(GfsHn gfs)
+{
+    SIM_GFS_FILE* f = gfs;
+
+    if(f == NULL)
+    {
+        return;
+    }
+
+    fclose(f->file);
+    free(f);
+}
+
+Sint32 GFS_GetFileInfo(GfsHn gfs, Sint32* fid, Sint32* fn, Sint32* fsize, Sint32* atr)
+{
+    SIM_GFS_FILE* f = gfs;
+
+    if(fid != NULL)
+    {
+        *fid = f->fid;
+    }
+
+    if(fn != NULL)
+    {
+        *fn = 0;
+    }
+
+    if(fsize != NULL)
+    {
+        *fsize = f->size;
+    }
+
+    if(atr != NULL)
+    {
+        *atr = 0;
+    }
+
+    return GFS_ERR_OK;
+}
+
+// transfers nsct sectors from the CD block but only copies bsize bytes
+Sint32 GFS_Fread(GfsHn gfs, Sint32 nsct, void* buf, Sint32 bsize)
+{
+    SIM_GFS_FILE* f = gfs;
+    Sint32 count = 0;
+
+    if(checkGfs("GFS_Fread") == false)
+    {
+        return -1;
+    }
+
+    if(simFault(SIM_CD, "read"))
+    {
+        return -1;
+    }
+
+    count = MIN(bsize, nsct * SIM_GFS_SECTOR_SIZE);
+    if(g_SimDevices[SIM_CD].maxRead != 0)
+    {
+        count = MIN(count, (Sint32)g_SimDevices[SIM_CD].maxRead);
+    }
+
+    count = fread(buf, 1, count, f->file);
+
+    simTransfer(SIM_CD, nsct * SIM_GFS_SECTOR_SIZE);
+    g_SimDevices[SIM_CD].bytesRead += count;
+    return count;
+}
+
+bool jo_fs_cd(const char* sub_dir)
+{
+    char cwd[SIM_MAX_PATH] = {0};
+    struct stat hostStat = {0};
+    char path[SIM_MAX_PATH * 2] = {0};
+
+    if(checkGfs("jo_fs_cd") == false)
+    {
+        return false;
+    }
+
+    if(strcmp(sub_dir, "..") == 0)
+    {
+        char* slash = strrchr(g_Cwd, '/');
+
+        if(slash != NULL)
+        {
+            *slash = '\0';
+        }
+        else
+        {
+            g_Cwd[0] = '\0';
+        }
+
+        return loadDirectory();
+    }
+
+    simPath(path, sizeof(path), "%s/%s/%s", simRoot(SIM_CD), g_Cwd, sub_dir);
+    if(stat(path, &hostStat) != 0 || !S_ISDIR(hostStat.st_mode))
+    {
+        return false;
+    }
+
+    simPath(cwd, sizeof(cwd), "%s%s%s", g_Cwd, g_Cwd[0] ? "/" : "", sub_dir);
+    strcpy(g_Cwd, cwd);
+    return loadDirectory();
+}
+
+bool jo_fs_open(jo_file* file, const char* filename)
+{
+    Sint32 fid = 0;
+
+    if(checkGfs("jo_fs_open") == false)
+    {
+        return false;
+    }
+
+    fid = GFS_NameToId((Sint8*)filename);
+    if(fid < 0)
+    {
+        return false;
+    }
+
+    file->handle = GFS_Open(fid);
+    if(file->handle == NULL)
+    {
+        return false;
+    }
+
+    file->id = fid;
+    file->size = ((SIM_GFS_FILE*)file->handle)->size;
+    file->read = 0;
+    return true;
+}
+
+// Jo Engine reads whole sectors and buffers the rest
+int jo_fs_read_next_bytes(jo_file* file, char* buffer, unsigned int nbytes)
+{
+    SIM_GFS_FILE* f = file->handle;
+    int count = 0;
+
+    if(checkGfs("jo_fs_read_next_bytes") == false || f == NULL)
+    {
+        return -1;
+    }
+
+    if(simFault(SIM_CD, "read"))
+    {
+        return -1;
+    }
+
+    count = MIN((int)nbytes, file->size - file->read);
+    if(g_SimDevices[SIM_CD].maxRead != 0)
+    {
+        count = MIN(count, (int)g_SimDevices[SIM_CD].maxRead);
+    }
+
+    count = fread(buffer, 1, count, f->file);
+    file->read += count;
+
+    simTransfer(SIM_CD, count);
+    g_SimDevices[SIM_CD].bytesRead += count;
+    return count;
+}
+
+void jo_fs_close(jo_file* file)
+{
+    GFS_Close(file->handle);
+    file->handle = NULL;
+}
@@ -0,0 +1,156 @@
+/*
+ * sim_link.c - serial port, NetLink modem and Video CD card
+ *
+ * Bytes sent over the links are captured so they can be compared with the
+ * save that was copied.
+ */
+#include <jo/jo.h>
+#include <jo/serial.h>
+#include <jo/modem.h>
+#include <jo/vcd_card.h>
+#include "sim.h"
+
+#define SIM_LINK_CAPTURE_SIZE   (1024 * 1024)
+#define SIM_SERIAL_BUSY         (-2)
+
+typedef struct _SIM_LINK
+{
+    unsigned char data[SIM_LINK_CAPTURE_SIZE];
+    unsigned int size;
+} SIM_LINK;
+
+static SIM_LINK g_Serial = {{0}, 0};
+static SIM_LINK g_Modem = {{0}, 0};
+static bool g_Connected = false;
+
+void simLinkReset(void)
+{
+    g_Serial.size = 0;
+    g_Modem.size = 0;
+}
+
+const unsigned char* simLinkData(int device, unsigned int* size)
+{
+    SIM_LINK* link = device == SIM_SERIAL ? &g_Serial : &g_Modem;
+
+    *size = link->size;
+    return link->data;
+}
+
+static int capture(int device, SIM_LINK* link, const unsigned char* data, unsigned int size)
+{
+    if(link->size + size > SIM_LINK_CAPTURE_SIZE)
+    {
+        simViolation(device, "more than %d bytes sent", SIM_LINK_CAPTURE_SIZE);
+        return -1;
+    }
+
+    memcpy(link->data + link->size, data, size);
+    link->size += size;
+
+    simTransfer(device, size);
+    g_SimDevices[device].bytesWritten += size;
+    return 0;
+}
+
+int jo_serial_async_init(void)
+{
+    simCharge(SIM_SERIAL, 0);
+    return 0;
+}
+
+// the "busy" fault makes the port report busy once, like a full FIFO
+int jo_serial_send_byte(unsigned char data)
+{
+    if(g_SimDevices[SIM_SERIAL].present == false)
+    {
+        return -1;
+    }
+
+    if(simFault(SIM_SERIAL, "busy"))
+    {
+        return SIM_SERIAL_BUSY;
+    }
+
+    return capture(SIM_SERIAL, &g_Serial, &data, 1);
+}
+
+bool modem_is_present(void)
+{
+    return g_SimDevices[SIM_MODEM].present;
+}
+
+bool modem_get_uart(saturn_uart16550_t* uart)
+{
+    uart->base = 0;
+    return g_SimDevices[SIM_MODEM].present;
+}
+
+int modem_probe(saturn_uart16550_t* uart)
+{
+    (void)uart;
+    simCharge(SIM_MODEM, 0);
+    return g_SimDevices[SIM_MODEM].present ? MODEM_OK : MODEM_ERROR;
+}
+
+int modem_init(saturn_uart16550_t* uart)
+{
+    (void)uart;
+    simCharge(SIM_MODEM, 0);
+    return MODEM_OK;
+}
+
+// dialing takes as long as the handshake
+int modem_dial(saturn_uart16550_t* uart, const char* number, unsigned int timeout)
+{
+    (void)uart;
+    (void)number;
+    (void)timeout;
+
+    if(simFault(SIM_MODEM, "dial"))
+    {
+        return MODEM_ERROR;
+    }
+
+    simAdvance(15000000);
+    g_Connected = true;
+    return MODEM_CONNECT;
+}
+
+void modem_flush_input(saturn_uart16550_t* uart)
+{
+    (void)uart;
+}
+
+// returns 1 when the bytes were sent
+int modem_send_bytes(saturn_uart16550_t* uart, const unsigned char* data, unsigned int size)
+{
+    (void)uart;
+
+    if(g_Connected == false)
+    {
+        simViolation(SIM_MODEM, "sending before the modem connected");
+        return 0;
+    }
+
+    if(simFault(SIM_MODEM, "send"))
+    {
+        return 0;
+    }
+
+    return capture(SIM_MODEM, &g_Modem, data, size) == 0 ? 1 : 0;
+}
+
+int jo_vcd_card_is_present(void)
+{
+    return 0;
+}
+
+int jo_vcd_card_get_vcd_card_rom(int sector, int numSectors, unsigned char* buffer, unsigned int size)
+{
+    (void)sector;
+    (void)numSectors;
+    (void)buffer;
+    (void)size;
+    return -1;
+}
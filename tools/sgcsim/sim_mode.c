@@ -0,0 +1,259 @@
+/*
+ * sim_mode.c - the MODE command interface over a directory on the host
+ *
+ * "0:/" maps to simRoot(SIM_MODE). Like the real interface, reads and
+ * writes start on a sector boundary and reads always return whole sectors.
+ */
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <jo/jo.h>
+#include "../../backends/mode/mode_intf.h"
+#include "sim.h"
+
+#define SIM_MODE_SECTOR_SIZE    2048
+
+static FILE* g_File = NULL;
+static bool g_Open = false;
+static struct _MountStatus g_MountStatus = {0, 0, 0xD, {0}};
+static struct _VersionInfo g_VersionInfo = {0x53474353, 1, 4, 0, 0};
+
+// "0:/SATSAVES/NAME.BUP" to a path in the simulated SD card
+static bool hostPath(const char* filename, char* path)
+{
+    if(strncmp(filename, "0:/", 3) != 0)
+    {
+        simViolation(SIM_MODE, "path %s isn't on the SD card", filename);
+        return false;
+    }
+
+    simPath(path, SIM_MAX_PATH, "%s/%s", simRoot(SIM_MODE), filename + 3);
+    return true;
+}
+
+static bool checkOpen(const char* function)
+{
+    simCharge(SIM_MODE, 0);
+
+    if(g_Open == false || g_SimCdBlock != SIM_CDBLOCK_MODE)
+    {
+        simViolation(SIM_MODE, "%s() without the command interface open", function);
+        return false;
+    }
+
+    return true;
+}
+
+// a 74 minute disc, long enough for the interface to work
+void CDC_TgetToc(Uint32* toc)
+{
+    memset(toc, 0, 102 * sizeof(Uint32));
+
+    if(g_SimDevices[SIM_MODE].present)
+    {
+        toc[101] = 0x41000000 | 0x04F000;
+    }
+}
+
+void MODE_Open(void)
+{
+    simCharge(SIM_MODE, 0);
+
+    if(g_SimCdBlock != SIM_CDBLOCK_CDROM)
+    {
+        simViolation(SIM_MODE, "MODE_Open() with the CD block in Satiator mode");
+    }
+
+    g_Open = true;
+    g_SimCdBlock = SIM_CDBLOCK_MODE;
+}
+
+void MODE_Close(void)
+{
+    simCharge(SIM_MODE, 0);
+
+    if(g_File != NULL)
+    {
+        simViolation(SIM_MODE, "MODE_Close() with a file open");
+        fclose(g_File);
+        g_File = NULL;
+    }
+
+    g_Open = false;
+    g_SimCdBlock = SIM_CDBLOCK_CDROM;
+}
+
+struct _MountStatus* MODE_GetMountStatus(void)
+{
+    if(checkOpen("MODE_GetMountStatus") == false || g_SimDevices[SIM_MODE].present == false)
+    {
+        return NULL;
+    }
+
+    return &g_MountStatus;
+}
+
+struct _VersionInfo* MODE_GetVersionInfo(void)
+{
+    checkOpen("MODE_GetVersionInfo");
+    return &g_VersionInfo;
+}
+
+unsigned char MODE_OpenFile(const char* filename, unsigned char forwrite)
+{
+    char path[SIM_MAX_PATH] = {0};
+
+    if(checkOpen("MODE_OpenFile") == false || hostPath(filename, path) == false)
+    {
+        return 1;
+    }
+
+    if(g_File != NULL)
+    {
+        simViolation(SIM_MODE, "MODE_OpenFile(%s) with another file open", filename);
+        return 1;
+    }
+
+    if(simFault(SIM_MODE, "open"))
+    {
+        return 1;
+    }
+
+    g_File = fopen(path, forwrite ? "w+b" : "rb");
+    return g_File == NULL ? 4 : 0;
+}
+
+void MODE_CloseFile(void)
+{
+    if(checkOpen("MODE_CloseFile") == false)
+    {
+        return;
+    }
+
+    if(g_File == NULL)
+    {
+        simViolation(SIM_MODE, "MODE_CloseFile() without an open file");
+        return;
+    }
+
+    fclose(g_File);
+    g_File = NULL;
+}
+
+void MODE_DeleteFile(const char* filename)
+{
+    char path[SIM_MAX_PATH] = {0};
+
+    if(checkOpen("MODE_DeleteFile") == false || hostPath(filename, path) == false)
+    {
+        return;
+    }
+
+    unlink(path);
+}
+
+void MODE_ReadFile(unsigned char* buffer, unsigned int offset, unsigned int size)
+{
+    unsigned int count = 0;
+
+    if(checkOpen("MODE_ReadFile") == false || g_File == NULL)
+    {
+        return;
+    }
+
+    if(offset % SIM_MODE_SECTOR_SIZE != 0 || size % SIM_MODE_SECTOR_SIZE != 0)
+    {
+        simViolation(SIM_MODE, "MODE_ReadFile() of %u bytes at %u isn't sector aligned", size, offset);
+    }
+
+    // past the end of the file the sector is garbage
+    memset(buffer, 0xA5, size);
+
+    if(simFault(SIM_MODE, "read"))
+    {
+        return;
+    }
+
+    fseek(g_File, offset, SEEK_SET);
+    count = fread(buffer, 1, size, g_File);
+
+    simCharge(SIM_MODE, size);
+    g_SimDevices[SIM_MODE].bytesRead += count;
+}
+
+void MODE_WriteFile(unsigned char* buffer, unsigned int offset, unsigned int size)
+{
+    if(checkOpen("MODE_WriteFile") == false || g_File == NULL)
+    {
+        return;
+    }
+
+    if(offset % SIM_MODE_SECTOR_SIZE != 0 || size > SIM_MODE_SECTOR_SIZE)
+    {
+        simViolation(SIM_MODE, "MODE_WriteFile() of %u bytes at %u isn't a sector", size, offset);
+    }
+
+    if(simFault(SIM_MODE, "write"))
+    {
+        return;
+    }
+
+    fseek(g_File, offset, SEEK_SET);
+    fwrite(buffer, 1, size, g_File);
+
+    simCharge(SIM_MODE, size);
+    g_SimDevices[SIM_MODE].bytesWritten += size;
+}
+
+// unsorted, without . and .., directories have a size of 0xFFFFFFFF
+Sint32 MODE_ReadFileListing(const char* path, struct _SatDirList* list, int maxfiles)
+{
+    char dirPath[SIM_MAX_PATH] = {0};
+    struct dirent* entry = NULL;
+    DIR* dir = NULL;
+    Sint32 count = 0;
+
+    if(checkOpen("MODE_ReadFileListing") == false || hostPath(path, dirPath) == false)
+    {
+        return -1;
+    }
+
+    if(path[strlen(path) - 1] == '/')
+    {
+        simViolation(SIM_MODE, "listing path %s ends with /", path);
+        return -1;
+    }
+
+    dir = opendir(dirPath);
+    if(dir == NULL)
+    {
+        return -2;
+    }
+
+    while((entry = readdir(dir)) != NULL && count < maxfiles)
+    {
+        char entryPath[SIM_MAX_PATH * 2] = {0};
+        struct stat hostStat = {0};
+
+        if(entry->d_name[0] == '.')
+        {
+            continue;
+        }
+
+        simPath(entryPath, sizeof(entryPath), "%s/%s", dirPath, entry->d_name);
+        if(stat(entryPath, &hostStat) != 0)
+        {
+            continue;
+        }
+
+        memset(&list[count], 0, sizeof(list[count]));
+        snprintf(list[count].Name, sizeof(list[count].Name), "%.*s", (int)sizeof(list[count].Name) - 1, entry->d_name);
+        list[count].Size = S_ISDIR(hostStat.st_mode) ? 0xFFFFFFFF : (Uint32)hostStat.st_size;
+        count++;
+    }
+
+    closedir(dir);
+
+    simCharge(SIM_MODE, count * sizeof(struct _SatDirList));
+    return count;
+}
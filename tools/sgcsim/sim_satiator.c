@@ -0,0 +1,629 @@
+/*
+ * sim_satiator.c - the Satiator s_xxx() API over a directory on the host
+ *
+ * The root of the simulated SD card is simRoot(SIM_SATIATOR). Errors are
+ * returned as negative FR_xxx codes like FatFs does.
+ */
+#include <dirent.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <time.h>
+#include <jo/jo.h>
+#include "../../backends/satiator/satiator.h"
+#include "sim.h"
+
+#define SIM_MAX_FDS             8
+#define SIM_MAX_ENTRIES         1024
+#define SIM_SD_EPOCH            1767225600 // files are stamped from 2026-01-01 plus the simulated clock
+
+typedef struct _SIM_FD
+{
+    FILE* file;
+    bool written;
+    bool dirty; // written since the last sync
+    char path[SIM_MAX_PATH];
+} SIM_FD;
+
+static SIM_FD g_Fds[SIM_MAX_FDS] = {{0}};
+static char g_Cwd[SIM_MAX_PATH] = "/";
+
+// directory being listed by s_stat(NULL)
+static char g_Entries[SIM_MAX_ENTRIES][256];
+static unsigned int g_NumEntries = 0;
+static unsigned int g_NextEntry = 0;
+static char g_ListPath[SIM_MAX_PATH] = {0};
+
+static int compareEntries(const void* a, const void* b)
+{
+    return strcmp((const char*)a, (const char*)b);
+}
+
+// the CD block only answers Satiator commands in API mode
+static bool checkMode(const char* function)
+{
+    simCharge(SIM_SATIATOR, 0);
+
+    if(g_SimCdBlock != SIM_CDBLOCK_SATIATOR)
+    {
+        simViolation(SIM_SATIATOR, "%s() while the CD block isn't in API mode", function);
+        return false;
+    }
+
+    return true;
+}
+
+// the data register is accessed a 32-bit word at a time
+static void checkBuffer(const char* function, const void* buffer)
+{
+    if(((unsigned long)buffer & 3) != 0)
+    {
+        simViolation(SIM_SATIATOR, "%s() buffer %p isn't 32-bit aligned", function, buffer);
+    }
+}
+
+// absolute paths start at the root of the SD card, others at the current directory
+static void hostPath(const char* name, char* path)
+{
+    char sdPath[SIM_MAX_PATH] = {0};
+
+    if(name[0] == '/')
+    {
+        simPath(sdPath, sizeof(sdPath), "%s", name);
+    }
+    else
+    {
+        simPath(sdPath, sizeof(sdPath), "%s%s%s", g_Cwd, strcmp(g_Cwd, "/") == 0 ? "" : "/", name);
+    }
+
+    simPath(path, SIM_MAX_PATH, "%s%s", simRoot(SIM_SATIATOR), sdPath);
+}
+
+// FatFs stamps files with a 2 second resolution
+static void fatTime(time_t t, uint16_t* date, uint16_t* time)
+{
+    struct tm tm = {0};
+
+    gmtime_r(&t, &tm);
+    *date = (uint16_t)(((tm.tm_year - 80) << 9) | ((tm.tm_mon + 1) << 5) | tm.tm_mday);
+    *time = (uint16_t)((tm.tm_hour << 11) | (tm.tm_min << 5) | (tm.tm_sec / 2));
+}
+
+static int fillStat(const char* path, const char* name, s_stat_t* st, int statsize)
+{
+    struct stat hostStat = {0};
+    uint16_t date = 0;
+    uint16_t time = 0;
+    int len = strlen(name);
+
+    if(stat(path, &hostStat) != 0)
+    {
+        return -FR_NO_FILE;
+    }
+
+    if((int)sizeof(s_stat_t) + len > statsize)
+    {
+        len = statsize - sizeof(s_stat_t);
+    }
+
+    st->size = S_ISDIR(hostStat.st_mode) ? 0 : (uint32_t)hostStat.st_size;
+    st->attrib = S_ISDIR(hostStat.st_mode) ? AM_DIR : AM_ARC;
+    // s_stat_t is packed
+    fatTime(hostStat.st_mtime, &date, &time);
+    st->date = date;
+    st->time = time;
+    memcpy(st->name, name, len);
+
+    return len;
+}
+
+static SIM_FD* getFd(int fd)
+{
+    if(fd < 0 || fd >= SIM_MAX_FDS || g_Fds[fd].file == NULL)
+    {
+        simViolation(SIM_SATIATOR, "invalid file descriptor %d", fd);
+        return NULL;
+    }
+
+    return &g_Fds[fd];
+}
+
+int s_open(const char* filename, int flags)
+{
+    char path[SIM_MAX_PATH] = {0};
+    FILE* file = NULL;
+
+    if(checkMode("s_open") == false)
+    {
+        return -FR_NOT_READY;
+    }
+
+    hostPath(filename, path);
+
+    if(flags & FA_CREATE_ALWAYS)
+    {
+        file = fopen(path, "w+b");
+    }
+    else if(flags & FA_OPEN_ALWAYS)
+    {
+        file = fopen(path, "r+b");
+        if(file == NULL)
+        {
+            file = fopen(path, "w+b");
+        }
+    }
+    else
+    {
+        file = fopen(path, (flags & FA_WRITE) ? "r+b" : "rb");
+    }
+
+    if(file == NULL)
+    {
+        return -FR_NO_FILE;
+    }
+
+    for(int fd = 0; fd < SIM_MAX_FDS; fd++)
+    {
+        if(g_Fds[fd].file == NULL)
+        {
+            g_Fds[fd].file = file;
+            g_Fds[fd].written = false;
+            g_Fds[fd].dirty = false;
+            simPath(g_Fds[fd].path, SIM_MAX_PATH, "%s", path);
+            return fd;
+        }
+    }
+
+    fclose(file);
+    return -FR_TOO_MANY_OPEN_FILES;
+}
+
+// flushes data written since the last sync to the card
+// the Satiator does this on a seek to the current position, see s_sync(),
+// and FatFs when the file is closed
+static void syncFile(SIM_FD* f)
+{
+    if(f->dirty)
+    {
+        simAdvance(g_SimDevices[SIM_SATIATOR].syncUs);
+        g_SimDevices[SIM_SATIATOR].syncs++;
+        f->dirty = false;
+    }
+}
+
+int s_close(int fd)
+{
+    SIM_FD* f = NULL;
+
+    if(checkMode("s_close") == false || (f = getFd(fd)) == NULL)
+    {
+        return -FR_INVALID_OBJECT;
+    }
+
+    // FatFs syncs the file when closing it
+    syncFile(f);
+
+    fclose(f->file);
+    f->file = NULL;
+
+    // stamp the file with the simulated time
+    if(f->written)
+    {
+        struct timeval times[2] = {{0}};
+
+        times[0].tv_sec = times[1].tv_sec = SIM_SD_EPOCH + (time_t)(simMicros() / 1000000);
+        utimes(f->path, times);
+    }
+
+    if(simFault(SIM_SATIATOR, "close"))
+    {
+        return -FR_DISK_ERR;
+    }
+
+    return 0;
+}
+
+int s_seek(int fd, int offset, int whence)
+{
+    SIM_FD* f = NULL;
+
+    if(checkMode("s_seek") == false || (f = getFd(fd)) == NULL)
+    {
+        return -FR_INVALID_OBJECT;
+    }
+
+    if(whence == 1 && offset == 0)
+    {
+        if(simFault(SIM_SATIATOR, "sync"))
+        {
+            return -FR_DISK_ERR;
+        }
+
+        syncFile(f);
+    }
+
+    fseek(f->file, offset, whence == 1 ? SEEK_CUR : whence == 2 ? SEEK_END : SEEK_SET);
+    return (int)ftell(f->file);
+}
+
+int s_read(int fd, void* buf, int len)
+{
+    SIM_FD* f = NULL;
+    int result = 0;
+
+    if(checkMode("s_read") == false || (f = getFd(fd)) == NULL)
+    {
+        return -FR_INVALID_OBJECT;
+    }
+
+    if(len > S_MAXBUF || len < 0)
+    {
+        simViolation(SIM_SATIATOR, "s_read() of %d bytes", len);
+        return FR_INVALID_PARAMETER;
+    }
+
+    checkBuffer("s_read", buf);
+
+    if(simFault(SIM_SATIATOR, "read"))
+    {
+        return -FR_DISK_ERR;
+    }
+
+    if(g_SimDevices[SIM_SATIATOR].maxRead != 0)
+    {
+        len = MIN(len, (int)g_SimDevices[SIM_SATIATOR].maxRead);
+    }
+
+    result = fread(buf, 1, len, f->file);
+
+    // the data register is read a whole word at a time, the end of the
+    // last word is whatever the CD block buffer held
+    memset((unsigned char*)buf + result, 0xA5, (4 - (result & 3)) & 3);
+
+    simCharge(SIM_SATIATOR, result);
+    g_SimDevices[SIM_SATIATOR].bytesRead += result;
+
+    return result;
+}
+
+int s_write(int fd, const void* buf, int len)
+{
+    SIM_FD* f = NULL;
+    int result = 0;
+
+    if(checkMode("s_write") == false || (f = getFd(fd)) == NULL)
+    {
+        return -FR_INVALID_OBJECT;
+    }
+
+    if(len > S_MAXBUF || len < 0)
+    {
+        simViolation(SIM_SATIATOR, "s_write() of %d bytes", len);
+        return FR_INVALID_PARAMETER;
+    }
+
+    checkBuffer("s_write", buf);
+
+    if(simFault(SIM_SATIATOR, "write"))
+    {
+        return -FR_DISK_ERR;
+    }
+
+    result = fwrite(buf, 1, len, f->file);
+    f->written = true;
+    f->dirty = true;
+    simCharge(SIM_SATIATOR, result);
+    g_SimDevices[SIM_SATIATOR].bytesWritten += result;
+
+    return result;
+}
+
+// the real library syncs with a seek to the current position
+int s_sync(int fd)
+{
+    return s_seek(fd, 0, 1);
+}
+
+int s_truncate(int fd)
+{
+    SIM_FD* f = NULL;
+    long position = 0;
+
+    if(checkMode("s_truncate") == false || (f = getFd(fd)) == NULL)
+    {
+        return -FR_INVALID_OBJECT;
+    }
+
+    fflush(f->file);
+    position = ftell(f->file);
+    if(ftruncate(fileno(f->file), position) != 0)
+    {
+        return -FR_DISK_ERR;
+    }
+
+    return (int)position;
+}
+
+// s_stat(NULL, ...) returns the next entry of the directory opened by s_opendir()
+int s_stat(const char* filename, s_stat_t* stat, int statsize)
+{
+    char path[SIM_MAX_PATH] = {0};
+    const char* name = NULL;
+
+    if(checkMode("s_stat") == false)
+    {
+        return -FR_NOT_READY;
+    }
+
+    if(filename != NULL)
+    {
+        hostPath(filename, path);
+        name = strrchr(filename, '/') ? strrchr(filename, '/') + 1 : filename;
+        return fillStat(path, name, stat, statsize);
+    }
+
+    while(g_NextEntry < g_NumEntries)
+    {
+        int result = 0;
+
+        name = g_Entries[g_NextEntry++];
+        simPath(path, sizeof(path), "%s/%s", g_ListPath, name);
+
+        result = fillStat(path, name, stat, statsize);
+        if(result >= 0)
+        {
+            simCharge(SIM_SATIATOR, sizeof(s_stat_t) + result);
+            return result;
+        }
+    }
+
+    return 0;
+}
+
+int s_rename(const char* old, const char* new)
+{
+    char oldPath[SIM_MAX_PATH] = {0};
+    char newPath[SIM_MAX_PATH] = {0};
+    struct stat hostStat = {0};
+
+    if(checkMode("s_rename") == false)
+    {
+        return -FR_NOT_READY;
+    }
+
+    if(simFault(SIM_SATIATOR, "rename"))
+    {
+        return -FR_DISK_ERR;
+    }
+
+    hostPath(old, oldPath);
+    hostPath(new, newPath);
+
+    if(stat(oldPath, &hostStat) != 0)
+    {
+        return -FR_NO_FILE;
+    }
+
+    // FatFs doesn't replace an existing file
+    if(stat(newPath, &hostStat) == 0)
+    {
+        return -FR_EXIST;
+    }
+
+    if(rename(oldPath, newPath) != 0)
+    {
+        return -FR_DENIED;
+    }
+
+    return 0;
+}
+
+int s_mkdir(const char* filename)
+{
+    char path[SIM_MAX_PATH] = {0};
+
+    if(checkMode("s_mkdir") == false)
+    {
+        return -FR_NOT_READY;
+    }
+
+    hostPath(filename, path);
+    if(mkdir(path, 0755) != 0)
+    {
+        return errno == EEXIST ? -FR_EXIST : -FR_NO_PATH;
+    }
+
+    return 0;
+}
+
+int s_unlink(const char* filename)
+{
+    char path[SIM_MAX_PATH] = {0};
+    struct stat hostStat = {0};
+
+    if(checkMode("s_unlink") == false)
+    {
+        return -FR_NOT_READY;
+    }
+
+    if(simFault(SIM_SATIATOR, "unlink"))
+    {
+        return -FR_DISK_ERR;
+    }
+
+    hostPath(filename, path);
+    if(stat(path, &hostStat) != 0)
+    {
+        return -FR_NO_FILE;
+    }
+
+    if((S_ISDIR(hostStat.st_mode) ? rmdir(path) : unlink(path)) != 0)
+    {
+        return -FR_DENIED;
+    }
+
+    return 0;
+}
+
+int s_opendir(const char* filename)
+{
+    DIR* dir = NULL;
+    struct dirent* entry = NULL;
+    unsigned int dots = 0;
+
+    if(checkMode("s_opendir") == false)
+    {
+        return -FR_NOT_READY;
+    }
+
+    hostPath(filename, g_ListPath);
+
+    dir = opendir(g_ListPath);
+    if(dir == NULL)
+    {
+        return -FR_NO_PATH;
+    }
+
+    g_NumEntries = 0;
+    g_NextEntry = 0;
+
+    // FatFs returns . and .. for everything but the root directory
+    if(strcmp(filename, "/") != 0 && (filename[0] == '/' || strcmp(g_Cwd, "/") != 0 || strcmp(filename, ".") != 0))
+    {
+        strcpy(g_Entries[g_NumEntries++], ".");
+        strcpy(g_Entries[g_NumEntries++], "..");
+    }
+
+    dots = g_NumEntries;
+
+    while((entry = readdir(dir)) != NULL && g_NumEntries < SIM_MAX_ENTRIES)
+    {
+        if(strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0)
+        {
+            continue;
+        }
+
+        snprintf(g_Entries[g_NumEntries++], 256, "%s", entry->d_name);
+    }
+
+    closedir(dir);
+
+    // host directory order isn't stable, keep listings reproducible
+    qsort(g_Entries + dots, g_NumEntries - dots, sizeof(g_Entries[0]), compareEntries);
+
+    return 0;
+}
+
+int s_chdir(const char* filename)
+{
+    char path[SIM_MAX_PATH] = {0};
+    char cwd[SIM_MAX_PATH] = {0};
+    struct stat hostStat = {0};
+
+    if(checkMode("s_chdir") == false)
+    {
+        return -FR_NOT_READY;
+    }
+
+    if(strcmp(filename, "..") == 0)
+    {
+        char* slash = strrchr(g_Cwd, '/');
+
+        if(slash == g_Cwd)
+        {
+            strcpy(g_Cwd, "/");
+        }
+        else if(slash != NULL)
+        {
+            *slash = '\0';
+        }
+
+        return 0;
+    }
+
+    hostPath(filename, path);
+    if(stat(path, &hostStat) != 0 || !S_ISDIR(hostStat.st_mode))
+    {
+        return -FR_NO_PATH;
+    }
+
+    if(filename[0] == '/')
+    {
+        simPath(cwd, sizeof(cwd), "%s", filename);
+    }
+    else
+    {
+        simPath(cwd, sizeof(cwd), "%s%s%s", g_Cwd, strcmp(g_Cwd, "/") == 0 ? "" : "/", filename);
+    }
+
+    strcpy(g_Cwd, cwd);
+    return 0;
+}
+
+int s_getcwd(char* filename, int buflen)
+{
+    if(checkMode("s_getcwd") == false)
+    {
+        return -FR_NOT_READY;
+    }
+
+    snprintf(filename, buflen, "%s", g_Cwd);
+    return 0;
+}
+
+int s_emulate(const char* filename)
+{
+    (void)filename;
+
+    checkMode("s_emulate");
+    return -FR_DENIED;
+}
+
+// switching modes resets the CD block, GFS must be initialized again
+int s_mode(enum satiator_mode mode)
+{
+    if(g_SimDevices[SIM_SATIATOR].present == false)
+    {
+        return -1;
+    }
+
+    simCharge(SIM_SATIATOR, 0);
+
+    if(mode == s_api)
+    {
+        if(g_SimCdBlock == SIM_CDBLOCK_MODE)
+        {
+            simViolation(SIM_SATIATOR, "API mode entered with the MODE interface open");
+        }
+
+        g_SimCdBlock = SIM_CDBLOCK_SATIATOR;
+        g_SimGfsValid = false;
+        return 0;
+    }
+
+    for(int fd = 0; fd < SIM_MAX_FDS; fd++)
+    {
+        if(g_Fds[fd].file != NULL)
+        {
+            simViolation(SIM_SATIATOR, "left API mode with %s open", g_Fds[fd].path);
+        }
+    }
+
+    // the drive takes a while to spin back up
+    simAdvance(100000);
+    g_SimCdBlock = SIM_CDBLOCK_CDROM;
+    strcpy(g_Cwd, "/");
+    return 0;
+}
+
+int s_get_fw_version(char* buf, int buflen)
+{
+    if(checkMode("s_get_fw_version") == false)
+    {
+        return -FR_NOT_READY;
+    }
+
+    snprintf(buf, buflen, "sgcsim");
+    return 0;
+}
@@ -108,3 +108,36 @@ int calculateMD5Hash(unsigned char* buffer, unsigned int bufferSize, unsigned ch
 
     return 0;
 }
+
+// calculates the CRC32 (IEEE 802.3) of buffer
+// the lookup table is built on first use to keep it out of the binary
+unsigned int calculateCRC32(const unsigned char* buffer, unsigned int bufferSize, unsigned int crc)
+{
+    static unsigned int crcTable[256] = {0};
+    static bool crcTableReady = false;
+
+    if(crcTableReady == false)
+    {
+        for(unsigned int i = 0; i < 256; i++)
+        {
+            unsigned int value = i;
+
+            for(unsigned int j = 0; j < 8; j++)
+            {
+                value = (value & 1) ? (0xEDB88320 ^ (value >> 1)) : (value >> 1);
+            }
+
+            crcTable[i] = value;
+        }
+
+        crcTableReady = true;
+    }
+
+    crc = ~crc;
+    for(unsigned int i = 0; i < bufferSize; i++)
+    {
+        crc = crcTable[(crc ^ buffer[i]) & 0xFF] ^ (crc >> 8);
+    }
+
+    return ~crc;
+}
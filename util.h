@@ -10,13 +10,16 @@
 
 #define JO_PRINTF_BUF_SIZE  (64)
 
+#define MD5_HASH_SIZE       16
+
 #define UNUSED_ARG(x) (void)(x)
 
 // taken from Jo Engine core.h
 // used to display an error message to the user
 extern char __sgc_last_error[JO_PRINTF_BUF_SIZE];
 void __sgc_core_error(char *message, const char *function);
-# define sgc_core_error(...) do {sprintf(__sgc_last_error, __VA_ARGS__); __sgc_core_error(__sgc_last_error, __FUNCTION__);} while(0)
+// messages longer than the buffer are cut short
+# define sgc_core_error(...) do {snprintf(__sgc_last_error, sizeof(__sgc_last_error), __VA_ARGS__); __sgc_core_error(__sgc_last_error, __FUNCTION__);} while(0)
 
 // This function prototype is not in jo/malloc.h
 // Extend the heap
@@ -29,3 +32,7 @@ void clearScreen(void);
 // md5Hash is an out parameter that must be at least MD5_HASH_SIZE (16) long
 // returns 0 on success
 int calculateMD5Hash(unsigned char* buffer, unsigned int bufferSize, unsigned char* md5Hash);
+
+// calculates the CRC32 of buffer
+// pass the previous result as crc to continue a CRC over multiple buffers, 0 to start
+unsigned int calculateCRC32(const unsigned char* buffer, unsigned int bufferSize, unsigned int crc);
@@ -0,0 +1,383 @@
+// Bulk verify - compares every save on two devices by MD5 hash
+#include "STDLIB.H"
+#include "verify.h"
+
+static int compareSaveNames(const void* a, const void* b);
+static unsigned int countSaveName(PSAVES saves, unsigned int numSaves, const char* name);
+static int listDeviceSaves(int backupDevice, PSAVES* saves, unsigned int* numSaves);
+static int hashDeviceSave(int backupDevice, PSAVES save, unsigned char* buffer, unsigned int bufferSize, unsigned char* md5Hash);
+static void addVerifyResult(PVERIFY_SESSION session, char* name, unsigned char status);
+
+// lists the saves on both devices and prepares the session for verifyStep()
+// buffer is used as scratch space to read the saves
+// returns 0 on success
+int verifyStart(PVERIFY_SESSION session, int sourceDevice, int targetDevice, unsigned char* buffer, unsigned int bufferSize)
+{
+    int result = 0;
+
+    if(session == NULL || buffer == NULL || bufferSize < sizeof(BUP_HEADER))
+    {
+        sgc_core_error("Invalid parameters to verifyStart!!");
+        return -1;
+    }
+
+    memset(session, 0, sizeof(VERIFY_SESSION));
+    session->sourceDevice = sourceDevice;
+    session->targetDevice = targetDevice;
+    session->buffer = buffer;
+    session->bufferSize = bufferSize;
+
+    result = listDeviceSaves(sourceDevice, &session->sourceSaves, &session->numSourceSaves);
+    if(result != 0)
+    {
+        verifyEnd(session);
+        return -2;
+    }
+
+    result = listDeviceSaves(targetDevice, &session->targetSaves, &session->numTargetSaves);
+    if(result != 0)
+    {
+        verifyEnd(session);
+        return -3;
+    }
+
+    // worst case every save is only present on one of the devices
+    session->results = jo_malloc((session->numSourceSaves + session->numTargetSaves + 1) * sizeof(VERIFY_RESULT));
+    if(session->results == NULL)
+    {
+        sgc_core_error("Failed to allocate verify results!!");
+        verifyEnd(session);
+        return -4;
+    }
+
+    return 0;
+}
+
+// verifies the next save in the sorted listings
+// returns 1 if there are more saves to verify, 0 when done, negative on error
+int verifyStep(PVERIFY_SESSION session)
+{
+    unsigned char sourceHash[MD5_HASH_SIZE] = {0};
+    unsigned char targetHash[MD5_HASH_SIZE] = {0};
+    PSAVES source = NULL;
+    PSAVES target = NULL;
+    const char* name = NULL;
+    unsigned int numSource = 0;
+    unsigned int numTarget = 0;
+    int result = 0;
+
+    if(session == NULL || session->results == NULL)
+    {
+        return -1;
+    }
+
+    if(session->done == true)
+    {
+        return 0;
+    }
+
+    if(session->sourceIndex < session->numSourceSaves)
+    {
+        source = &session->sourceSaves[session->sourceIndex];
+    }
+
+    if(session->targetIndex < session->numTargetSaves)
+    {
+        target = &session->targetSaves[session->targetIndex];
+    }
+
+    if(source == NULL && target == NULL)
+    {
+        session->done = true;
+        return 0;
+    }
+
+    // both listings are sorted by name so a single merge pass finds
+    // the saves that are missing from either device
+    if(target == NULL || (source != NULL && strcmp(source->name, target->name) <= 0))
+    {
+        name = source->name;
+    }
+    else
+    {
+        name = target->name;
+    }
+
+    numSource = countSaveName(session->sourceSaves + session->sourceIndex, session->numSourceSaves - session->sourceIndex, name);
+    numTarget = countSaveName(session->targetSaves + session->targetIndex, session->numTargetSaves - session->targetIndex, name);
+
+    // saves are matched by name only, e.g. two .BUP files of the same game on
+    // the Satiator can't be told apart so neither is paired
+    if(numSource > 1 || numTarget > 1)
+    {
+        addVerifyResult(session, (char*)name, VERIFY_DUPLICATE);
+        session->sourceIndex += numSource;
+        session->targetIndex += numTarget;
+        return 1;
+    }
+
+    if(numTarget == 0)
+    {
+        addVerifyResult(session, source->name, VERIFY_MISSING_TARGET);
+        session->sourceIndex++;
+        return 1;
+    }
+
+    if(numSource == 0)
+    {
+        addVerifyResult(session, target->name, VERIFY_MISSING_SOURCE);
+        session->targetIndex++;
+        return 1;
+    }
+
+    session->sourceIndex++;
+    session->targetIndex++;
+
+    // no need to read the saves if the sizes don't match
+    if(source->datasize != target->datasize)
+    {
+        addVerifyResult(session, source->name, VERIFY_MISMATCH);
+        return 1;
+    }
+
+    // the saves are hashed one after the other, not pipelined. The scratch
+    // buffer is shared, every backend reads synchronously and the Satiator,
+    // MODE and CD can't be read at the same time as they share the CD block
+    // so a verify takes the source's read time plus the target's
+    result = hashDeviceSave(session->sourceDevice, source, session->buffer, session->bufferSize, sourceHash);
+    if(result == 0)
+    {
+        result = hashDeviceSave(session->targetDevice, target, session->buffer, session->bufferSize, targetHash);
+    }
+
+    if(result != 0)
+    {
+        addVerifyResult(session, source->name, VERIFY_READ_ERROR);
+        return 1;
+    }
+
+    if(memcmp(sourceHash, targetHash, MD5_HASH_SIZE) != 0)
+    {
+        addVerifyResult(session, source->name, VERIFY_MISMATCH);
+        return 1;
+    }
+
+    addVerifyResult(session, source->name, VERIFY_IDENTICAL);
+    return 1;
+}
+
+// frees the memory allocated by verifyStart()
+void verifyEnd(PVERIFY_SESSION session)
+{
+    if(session == NULL)
+    {
+        return;
+    }
+
+    if(session->sourceSaves)
+    {
+        jo_free(session->sourceSaves);
+        session->sourceSaves = NULL;
+    }
+
+    if(session->targetSaves)
+    {
+        jo_free(session->targetSaves);
+        session->targetSaves = NULL;
+    }
+
+    if(session->results)
+    {
+        jo_free(session->results);
+        session->results = NULL;
+    }
+
+    session->numSourceSaves = 0;
+    session->numTargetSaves = 0;
+    session->numResults = 0;
+}
+
+// returns a short description of the verify result
+const char* verifyStatusString(unsigned char status)
+{
+    switch(status)
+    {
+        case VERIFY_IDENTICAL:
+            return "Identical";
+        case VERIFY_MISMATCH:
+            return "Mismatch";
+        case VERIFY_MISSING_TARGET:
+            return "Missing Target";
+        case VERIFY_MISSING_SOURCE:
+            return "Missing Source";
+        case VERIFY_READ_ERROR:
+            return "Read Error";
+        case VERIFY_DUPLICATE:
+            return "Duplicate Name";
+        default:
+            return "Unknown";
+    }
+}
+
+// sort by save name, the name is what saves are matched by
+static int compareSaveNames(const void* a, const void* b)
+{
+    PSAVES aSave = (PSAVES)a;
+    PSAVES bSave = (PSAVES)b;
+
+    return strcmp(aSave->name, bSave->name);
+}
+
+// returns the number of saves at the start of the sorted listing named name
+static unsigned int countSaveName(PSAVES saves, unsigned int numSaves, const char* name)
+{
+    unsigned int count = 0;
+
+    while(count < numSaves && strcmp(saves[count].name, name) == 0)
+    {
+        count++;
+    }
+
+    return count;
+}
+
+// allocates and fills out a sorted listing of the saves on the device
+// caller must free saves on success
+static int listDeviceSaves(int backupDevice, PSAVES* saves, unsigned int* numSaves)
+{
+    int numFiles = 0;
+    int count = 0;
+
+    *saves = jo_malloc(MAX_SAVES * sizeof(SAVES));
+    if(*saves == NULL)
+    {
+        sgc_core_error("Failed to allocate save listing!!");
+        return -1;
+    }
+    memset(*saves, 0, MAX_SAVES * sizeof(SAVES));
+
+    count = listSaveFiles(backupDevice, *saves, MAX_SAVES);
+    if(count < 0)
+    {
+        jo_free(*saves);
+        *saves = NULL;
+        return -2;
+    }
+
+    // subdirectories aren't saves, only the current directory is compared
+    for(int i = 0; i < count; i++)
+    {
+        if((*saves)[i].directory == false)
+        {
+            (*saves)[numFiles++] = (*saves)[i];
+        }
+    }
+
+    qsort(*saves, numFiles, sizeof(SAVES), compareSaveNames);
+    *numSaves = numFiles;
+
+    return 0;
+}
+
+// streams the save through buffer and hashes the save data, not including the .BUP header
+// devices that can't stream read the whole save into buffer and it's hashed in place
+static int hashDeviceSave(int backupDevice, PSAVES save, unsigned char* buffer, unsigned int bufferSize, unsigned char* md5Hash)
+{
+    BACKUP_STREAM stream = {0};
+    MD5_CTX ctx = {0};
+    char* filename = NULL;
+    int result = 0;
+
+    // BUGBUG: internal devices are read by save name, everything else by
+    // the .BUP filename. See displaySave_draw()
+    if(hasBackupDeviceCapability(backupDevice, BACKUP_CAP_SAVE_NAME))
+    {
+        filename = save->name;
+    }
+    else
+    {
+        filename = save->filename;
+    }
+
+    result = openSaveStream(&stream, backupDevice, filename, STREAM_MODE_READ, save->datasize + sizeof(BUP_HEADER), buffer, bufferSize);
+    if(result != 0)
+    {
+        return -1;
+    }
+
+    MD5_Init(&ctx);
+
+    if(stream.buffer != NULL)
+    {
+        MD5_Update(&ctx, stream.buffer + sizeof(BUP_HEADER), stream.size - sizeof(BUP_HEADER));
+        result = closeSaveStream(&stream);
+        if(result != 0)
+        {
+            return -2;
+        }
+
+        MD5_Final(md5Hash, &ctx);
+        return 0;
+    }
+
+    while(stream.position < stream.size)
+    {
+        unsigned int offset = stream.position;
+        unsigned int skip = 0;
+        int bytesRead = 0;
+
+        bytesRead = readSaveStream(&stream, buffer, bufferSize);
+        if(bytesRead <= 0)
+        {
+            closeSaveStream(&stream);
+            return -3;
+        }
+
+        // skip the .BUP header
+        if(offset < sizeof(BUP_HEADER))
+        {
+            skip = MIN(sizeof(BUP_HEADER) - offset, (unsigned int)bytesRead);
+        }
+
+        MD5_Update(&ctx, buffer + skip, bytesRead - skip);
+    }
+
+    // a save that fails to close wasn't necessarily read right
+    result = closeSaveStream(&stream);
+    if(result != 0)
+    {
+        return -4;
+    }
+
+    MD5_Final(md5Hash, &ctx);
+
+    return 0;
+}
+
+// records the verify result and updates the report totals
+static void addVerifyResult(PVERIFY_SESSION session, char* name, unsigned char status)
+{
+    PVERIFY_RESULT verifyResult = &session->results[session->numResults];
+
+    strncpy(verifyResult->name, name, MAX_SAVE_FILENAME);
+    verifyResult->name[MAX_SAVE_FILENAME - 1] = '\0';
+    verifyResult->status = status;
+    session->numResults++;
+
+    switch(status)
+    {
+        case VERIFY_IDENTICAL:
+            session->numIdentical++;
+            break;
+        case VERIFY_MISMATCH:
+            session->numMismatched++;
+            break;
+        case VERIFY_MISSING_TARGET:
+        case VERIFY_MISSING_SOURCE:
+            session->numMissing++;
+            break;
+        default:
+            session->numErrors++;
+            break;
+    }
+}
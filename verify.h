@@ -0,0 +1,60 @@
+#pragma once
+
+#include "backends/backend.h"
+
+//
+// Bulk verify - compares every save on two devices by MD5 hash
+//
+
+// result of comparing a save between the source and target devices
+#define VERIFY_IDENTICAL        0 // present on both devices with the same hash
+#define VERIFY_MISMATCH         1 // present on both devices but the size or hash differs
+#define VERIFY_MISSING_TARGET   2 // only present on the source device
+#define VERIFY_MISSING_SOURCE   3 // only present on the target device
+#define VERIFY_READ_ERROR       4 // failed to read the save from one of the devices
+#define VERIFY_DUPLICATE        5 // more than one save with the name on a device, can't be paired
+
+// per save verify result
+typedef struct _VERIFY_RESULT
+{
+    char name[MAX_SAVE_FILENAME]; // save name used to match the saves
+    unsigned char status; // VERIFY_XXX
+} VERIFY_RESULT, *PVERIFY_RESULT;
+
+// state of a verify run. Advanced one save at a time by verifyStep()
+typedef struct _VERIFY_SESSION
+{
+    int sourceDevice;
+    int targetDevice;
+
+    // save listings of both devices, sorted by save name
+    PSAVES sourceSaves;
+    PSAVES targetSaves;
+    unsigned int numSourceSaves;
+    unsigned int numTargetSaves;
+
+    // merge cursors into the sorted listings
+    unsigned int sourceIndex;
+    unsigned int targetIndex;
+
+    // results for every save found on either device
+    PVERIFY_RESULT results;
+    unsigned int numResults;
+
+    // diff report totals
+    unsigned int numIdentical;
+    unsigned int numMismatched;
+    unsigned int numMissing;
+    unsigned int numErrors; // read errors and duplicate names
+
+    // scratch buffer the saves are streamed through
+    unsigned char* buffer;
+    unsigned int bufferSize;
+
+    bool done;
+} VERIFY_SESSION, *PVERIFY_SESSION;
+
+int verifyStart(PVERIFY_SESSION session, int sourceDevice, int targetDevice, unsigned char* buffer, unsigned int bufferSize);
+int verifyStep(PVERIFY_SESSION session);
+void verifyEnd(PVERIFY_SESSION session);
+const char* verifyStatusString(unsigned char status);